@@ -28,6 +28,19 @@ typedef struct OC_APPLE_CHUNKLIST_CONTEXT_ {
   UINT8                       Hash[SHA256_DIGEST_SIZE];
 } OC_APPLE_CHUNKLIST_CONTEXT;
 
+//
+// Chunklist verifier for lazy data verification.
+//
+typedef struct {
+  CONST APPLE_RAM_DISK_EXTENT_TABLE *ExtentTable;
+  UINTN                             ChunkCount;
+  UINT64                            *ChunkOffsets;
+  APPLE_CHUNKLIST_CHUNK             *Chunks;
+  UINT8                             *VerifiedChunks;
+  UINTN                             UnverifiedCount;
+  BOOLEAN                           Compromised;
+} OC_APPLE_CHUNKLIST_VERIFIER;
+
 //
 // Chunklist functions.
 //
@@ -74,4 +87,62 @@ OcAppleChunklistVerifyData (
   IN     CONST APPLE_RAM_DISK_EXTENT_TABLE  *ExtentTable
   );
 
+/**
+  Initializes a verifier for checking data against a chunklist on demand.
+  Chunklist data is copied, so the chunklist buffer may be freed afterwards.
+
+  @param[out] Verifier          The verifier to initialize.
+  @param[in]  Context           The Context with verified signature.
+  @param[in]  ExtentTable       A pointer to the RAM disk extent table to be
+                                verified.
+
+  @retval TRUE on success.
+**/
+BOOLEAN
+OcAppleChunklistInitializeVerifier (
+  OUT OC_APPLE_CHUNKLIST_VERIFIER        *Verifier,
+  IN  CONST OC_APPLE_CHUNKLIST_CONTEXT   *Context,
+  IN  CONST APPLE_RAM_DISK_EXTENT_TABLE  *ExtentTable
+  );
+
+/**
+  Verifies every not yet verified chunk overlapping the specified data range.
+  Verification results are remembered, so every chunk is hashed at most once.
+  After any chunk fails verification all further requests fail.
+
+  @param[in,out] Verifier       The verifier to use.
+  @param[in]     Offset         Data range offset in RAM disk.
+  @param[in]     Size           Data range size.
+
+  @retval TRUE when the whole range is covered by valid chunks.
+**/
+BOOLEAN
+OcAppleChunklistVerifyDataRange (
+  IN OUT OC_APPLE_CHUNKLIST_VERIFIER  *Verifier,
+  IN     UINTN                        Offset,
+  IN     UINTN                        Size
+  );
+
+/**
+  Verifies all not yet verified chunks.
+
+  @param[in,out] Verifier       The verifier to use.
+
+  @retval TRUE when all chunks are valid.
+**/
+BOOLEAN
+OcAppleChunklistVerifyRemainingData (
+  IN OUT OC_APPLE_CHUNKLIST_VERIFIER  *Verifier
+  );
+
+/**
+  Frees chunklist verifier resources.
+
+  @param[in,out] Verifier       The verifier to free.
+**/
+VOID
+OcAppleChunklistFreeVerifier (
+  IN OUT OC_APPLE_CHUNKLIST_VERIFIER  *Verifier
+  );
+
 #endif // APPLE_CHUNKLIST_LIB_H
@@ -15,11 +15,56 @@
 
 #include <IndustryStandard/AppleDiskImage.h>
 
+#include <Protocol/MpService.h>
 #include <Protocol/SimpleFileSystem.h>
 
 #include <Library/OcAppleChunklistLib.h>
 #include <Library/OcAppleRamDiskLib.h>
 
+//
+// Default memory budget for decompressed chunk cache.
+// Recovery images use 1 MB zlib chunks.
+//
+#define OC_APPLE_DISK_IMAGE_CACHE_DEFAULT_SIZE  SIZE_8MB
+
+//
+// Maximum amount of decompressed chunks kept in cache.
+//
+#define OC_APPLE_DISK_IMAGE_CACHE_MAX_ENTRIES   32
+
+//
+// Maximum amount of application processors used for chunk decompression.
+//
+#define OC_APPLE_DISK_IMAGE_MAX_WORKERS         16
+
+//
+// Decompressed chunk cache entry.
+//
+typedef struct {
+    CONST APPLE_DISK_IMAGE_CHUNK      *Chunk;
+    UINT8                             *Data;
+    UINTN                             Size;
+    UINT64                            LastAccess;
+} OC_APPLE_DISK_IMAGE_CACHE_ENTRY;
+
+//
+// Decompressed chunk cache statistics.
+//
+typedef struct {
+    UINT64                            Hits;
+    UINT64                            Misses;
+    UINT64                            Evictions;
+    UINT64                            Prefetches;
+} OC_APPLE_DISK_IMAGE_CACHE_STATS;
+
+//
+// Disk image chunk with absolute sector number.
+//
+typedef struct {
+    UINT64                            SectorNumber;
+    APPLE_DISK_IMAGE_CHUNK            *Chunk;
+} OC_APPLE_DISK_IMAGE_SORTED_CHUNK;
+
 //
 // Disk image context.
 //
@@ -30,6 +75,23 @@ typedef struct {
 
     UINT32                            BlockCount;
     APPLE_DISK_IMAGE_BLOCK_DATA       **Blocks;
+
+    UINT32                            ChunkCount;
+    OC_APPLE_DISK_IMAGE_SORTED_CHUNK  *Chunks;
+    UINT32                            ChunkCursor;
+
+    OC_APPLE_CHUNKLIST_VERIFIER       *Verifier;
+
+    UINTN                             CacheBudget;
+    UINTN                             CacheSize;
+    UINT64                            CacheClock;
+    OC_APPLE_DISK_IMAGE_CACHE_STATS   CacheStats;
+    OC_APPLE_DISK_IMAGE_CACHE_ENTRY   CacheEntries[OC_APPLE_DISK_IMAGE_CACHE_MAX_ENTRIES];
+
+    EFI_MP_SERVICES_PROTOCOL          *MpServices;
+    UINTN                             BspNumber;
+    UINTN                             WorkerCount;
+    UINT8                             *WorkerMemory;
 } OC_APPLE_DISK_IMAGE_CONTEXT;
 
 BOOLEAN
@@ -60,12 +122,87 @@ OcAppleDiskImageVerifyData (
   IN OUT OC_APPLE_CHUNKLIST_CONTEXT   *ChunklistContext
   );
 
+/**
+  Enable lazy verification of disk image data against a chunklist.
+  Every chunklist chunk is verified the first time a read touches it,
+  and reads of data failing verification fail.
+
+  @param[in,out] Context            Disk image context.
+  @param[in]     ChunklistContext   Chunklist context with verified signature.
+
+  @retval TRUE on success.
+**/
+BOOLEAN
+OcAppleDiskImageVerifyDataLazy (
+  IN OUT OC_APPLE_DISK_IMAGE_CONTEXT       *Context,
+  IN     CONST OC_APPLE_CHUNKLIST_CONTEXT  *ChunklistContext
+  );
+
+/**
+  Verify disk image data not yet verified in lazy verification mode.
+  This must be done before starting the image booted off the disk image,
+  as disk image memory is given to the operating system as is.
+
+  @param[in,out] Context            Disk image context.
+
+  @retval TRUE when all data is valid or lazy verification is not used.
+**/
+BOOLEAN
+OcAppleDiskImageVerifyRemainingData (
+  IN OUT OC_APPLE_DISK_IMAGE_CONTEXT  *Context
+  );
+
 BOOLEAN
 OcAppleDiskImageRead (
-  IN  OC_APPLE_DISK_IMAGE_CONTEXT  *Context,
-  IN  UINTN                        Lba,
-  IN  UINTN                        BufferSize,
-  OUT VOID                         *Buffer
+  IN OUT OC_APPLE_DISK_IMAGE_CONTEXT  *Context,
+  IN     UINTN                        Lba,
+  IN     UINTN                        BufferSize,
+     OUT VOID                         *Buffer
+  );
+
+/**
+  Set memory budget for decompressed chunk cache.
+  Cached chunks exceeding the new budget are dropped.
+
+  @param[in,out] Context    Disk image context.
+  @param[in]     Budget     Maximum cache size in bytes, 0 disables caching.
+**/
+VOID
+OcAppleDiskImageSetCacheBudget (
+  IN OUT OC_APPLE_DISK_IMAGE_CONTEXT  *Context,
+  IN     UINTN                        Budget
+  );
+
+/**
+  Obtain decompressed chunk cache statistics for debugging.
+  Every cache miss corresponds to a chunk decompression.
+
+  @param[in]  Context    Disk image context.
+  @param[out] Stats      Cache statistics.
+**/
+VOID
+OcAppleDiskImageGetCacheStats (
+  IN  CONST OC_APPLE_DISK_IMAGE_CONTEXT  *Context,
+  OUT OC_APPLE_DISK_IMAGE_CACHE_STATS    *Stats
+  );
+
+/**
+  Use application processors for chunk decompression.
+  On cache miss the chunk is decompressed together with the chunks
+  following it, which are put in cache ahead of sequential reads.
+  Chunks are decompressed on the BSP when no application processor
+  can be started.
+
+  @param[in,out] Context     Disk image context.
+  @param[in]     MpServices  MP services protocol, NULL disables the use
+                             of application processors.
+
+  @retval EFI_SUCCESS on success.
+**/
+EFI_STATUS
+OcAppleDiskImageSetMpServices (
+  IN OUT OC_APPLE_DISK_IMAGE_CONTEXT  *Context,
+  IN     EFI_MP_SERVICES_PROTOCOL     *MpServices  OPTIONAL
   );
 
 EFI_HANDLE
@@ -142,6 +142,46 @@ typedef enum KERNEL_CACHE_TYPE_ {
 #define KERNEL_VERSION_MOJAVE_MAX           (KERNEL_VERSION_CATALINA_MIN - 1)
 #define KERNEL_VERSION_CATALINA_MAX         (KERNEL_VERSION_BIG_SUR_MIN - 1)
 
+//
+// Kext bundle identifier hash map entry.
+//
+typedef struct {
+  //
+  // Kext CFBundleIdentifier, NULL for empty entries. Not owned by the map.
+  //
+  CONST CHAR8              *Identifier;
+  //
+  // Kext Info.plist dictionary, may be NULL.
+  //
+  XML_NODE                 *Plist;
+  //
+  // Cached kext structure specific to the context, may be NULL.
+  //
+  VOID                     *Kext;
+  //
+  // Identifier hash.
+  //
+  UINT32                   Hash;
+} KEXT_IDENTIFIER_MAP_ENTRY;
+
+//
+// Kext bundle identifier hash map with open addressing.
+//
+typedef struct {
+  //
+  // Map entries, NULL when nothing was inserted yet.
+  //
+  KEXT_IDENTIFIER_MAP_ENTRY  *Entries;
+  //
+  // Number of used entries.
+  //
+  UINT32                     Count;
+  //
+  // Number of allocated entries minus 1, entry count is a power of two.
+  //
+  UINT32                     Mask;
+} KEXT_IDENTIFIER_MAP;
+
 //
 // Prelinked context used for kernel modification.
 //
@@ -282,6 +322,10 @@ typedef struct {
   //
   LIST_ENTRY               InjectedKexts;
   //
+  // Identifier index of KextList dictionaries and PrelinkedKexts.
+  //
+  KEXT_IDENTIFIER_MAP      KextMap;
+  //
   // Whether this kernel is a kernel collection (used by macOS 11.0+).
   //
   BOOLEAN                  IsKernelCollection;
@@ -305,6 +349,11 @@ typedef struct {
   // Prelinked is 32-bit.
   //
   BOOLEAN                  Is32Bit;
+  //
+  // Do not build symbol name and value indices for dependencies.
+  // Only meant for benchmarking, must be set before injecting any kext.
+  //
+  BOOLEAN                  LinearSymbolLookup;
 } PRELINKED_CONTEXT;
 
 //
@@ -420,6 +469,10 @@ typedef struct {
   //
   LIST_ENTRY            BuiltInKexts;
   //
+  // Identifier index of BuiltInKexts.
+  //
+  KEXT_IDENTIFIER_MAP   BuiltInKextsMap;
+  //
   // Current kernel version.
   //
   UINT32                KernelVersion;
@@ -491,6 +544,14 @@ typedef struct {
   // List of cached kexts, used for patching and blocking.
   //
   LIST_ENTRY               CachedKexts;
+  //
+  // Identifier index of CachedKexts and MkextKexts dictionaries (for v2).
+  //
+  KEXT_IDENTIFIER_MAP      CachedKextsMap;
+  //
+  // Flag to indicate whether MkextKexts were added to CachedKextsMap.
+  //
+  BOOLEAN                  MkextKextsIndexed;
 } MKEXT_CONTEXT;
 
 //
@@ -860,6 +921,26 @@ PrelinkedContextApplyPatch (
   IN     PATCHER_GENERIC_PATCH  *Patch
   );
 
+/**
+  Apply multiple patches to the same kext in prelinked in a single pass.
+
+  @param[in,out] Context         Prelinked context.
+  @param[in]     Identifier      Kext bundle identifier.
+  @param[in]     Patches         Patches to apply.
+  @param[in]     PatchCount      Patch count.
+  @param[out]    Results         Per-patch status.
+
+  @return  EFI_SUCCESS when all patches were applied.
+**/
+EFI_STATUS
+PrelinkedContextApplyPatches (
+  IN OUT PRELINKED_CONTEXT      *Context,
+  IN     CONST CHAR8            *Identifier,
+  IN     PATCHER_GENERIC_PATCH  *Patches,
+  IN     UINT32                 PatchCount,
+  OUT    EFI_STATUS             *Results
+  );
+
 /**
   Apply kext quirk to prelinked.
 
@@ -1069,6 +1150,26 @@ PatcherApplyGenericPatch (
   IN     PATCHER_GENERIC_PATCH  *Patch
   );
 
+/**
+  Apply multiple generic patches in a single pass over the image.
+  The result is identical to calling PatcherApplyGenericPatch for
+  every patch in order.
+
+  @param[in,out] Context         Patcher context.
+  @param[in]     Patches         Patch descriptions.
+  @param[in]     PatchCount      Patch description count.
+  @param[out]    Results         Per-patch status, optional.
+
+  @return  EFI_SUCCESS when all patches were applied.
+**/
+EFI_STATUS
+PatcherApplyGenericPatches (
+  IN OUT PATCHER_CONTEXT        *Context,
+  IN     PATCHER_GENERIC_PATCH  *Patches,
+  IN     UINT32                 PatchCount,
+  OUT    EFI_STATUS             *Results  OPTIONAL
+  );
+
 /**
   Block kext from loading.
 
@@ -1415,6 +1516,26 @@ MkextContextApplyPatch (
   IN     PATCHER_GENERIC_PATCH  *Patch
   );
 
+/**
+  Apply multiple patches to the same kext in mkext in a single pass.
+
+  @param[in,out] Context         Mkext context.
+  @param[in]     Identifier      Kext bundle identifier.
+  @param[in]     Patches         Patches to apply.
+  @param[in]     PatchCount      Patch count.
+  @param[out]    Results         Per-patch status.
+
+  @return  EFI_SUCCESS when all patches were applied.
+**/
+EFI_STATUS
+MkextContextApplyPatches (
+  IN OUT MKEXT_CONTEXT          *Context,
+  IN     CONST CHAR8            *Identifier,
+  IN     PATCHER_GENERIC_PATCH  *Patches,
+  IN     UINT32                 PatchCount,
+  OUT    EFI_STATUS             *Results
+  );
+
 /**
   Apply kext quirk to mkext.
 
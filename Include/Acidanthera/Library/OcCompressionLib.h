@@ -63,6 +63,47 @@ DecompressLZSS (
   IN  UINT32  SrcLen
   );
 
+/**
+  Prepare incremental LZSS decompression.
+
+  @param[out]  Dst         Destination buffer.
+  @param[in]   DstLen      Destination buffer size.
+
+  @return  Decompression context on success otherwise NULL.
+**/
+VOID *
+DecompressLZSSStreamInit (
+  OUT UINT8   *Dst,
+  IN  UINT32  DstLen
+  );
+
+/**
+  Continue incremental LZSS decompression with the next chunk of source data.
+  Source data may be split at any byte.
+
+  @param[in,out]  Context     Decompression context.
+  @param[in]      Src         Source buffer chunk.
+  @param[in]      SrcLen      Source buffer chunk size.
+
+  @return  Total DecompressedLen so far.
+**/
+UINT32
+DecompressLZSSStream (
+  IN OUT VOID         *Context,
+  IN     CONST UINT8  *Src,
+  IN     UINT32       SrcLen
+  );
+
+/**
+  Free incremental LZSS decompression context.
+
+  @param[in]  Context     Decompression context.
+**/
+VOID
+DecompressLZSSStreamFree (
+  IN VOID  *Context
+  );
+
 /**
   Decompress buffer with LZVN algorithm.
 
@@ -81,6 +122,50 @@ DecompressLZVN (
   IN  UINTN        SrcLen
   );
 
+/**
+  Prepare incremental LZVN decompression.
+
+  @param[out]  Dst         Destination buffer.
+  @param[in]   DstLen      Destination buffer size.
+
+  @return  Decompression context on success otherwise NULL.
+**/
+VOID *
+DecompressLZVNStreamInit (
+  OUT UINT8  *Dst,
+  IN  UINTN  DstLen
+  );
+
+/**
+  Continue incremental LZVN decompression with the next chunk of source data.
+  Source data may be split at any byte. Decompression stops at the end of
+  stream, when destination buffer is full, or on corrupted data.
+  Corrupted data is reported at the latest with the next 512 bytes of
+  source data, as an instruction may be split across chunks.
+
+  @param[in,out]  Context     Decompression context.
+  @param[in]      Src         Source buffer chunk.
+  @param[in]      SrcLen      Source buffer chunk size.
+
+  @return  Total DecompressedLen so far, 0 on corrupted data.
+**/
+UINTN
+DecompressLZVNStream (
+  IN OUT VOID         *Context,
+  IN     CONST UINT8  *Src,
+  IN     UINTN        SrcLen
+  );
+
+/**
+  Free incremental LZVN decompression context.
+
+  @param[in]  Context     Decompression context.
+**/
+VOID
+DecompressLZVNStreamFree (
+  IN VOID  *Context
+  );
+
 /**
   Compress buffer with ZLIB algorithm.
 
@@ -117,6 +202,35 @@ DecompressZLIB (
   IN  UINTN        SrcLen
   );
 
+/**
+  Work memory size sufficient for DecompressZLIBWithWorkMemory.
+**/
+#define OC_ZLIB_DECOMPRESS_WORK_MEMORY_SIZE  BASE_64KB
+
+/**
+  Decompress buffer with ZLIB algorithm using caller provided work memory.
+  Does not allocate memory and may be used on application processors.
+
+  @param[out]  Dst             Destination buffer.
+  @param[in]   DstLen          Destination buffer size.
+  @param[in]   Src             Source buffer.
+  @param[in]   SrcLen          Source buffer size.
+  @param[in]   WorkMemory      Work memory buffer.
+  @param[in]   WorkMemorySize  Work memory buffer size, normally
+                               OC_ZLIB_DECOMPRESS_WORK_MEMORY_SIZE.
+
+  @return  DecompressedLen on success otherwise 0.
+**/
+UINTN
+DecompressZLIBWithWorkMemory (
+  OUT UINT8        *Dst,
+  IN  UINTN        DstLen,
+  IN  CONST UINT8  *Src,
+  IN  UINTN        SrcLen,
+  IN  VOID         *WorkMemory,
+  IN  UINTN        WorkMemorySize
+  );
+
 /**
   Decompress buffer with RLE24 algorithm and 8-bit alpha.
   This algorithm is used for encoding IT32/T8MK images in ICNS.
@@ -154,4 +268,19 @@ Adler32 (
   IN UINT32       BufferLen
   );
 
+/**
+  Updates Adler32 checksum with more data.
+  Start with 1 as the initial checksum.
+  @param[in]   Adler          Checksum of the preceding data.
+  @param[in]   Buffer         Source buffer.
+  @param[in]   BufferLen      Source buffer size.
+  @return  Checksum on success otherwise 0.
+**/
+UINT32
+Adler32Update (
+  IN UINT32       Adler,
+  IN CONST UINT8  *Buffer,
+  IN UINT32       BufferLen
+  );
+
 #endif // OC_COMPRESSION_LIB_H
@@ -46,6 +46,11 @@ WITHOUT WARRANTIES OR REPRESENTATIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED.
 #define SHA512_BLOCK_SIZE  128
 #define SHA384_BLOCK_SIZE  SHA512_BLOCK_SIZE
 
+//
+// Amount of buffers hashed in parallel by Sha256Multi.
+//
+#define SHA256_MULTI_LANES  4
+
 //
 // Derived parameters.
 //
@@ -86,6 +91,29 @@ typedef enum OC_SIG_HASH_TYPE_ {
   OcSigHashTypeMax
 } OC_SIG_HASH_TYPE;
 
+//
+// SHA-256 implementations selectable at runtime.
+//
+typedef enum OC_SHA256_BACKEND_ {
+  //
+  // Fastest implementation supported by the CPU.
+  //
+  OcSha256BackendAuto,
+  //
+  // Portable implementation.
+  //
+  OcSha256BackendGeneric,
+  //
+  // Portable implementation, with Sha256Multi hashing SHA256_MULTI_LANES
+  // buffers at once in SIMD lanes.
+  //
+  OcSha256BackendMultiBuffer,
+  //
+  // Intel SHA extensions.
+  //
+  OcSha256BackendShaNi
+} OC_SHA256_BACKEND;
+
 typedef struct AES_CONTEXT_ {
   UINT8 RoundKey[AES_KEY_EXP_SIZE];
   UINT8 Iv[AES_BLOCK_SIZE];
@@ -319,6 +347,63 @@ Sha256 (
   UINTN        Len
   );
 
+/**
+  Hash multiple independent buffers. With the multi-buffer backend
+  SHA256_MULTI_LANES buffers are processed at once, which is most efficient
+  when their lengths are similar.
+
+  @param[out] Hashes   Resulting digests, Count * SHA256_DIGEST_SIZE bytes.
+  @param[in]  Data     Buffers to hash, Count pointers.
+  @param[in]  Lengths  Buffer lengths in bytes, Count entries.
+  @param[in]  Count    Amount of buffers.
+**/
+VOID
+Sha256Multi (
+  OUT UINT8        *Hashes,
+  IN  CONST UINT8  **Data,
+  IN  CONST UINTN  *Lengths,
+  IN  UINTN        Count
+  );
+
+/**
+  Select SHA-256 implementation used by all SHA-256 functions.
+  By default the fastest supported implementation is picked on first use.
+
+  @param[in] Backend  Implementation to use, OcSha256BackendAuto to pick
+                      the fastest one.
+
+  @retval TRUE   Backend was selected.
+  @retval FALSE  Backend is not supported on this CPU or platform.
+**/
+BOOLEAN
+Sha256SetBackend (
+  IN OC_SHA256_BACKEND  Backend
+  );
+
+/**
+  Get SHA-256 implementation used by all SHA-256 functions.
+
+  @retval Selected implementation, never OcSha256BackendAuto.
+**/
+OC_SHA256_BACKEND
+Sha256GetBackend (
+  VOID
+  );
+
+/**
+  Process whole SHA-512 blocks without any buffering or padding.
+
+  @param[in,out] Context  SHA-512 context with the state to update.
+  @param[in]     Data     Data to process, BlockNb * SHA512_BLOCK_SIZE bytes.
+  @param[in]     BlockNb  Number of blocks to process.
+**/
+VOID
+Sha512Transform (
+  SHA512_CONTEXT  *Context,
+  CONST UINT8     *Data,
+  UINTN           BlockNb
+  );
+
 VOID
 Sha512Init (
   SHA512_CONTEXT  *Context
@@ -516,6 +601,25 @@ SecureZeroMem (
   IN  UINTN  Length
   );
 
+/**
+  Hash Password and Salt with iterated SHA-512 as used by OcVerifyPasswordSha512.
+
+  @param[in]  Password      The password to hash.
+  @param[in]  PasswordSize  The size, in bytes, of Password.
+  @param[in]  Salt          The cryptographic salt appended to Password on hash.
+  @param[in]  SaltSize      The size, in bytes, of Salt.
+  @param[out] Hash          The resulting hash, SHA512_DIGEST_SIZE bytes.
+
+**/
+VOID
+OcHashPasswordSha512 (
+  IN  CONST UINT8  *Password,
+  IN  UINT32       PasswordSize,
+  IN  CONST UINT8  *Salt,
+  IN  UINT32       SaltSize,
+  OUT UINT8        *Hash
+  );
+
 /**
   Verify Password and Salt against RefHash.  The used hash function is SHA-512,
   thus the caller must ensure RefHash is at least 64 bytes in size.
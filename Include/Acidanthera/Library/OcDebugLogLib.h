@@ -73,6 +73,18 @@ OcConfigureLogProtocol (
   IN EFI_SIMPLE_FILE_SYSTEM_PROTOCOL  *LogFileSystem  OPTIONAL
   );
 
+/**
+  Write pending log data to UEFI variable and log file.
+  Log file is not written at ExitBootServices, so this must be called
+  before starting the operating system loader.
+
+  @retval EFI_SUCCESS  The log was saved successfully.
+**/
+EFI_STATUS
+OcSaveLog (
+  VOID
+  );
+
 /**
   Install and initialise the Apple Debug Log protocol.
 
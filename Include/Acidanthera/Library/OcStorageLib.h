@@ -40,6 +40,12 @@
 **/
 #define OC_STORAGE_SAFE_PATH_MAX 128
 
+/**
+  Block size for reading and hashing storage files, small enough
+  for the data to remain in CPU cache between the two.
+**/
+#define OC_STORAGE_READ_BLOCK_SIZE BASE_128KB
+
 /**
   Structure declaration for valult file.
 **/
@@ -100,6 +106,14 @@ typedef struct {
   /// Vault status.
   ///
   BOOLEAN                          HasVault;
+  ///
+  /// Vault file path hash index, slots contain file index + 1 or 0.
+  ///
+  UINT32                           *VaultIndex;
+  ///
+  /// Vault file path hash index size - 1.
+  ///
+  UINT32                           VaultIndexMask;
 } OC_STORAGE_CONTEXT;
 
 /**
@@ -168,6 +182,36 @@ OcStorageReadFileUnicode (
   OUT UINT32                           *FileSize OPTIONAL
   );
 
+/**
+  Read file from storage with implicit double (2 byte) null termination,
+  verifying its vault digest while reading in blocks.
+  If storage context was created with valid storage key, then signature
+  checking will be performed.
+
+  @param[in]     Context      Storage context.
+  @param[in]     FilePath     The full path to the file on the device.
+  @param[in,out] Buffer       Caller buffer for file data or NULL to allocate
+                              a new buffer. On success contains file data,
+                              which must be freed by the caller if allocated.
+  @param[in]     BufferSize   Caller buffer size, must fit file size and
+                              null termination. Ignored when allocating.
+  @param[out]    FileSize     The size of the file read. Contains the required
+                              buffer size on EFI_BUFFER_TOO_SMALL.
+
+  @retval EFI_SUCCESS on success.
+  @retval EFI_BUFFER_TOO_SMALL when caller buffer cannot fit the file.
+  @retval EFI_SECURITY_VIOLATION when the file is missing in the vault or
+                                 has unexpected digest.
+**/
+EFI_STATUS
+OcStorageReadFileUnicodeEx (
+  IN     OC_STORAGE_CONTEXT            *Context,
+  IN     CONST CHAR16                  *FilePath,
+  IN OUT VOID                          **Buffer,
+  IN     UINT32                        BufferSize  OPTIONAL,
+     OUT UINT32                        *FileSize
+  );
+
 /**
   Get information about the storage file when possible.
 
@@ -21,18 +21,20 @@
 ///
 /// Current supported log protocol revision.
 ///
-#define OC_LOG_REVISION  0x01000A
+#define OC_LOG_REVISION  0x01000D
 
 ///
 /// The defines for the log flags.
 ///
-#define OC_LOG_ENABLE       BIT0
-#define OC_LOG_CONSOLE      BIT1
-#define OC_LOG_DATA_HUB     BIT2
-#define OC_LOG_SERIAL       BIT3
-#define OC_LOG_VARIABLE     BIT4
-#define OC_LOG_NONVOLATILE  BIT5
-#define OC_LOG_FILE         BIT6
+#define OC_LOG_ENABLE          BIT0
+#define OC_LOG_CONSOLE         BIT1
+#define OC_LOG_DATA_HUB        BIT2
+#define OC_LOG_SERIAL          BIT3
+#define OC_LOG_VARIABLE        BIT4
+#define OC_LOG_NONVOLATILE     BIT5
+#define OC_LOG_FILE            BIT6
+#define OC_LOG_FILE_APPEND     BIT7
+#define OC_LOG_VARIABLE_BATCH  BIT8
 
 typedef UINT32 OC_LOG_OPTIONS;
 
@@ -96,11 +98,12 @@ EFI_STATUS
   );
 
 /**
-  Save the current log
+  Write pending log data to the configured variable and file.
+  Must be called at TPL_CALLBACK or lower.
 
   @param[in] This         This protocol.
-  @param[in] NonVolatile  Variable.
-  @param[in] FilePath     Filepath to save the log. OPTIONAL
+  @param[in] NonVolatile  Unsupported, must be 0.
+  @param[in] FilePath     Unsupported, must be NULL.
 
   @retval EFI_SUCCESS  The log was saved successfully.
 **/
@@ -124,6 +124,149 @@ OcAppleChunklistVerifySignature (
   return Result;
 }
 
+/**
+  Hash RAM disk data in place without copying it.
+
+  @param[in]  ExtentTable   RAM disk extent table.
+  @param[in]  Offset        Data offset in RAM disk.
+  @param[in]  Size          Data size.
+  @param[out] Hash          Resulting SHA-256 digest.
+
+  @retval TRUE on success.
+**/
+STATIC
+BOOLEAN
+InternalHashRamDiskData (
+  IN  CONST APPLE_RAM_DISK_EXTENT_TABLE  *ExtentTable,
+  IN  UINTN                              Offset,
+  IN  UINTN                              Size,
+  OUT UINT8                              *Hash
+  )
+{
+  SHA256_CONTEXT              ShaContext;
+  UINT32                      Index;
+  CONST APPLE_RAM_DISK_EXTENT *Extent;
+  UINTN                       CurrentOffset;
+  UINTN                       LocalOffset;
+  UINTN                       LocalSize;
+
+  Sha256Init (&ShaContext);
+
+  for (
+    Index = 0, CurrentOffset = 0;
+    Index < ExtentTable->ExtentCount && Size > 0;
+    ++Index, CurrentOffset += (UINTN)Extent->Length
+    ) {
+    Extent = &ExtentTable->Extents[Index];
+
+    if (Offset >= CurrentOffset && (Offset - CurrentOffset) < Extent->Length) {
+      LocalOffset = (Offset - CurrentOffset);
+      LocalSize   = (UINTN)MIN ((Extent->Length - LocalOffset), Size);
+      Sha256Update (
+        &ShaContext,
+        (CONST UINT8 *)((UINTN)Extent->Start + LocalOffset),
+        LocalSize
+        );
+
+      Size   -= LocalSize;
+      Offset += LocalSize;
+    }
+  }
+
+  if (Size > 0) {
+    return FALSE;
+  }
+
+  Sha256Final (&ShaContext, Hash);
+  return TRUE;
+}
+
+/**
+  Get RAM disk data pointer when the data is contained in a single extent.
+
+  @param[in]  ExtentTable   RAM disk extent table.
+  @param[in]  Offset        Data offset in RAM disk.
+  @param[in]  Size          Data size.
+
+  @retval Data pointer or NULL when data spans multiple extents.
+**/
+STATIC
+CONST UINT8 *
+InternalGetRamDiskData (
+  IN  CONST APPLE_RAM_DISK_EXTENT_TABLE  *ExtentTable,
+  IN  UINTN                              Offset,
+  IN  UINTN                              Size
+  )
+{
+  UINT32                      Index;
+  CONST APPLE_RAM_DISK_EXTENT *Extent;
+  UINT64                      CurrentOffset;
+
+  for (
+    Index = 0, CurrentOffset = 0;
+    Index < ExtentTable->ExtentCount;
+    ++Index, CurrentOffset += Extent->Length
+    ) {
+    Extent = &ExtentTable->Extents[Index];
+
+    if (Offset >= CurrentOffset && (Offset - CurrentOffset) < Extent->Length) {
+      if (Size > Extent->Length - (Offset - CurrentOffset)) {
+        return NULL;
+      }
+
+      return (CONST UINT8 *)((UINTN)Extent->Start + (Offset - CurrentOffset));
+    }
+  }
+
+  return NULL;
+}
+
+/**
+  Hash a batch of chunks contained in single extents at once
+  and compare them with the reference checksums.
+
+  @param[in]  Chunks    Chunks to verify.
+  @param[in]  Data      Chunk data pointers.
+  @param[in]  Count     Amount of chunks, up to SHA256_MULTI_LANES.
+  @param[out] Failed    Index of the first altered chunk on failure.
+
+  @retval TRUE when all chunks match.
+**/
+STATIC
+BOOLEAN
+InternalVerifyChunkBatch (
+  IN  CONST APPLE_CHUNKLIST_CHUNK  **Chunks,
+  IN  CONST UINT8                  **Data,
+  IN  UINTN                        Count,
+  OUT UINTN                        *Failed
+  )
+{
+  UINTN  Index;
+  UINTN  Lengths[SHA256_MULTI_LANES];
+  UINT8  Hashes[SHA256_MULTI_LANES * SHA256_DIGEST_SIZE];
+
+  ASSERT (Count > 0 && Count <= SHA256_MULTI_LANES);
+
+  for (Index = 0; Index < Count; ++Index) {
+    Lengths[Index] = Chunks[Index]->Length;
+  }
+
+  Sha256Multi (Hashes, Data, Lengths, Count);
+
+  for (Index = 0; Index < Count; ++Index) {
+    if (CompareMem (
+      &Hashes[Index * SHA256_DIGEST_SIZE],
+      Chunks[Index]->Checksum,
+      SHA256_DIGEST_SIZE
+      ) != 0) {
+      *Failed = Index;
+      return FALSE;
+    }
+  }
+
+  return TRUE;
+}
+
 BOOLEAN
 OcAppleChunklistVerifyData (
   IN OUT OC_APPLE_CHUNKLIST_CONTEXT         *Context,
@@ -136,9 +279,10 @@ OcAppleChunklistVerifyData (
   UINT8                       ChunkHash[SHA256_DIGEST_SIZE];
   CONST APPLE_CHUNKLIST_CHUNK *CurrentChunk;
   UINTN                       CurrentOffset;
-
-  UINT32                      ChunkDataSize;
-  VOID                        *ChunkData;
+  CONST APPLE_CHUNKLIST_CHUNK *BatchChunks[SHA256_MULTI_LANES];
+  CONST UINT8                 *BatchData[SHA256_MULTI_LANES];
+  UINTN                       BatchSize;
+  UINTN                       Failed;
 
   ASSERT (Context != NULL);
   ASSERT (Context->Chunks != NULL);
@@ -148,47 +292,326 @@ OcAppleChunklistVerifyData (
     ASSERT (Context->Signature == NULL);
     );
 
-  ChunkDataSize = 0;
-  for (Index = 0; Index < Context->ChunkCount; ++Index) {
+  CurrentOffset = 0;
+  BatchSize     = 0;
+  for (Index = 0; Index < Context->ChunkCount; Index++) {
     CurrentChunk = &Context->Chunks[Index];
-    if (ChunkDataSize < CurrentChunk->Length) {
-      ChunkDataSize = CurrentChunk->Length;
+
+    //
+    // Calculate checksum of data and ensure they match.
+    //
+    DEBUG ((DEBUG_VERBOSE, "OCCL: Validating chunk %lu of %lu\n",
+      (UINT64)Index + 1, (UINT64)Context->ChunkCount));
+
+    //
+    // Chunks within a single extent are hashed in batches,
+    // others are hashed as they come.
+    //
+    BatchData[BatchSize] = InternalGetRamDiskData (
+                             ExtentTable,
+                             CurrentOffset,
+                             CurrentChunk->Length
+                             );
+    if (BatchData[BatchSize] != NULL) {
+      BatchChunks[BatchSize] = CurrentChunk;
+      ++BatchSize;
+
+      if (BatchSize == SHA256_MULTI_LANES) {
+        if (!InternalVerifyChunkBatch (BatchChunks, BatchData, BatchSize, &Failed)) {
+          return FALSE;
+        }
+
+        BatchSize = 0;
+      }
+    } else {
+      Result = InternalHashRamDiskData (
+                 ExtentTable,
+                 CurrentOffset,
+                 CurrentChunk->Length,
+                 ChunkHash
+                 );
+      if (!Result
+        || CompareMem (ChunkHash, CurrentChunk->Checksum, SHA256_DIGEST_SIZE) != 0) {
+        return FALSE;
+      }
     }
+
+    CurrentOffset += CurrentChunk->Length;
+  }
+
+  if (BatchSize > 0) {
+    return InternalVerifyChunkBatch (BatchChunks, BatchData, BatchSize, &Failed);
+  }
+
+  return TRUE;
+}
+
+BOOLEAN
+OcAppleChunklistInitializeVerifier (
+  OUT OC_APPLE_CHUNKLIST_VERIFIER        *Verifier,
+  IN  CONST OC_APPLE_CHUNKLIST_CONTEXT   *Context,
+  IN  CONST APPLE_RAM_DISK_EXTENT_TABLE  *ExtentTable
+  )
+{
+  UINTN   Index;
+  UINTN   OffsetsSize;
+  UINTN   ChunksSize;
+  UINTN   BitmapSize;
+  UINTN   TotalSize;
+  UINT8   *Buffer;
+  UINT64  DataSize;
+
+  ASSERT (Verifier != NULL);
+  ASSERT (Context != NULL);
+  ASSERT (Context->Chunks != NULL);
+  ASSERT (ExtentTable != NULL);
+
+  DEBUG_CODE (
+    ASSERT (Context->Signature == NULL);
+    );
+
+  ZeroMem (Verifier, sizeof (*Verifier));
+
+  //
+  // Offsets go first to remain naturally aligned, one extra for the end offset.
+  //
+  BitmapSize = (Context->ChunkCount + 7) / 8;
+  if (Context->ChunkCount == 0
+    || OcOverflowMulAddUN (Context->ChunkCount, sizeof (UINT64), sizeof (UINT64), &OffsetsSize)
+    || OcOverflowMulUN (Context->ChunkCount, sizeof (APPLE_CHUNKLIST_CHUNK), &ChunksSize)
+    || OcOverflowTriAddUN (OffsetsSize, ChunksSize, BitmapSize, &TotalSize)) {
+    return FALSE;
+  }
+
+  DataSize = 0;
+  for (Index = 0; Index < ExtentTable->ExtentCount; ++Index) {
+    DataSize += ExtentTable->Extents[Index].Length;
   }
 
-  ChunkData = AllocatePool (ChunkDataSize);
-  if (ChunkData == NULL) {
+  Buffer = AllocateZeroPool (TotalSize);
+  if (Buffer == NULL) {
     return FALSE;
   }
 
-  CurrentOffset = 0;
-  for (Index = 0; Index < Context->ChunkCount; Index++) {
-    CurrentChunk = &Context->Chunks[Index];
+  Verifier->ExtentTable     = ExtentTable;
+  Verifier->ChunkCount      = Context->ChunkCount;
+  Verifier->ChunkOffsets    = (UINT64 *) Buffer;
+  Verifier->Chunks          = (APPLE_CHUNKLIST_CHUNK *) (Buffer + OffsetsSize);
+  Verifier->VerifiedChunks  = Buffer + OffsetsSize + ChunksSize;
+  Verifier->UnverifiedCount = Context->ChunkCount;
 
-    Result = OcAppleRamDiskRead (
-               ExtentTable,
-               CurrentOffset,
-               CurrentChunk->Length,
-               ChunkData
-               );
-    if (!Result) {
-      FreePool (ChunkData);
-      return FALSE;
+  CopyMem (Verifier->Chunks, Context->Chunks, ChunksSize);
+
+  for (Index = 0; Index < Context->ChunkCount; ++Index) {
+    Verifier->ChunkOffsets[Index + 1] = Verifier->ChunkOffsets[Index] + Verifier->Chunks[Index].Length;
+  }
+
+  if (Verifier->ChunkOffsets[Context->ChunkCount] > DataSize) {
+    OcAppleChunklistFreeVerifier (Verifier);
+    return FALSE;
+  }
+
+  return TRUE;
+}
+
+/**
+  Verify a batch of chunks collected by InternalVerifyChunks.
+
+  @param[in,out] Verifier  Chunklist verifier.
+  @param[in]     Indices   Chunk indices.
+  @param[in]     Data      Chunk data pointers.
+  @param[in]     Count     Amount of chunks, up to SHA256_MULTI_LANES.
+
+  @retval TRUE when all chunks match.
+**/
+STATIC
+BOOLEAN
+InternalVerifyVerifierBatch (
+  IN OUT OC_APPLE_CHUNKLIST_VERIFIER  *Verifier,
+  IN     CONST UINTN                  *Indices,
+  IN     CONST UINT8                  **Data,
+  IN     UINTN                        Count
+  )
+{
+  CONST APPLE_CHUNKLIST_CHUNK  *Chunks[SHA256_MULTI_LANES];
+  UINTN                        Index;
+  UINTN                        Failed;
+
+  for (Index = 0; Index < Count; ++Index) {
+    Chunks[Index] = &Verifier->Chunks[Indices[Index]];
+  }
+
+  if (!InternalVerifyChunkBatch (Chunks, Data, Count, &Failed)) {
+    DEBUG ((DEBUG_WARN, "OCCL: Chunk %lu has been altered\n", (UINT64)Indices[Failed]));
+    Verifier->Compromised = TRUE;
+    return FALSE;
+  }
+
+  for (Index = 0; Index < Count; ++Index) {
+    Verifier->VerifiedChunks[Indices[Index] / 8] |= (UINT8) (1U << (Indices[Index] % 8));
+  }
+
+  Verifier->UnverifiedCount -= Count;
+  return TRUE;
+}
+
+/**
+  Verify all not yet verified chunks in the range.
+
+  @param[in,out] Verifier  Chunklist verifier.
+  @param[in]     Start     First chunk index.
+  @param[in]     End       Chunk index past the last one.
+
+  @retval TRUE when all chunks match.
+**/
+STATIC
+BOOLEAN
+InternalVerifyChunks (
+  IN OUT OC_APPLE_CHUNKLIST_VERIFIER  *Verifier,
+  IN     UINTN                        Start,
+  IN     UINTN                        End
+  )
+{
+  BOOLEAN      Result;
+  UINT8        ChunkHash[SHA256_DIGEST_SIZE];
+  UINTN        Index;
+  UINTN        BatchIndices[SHA256_MULTI_LANES];
+  CONST UINT8  *BatchData[SHA256_MULTI_LANES];
+  UINTN        BatchSize;
+
+  BatchSize = 0;
+
+  //
+  // Batched chunks remain unverified until flushed.
+  //
+  for (Index = Start; Index < End && Verifier->UnverifiedCount > BatchSize; ++Index) {
+    if ((Verifier->VerifiedChunks[Index / 8] & (1U << (Index % 8))) != 0) {
+      continue;
     }
-    //
-    // Calculate checksum of data and ensure they match.
-    //
+
     DEBUG ((DEBUG_VERBOSE, "OCCL: Validating chunk %lu of %lu\n",
-      (UINT64)Index + 1, (UINT64)Context->ChunkCount));
-    Sha256 (ChunkHash, ChunkData, CurrentChunk->Length);
-    if (CompareMem (ChunkHash, CurrentChunk->Checksum, SHA256_DIGEST_SIZE) != 0) {
-      FreePool (ChunkData);
+      (UINT64)Index + 1, (UINT64)Verifier->ChunkCount));
+
+    BatchData[BatchSize] = InternalGetRamDiskData (
+                             Verifier->ExtentTable,
+                             (UINTN) Verifier->ChunkOffsets[Index],
+                             Verifier->Chunks[Index].Length
+                             );
+    if (BatchData[BatchSize] != NULL) {
+      BatchIndices[BatchSize] = Index;
+      ++BatchSize;
+
+      if (BatchSize == SHA256_MULTI_LANES) {
+        if (!InternalVerifyVerifierBatch (Verifier, BatchIndices, BatchData, BatchSize)) {
+          return FALSE;
+        }
+
+        BatchSize = 0;
+      }
+
+      continue;
+    }
+
+    Result = InternalHashRamDiskData (
+               Verifier->ExtentTable,
+               (UINTN) Verifier->ChunkOffsets[Index],
+               Verifier->Chunks[Index].Length,
+               ChunkHash
+               );
+    if (!Result
+      || CompareMem (ChunkHash, Verifier->Chunks[Index].Checksum, SHA256_DIGEST_SIZE) != 0) {
+      DEBUG ((DEBUG_WARN, "OCCL: Chunk %lu has been altered\n", (UINT64)Index));
+      Verifier->Compromised = TRUE;
       return FALSE;
     }
 
-    CurrentOffset += CurrentChunk->Length;
+    Verifier->VerifiedChunks[Index / 8] |= (UINT8) (1U << (Index % 8));
+    --Verifier->UnverifiedCount;
+  }
+
+  if (BatchSize > 0) {
+    return InternalVerifyVerifierBatch (Verifier, BatchIndices, BatchData, BatchSize);
   }
 
-  FreePool (ChunkData);
   return TRUE;
 }
+
+BOOLEAN
+OcAppleChunklistVerifyDataRange (
+  IN OUT OC_APPLE_CHUNKLIST_VERIFIER  *Verifier,
+  IN     UINTN                        Offset,
+  IN     UINTN                        Size
+  )
+{
+  UINTN   Start;
+  UINTN   End;
+  UINTN   Index;
+  UINT64  RangeEnd;
+
+  ASSERT (Verifier != NULL);
+  ASSERT (Verifier->ChunkOffsets != NULL);
+
+  if (Verifier->Compromised) {
+    return FALSE;
+  }
+
+  RangeEnd = (UINT64) Offset + Size;
+  if (Size == 0 || RangeEnd > Verifier->ChunkOffsets[Verifier->ChunkCount]) {
+    return FALSE;
+  }
+
+  //
+  // Find the last chunk starting at or before Offset.
+  //
+  Start = 0;
+  End   = Verifier->ChunkCount;
+  while (Start < End) {
+    Index = Start + (End - Start) / 2;
+    if (Verifier->ChunkOffsets[Index] <= Offset) {
+      Start = Index + 1;
+    } else {
+      End = Index;
+    }
+  }
+
+  ASSERT (Start > 0);
+
+  //
+  // Find the first chunk starting at or after the range end.
+  //
+  End = Start;
+  while (End < Verifier->ChunkCount && Verifier->ChunkOffsets[End] < RangeEnd) {
+    ++End;
+  }
+
+  return InternalVerifyChunks (Verifier, Start - 1, End);
+}
+
+BOOLEAN
+OcAppleChunklistVerifyRemainingData (
+  IN OUT OC_APPLE_CHUNKLIST_VERIFIER  *Verifier
+  )
+{
+  ASSERT (Verifier != NULL);
+  ASSERT (Verifier->ChunkOffsets != NULL);
+
+  if (Verifier->Compromised) {
+    return FALSE;
+  }
+
+  return InternalVerifyChunks (Verifier, 0, Verifier->ChunkCount);
+}
+
+VOID
+OcAppleChunklistFreeVerifier (
+  IN OUT OC_APPLE_CHUNKLIST_VERIFIER  *Verifier
+  )
+{
+  ASSERT (Verifier != NULL);
+
+  if (Verifier->ChunkOffsets != NULL) {
+    FreePool (Verifier->ChunkOffsets);
+  }
+
+  ZeroMem (Verifier, sizeof (*Verifier));
+}
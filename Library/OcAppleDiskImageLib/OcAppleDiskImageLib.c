@@ -38,6 +38,8 @@ OcAppleDiskImageInitializeContext (
   APPLE_DISK_IMAGE_TRAILER    Trailer;
   UINT32                      DmgBlockCount;
   APPLE_DISK_IMAGE_BLOCK_DATA **DmgBlocks;
+  UINT32                      DmgChunkCount;
+  OC_APPLE_DISK_IMAGE_SORTED_CHUNK *DmgChunks;
   UINT32                      SwappedSig;
   UINT64                      OffsetTop;
 
@@ -174,7 +176,9 @@ OcAppleDiskImageInitializeContext (
              (UINTN)DataForkOffset,
              (UINTN)DataForkLength,
              &DmgBlockCount,
-             &DmgBlocks
+             &DmgBlocks,
+             &DmgChunkCount,
+             &DmgChunks
              );
 
   FreePool (PlistData);
@@ -187,7 +191,20 @@ OcAppleDiskImageInitializeContext (
   Context->ExtentTable = ExtentTable;
   Context->BlockCount  = DmgBlockCount;
   Context->Blocks      = DmgBlocks;
+  Context->ChunkCount  = DmgChunkCount;
+  Context->Chunks      = DmgChunks;
+  Context->ChunkCursor = 0;
+  Context->Verifier    = NULL;
   Context->SectorCount = (UINTN)SectorCount;
+  Context->CacheBudget = OC_APPLE_DISK_IMAGE_CACHE_DEFAULT_SIZE;
+  Context->CacheSize   = 0;
+  Context->CacheClock  = 0;
+  ZeroMem (&Context->CacheStats, sizeof (Context->CacheStats));
+  ZeroMem (Context->CacheEntries, sizeof (Context->CacheEntries));
+  Context->MpServices   = NULL;
+  Context->BspNumber    = 0;
+  Context->WorkerCount  = 0;
+  Context->WorkerMemory = NULL;
 
   return TRUE;
 }
@@ -253,6 +270,60 @@ OcAppleDiskImageVerifyData (
            );
 }
 
+BOOLEAN
+OcAppleDiskImageVerifyDataLazy (
+  IN OUT OC_APPLE_DISK_IMAGE_CONTEXT       *Context,
+  IN     CONST OC_APPLE_CHUNKLIST_CONTEXT  *ChunklistContext
+  )
+{
+  BOOLEAN                     Result;
+  OC_APPLE_CHUNKLIST_VERIFIER *Verifier;
+  UINTN                       CacheBudget;
+
+  ASSERT (Context != NULL);
+  ASSERT (ChunklistContext != NULL);
+  ASSERT (Context->Verifier == NULL);
+
+  Verifier = AllocatePool (sizeof (*Verifier));
+  if (Verifier == NULL) {
+    return FALSE;
+  }
+
+  Result = OcAppleChunklistInitializeVerifier (
+             Verifier,
+             ChunklistContext,
+             Context->ExtentTable
+             );
+  if (!Result) {
+    FreePool (Verifier);
+    return FALSE;
+  }
+
+  //
+  // Drop chunks decompressed before verification was requested.
+  //
+  CacheBudget = Context->CacheBudget;
+  OcAppleDiskImageSetCacheBudget (Context, 0);
+  OcAppleDiskImageSetCacheBudget (Context, CacheBudget);
+
+  Context->Verifier = Verifier;
+  return TRUE;
+}
+
+BOOLEAN
+OcAppleDiskImageVerifyRemainingData (
+  IN OUT OC_APPLE_DISK_IMAGE_CONTEXT  *Context
+  )
+{
+  ASSERT (Context != NULL);
+
+  if (Context->Verifier == NULL) {
+    return TRUE;
+  }
+
+  return OcAppleChunklistVerifyRemainingData (Context->Verifier);
+}
+
 VOID
 OcAppleDiskImageFreeContext (
   IN OC_APPLE_DISK_IMAGE_CONTEXT  *Context
@@ -262,11 +333,20 @@ OcAppleDiskImageFreeContext (
 
   ASSERT (Context != NULL);
 
+  OcAppleDiskImageSetCacheBudget (Context, 0);
+  OcAppleDiskImageSetMpServices (Context, NULL);
+
+  if (Context->Verifier != NULL) {
+    OcAppleChunklistFreeVerifier (Context->Verifier);
+    FreePool (Context->Verifier);
+  }
+
   for (Index = 0; Index < Context->BlockCount; ++Index) {
     FreePool (Context->Blocks[Index]);
   }
 
   FreePool (Context->Blocks);
+  FreePool (Context->Chunks);
 }
 
 VOID
@@ -278,23 +358,580 @@ OcAppleDiskImageFreeFile (
   OcAppleDiskImageFreeContext (Context);
 }
 
+STATIC
+VOID
+InternalDropCacheEntry (
+  IN OUT OC_APPLE_DISK_IMAGE_CONTEXT      *Context,
+  IN OUT OC_APPLE_DISK_IMAGE_CACHE_ENTRY  *Entry
+  )
+{
+  ASSERT (Entry->Chunk != NULL);
+  ASSERT (Context->CacheSize >= Entry->Size);
+
+  FreePool (Entry->Data);
+  Context->CacheSize -= Entry->Size;
+  ZeroMem (Entry, sizeof (*Entry));
+}
+
+STATIC
+OC_APPLE_DISK_IMAGE_CACHE_ENTRY *
+InternalGetOldestCacheEntry (
+  IN OUT OC_APPLE_DISK_IMAGE_CONTEXT      *Context,
+     OUT OC_APPLE_DISK_IMAGE_CACHE_ENTRY  **FreeEntry OPTIONAL
+  )
+{
+  UINT32                          Index;
+  OC_APPLE_DISK_IMAGE_CACHE_ENTRY *Entry;
+  OC_APPLE_DISK_IMAGE_CACHE_ENTRY *Oldest;
+
+  Oldest = NULL;
+
+  if (FreeEntry != NULL) {
+    *FreeEntry = NULL;
+  }
+
+  for (Index = 0; Index < ARRAY_SIZE (Context->CacheEntries); ++Index) {
+    Entry = &Context->CacheEntries[Index];
+
+    if (Entry->Chunk == NULL) {
+      if (FreeEntry != NULL && *FreeEntry == NULL) {
+        *FreeEntry = Entry;
+      }
+    } else if (Oldest == NULL || Entry->LastAccess < Oldest->LastAccess) {
+      Oldest = Entry;
+    }
+  }
+
+  return Oldest;
+}
+
+STATIC
+OC_APPLE_DISK_IMAGE_CACHE_ENTRY *
+InternalFindCacheEntry (
+  IN OUT OC_APPLE_DISK_IMAGE_CONTEXT  *Context,
+  IN     CONST APPLE_DISK_IMAGE_CHUNK *Chunk
+  )
+{
+  UINT32  Index;
+
+  for (Index = 0; Index < ARRAY_SIZE (Context->CacheEntries); ++Index) {
+    if (Context->CacheEntries[Index].Chunk == Chunk) {
+      return &Context->CacheEntries[Index];
+    }
+  }
+
+  return NULL;
+}
+
+STATIC
+BOOLEAN
+InternalInsertCacheEntry (
+  IN OUT OC_APPLE_DISK_IMAGE_CONTEXT  *Context,
+  IN     CONST APPLE_DISK_IMAGE_CHUNK *Chunk,
+  IN     UINT8                        *ChunkData,
+  IN     UINTN                        ChunkSize
+  )
+{
+  OC_APPLE_DISK_IMAGE_CACHE_ENTRY *Entry;
+  OC_APPLE_DISK_IMAGE_CACHE_ENTRY *Oldest;
+
+  if (ChunkSize > Context->CacheBudget) {
+    return FALSE;
+  }
+
+  //
+  // Evict least recently used chunks until the new one fits.
+  //
+  while (TRUE) {
+    Oldest = InternalGetOldestCacheEntry (Context, &Entry);
+    if (Entry != NULL && Context->CacheBudget - Context->CacheSize >= ChunkSize) {
+      break;
+    }
+
+    ASSERT (Oldest != NULL);
+    InternalDropCacheEntry (Context, Oldest);
+    ++Context->CacheStats.Evictions;
+  }
+
+  Entry->Chunk       = Chunk;
+  Entry->Data        = ChunkData;
+  Entry->Size        = ChunkSize;
+  Entry->LastAccess  = ++Context->CacheClock;
+  Context->CacheSize += ChunkSize;
+
+  return TRUE;
+}
+
+STATIC
+UINT8 *
+InternalDecompressChunk (
+  IN OUT OC_APPLE_DISK_IMAGE_CONTEXT  *Context,
+  IN     CONST APPLE_DISK_IMAGE_CHUNK *Chunk,
+  IN     UINTN                        ChunkSize
+  )
+{
+  BOOLEAN  Result;
+  UINT8    *ChunkData;
+  UINT8    *ChunkDataCompressed;
+  UINTN    OutSize;
+
+  if (Context->Verifier != NULL) {
+    Result = OcAppleChunklistVerifyDataRange (
+               Context->Verifier,
+               (UINTN)Chunk->CompressedOffset,
+               (UINTN)Chunk->CompressedLength
+               );
+    if (!Result) {
+      return NULL;
+    }
+  }
+
+  ++Context->CacheStats.Misses;
+
+  ChunkData = AllocatePool (ChunkSize);
+  if (ChunkData == NULL) {
+    return NULL;
+  }
+
+  ChunkDataCompressed = AllocatePool ((UINTN)Chunk->CompressedLength);
+  if (ChunkDataCompressed == NULL) {
+    FreePool (ChunkData);
+    return NULL;
+  }
+
+  Result = OcAppleRamDiskRead (
+             Context->ExtentTable,
+             (UINTN)Chunk->CompressedOffset,
+             (UINTN)Chunk->CompressedLength,
+             ChunkDataCompressed
+             );
+  if (!Result) {
+    FreePool (ChunkDataCompressed);
+    FreePool (ChunkData);
+    return NULL;
+  }
+
+  OutSize = DecompressZLIB (
+              ChunkData,
+              ChunkSize,
+              ChunkDataCompressed,
+              (UINTN)Chunk->CompressedLength
+              );
+  FreePool (ChunkDataCompressed);
+  if (OutSize != ChunkSize) {
+    FreePool (ChunkData);
+    return NULL;
+  }
+
+  return ChunkData;
+}
+
+/**
+  Decompress tasks assigned to the calling application processor.
+  Must not use boot services.
+
+  @param[in,out] Buffer      Decompression batch.
+**/
+STATIC
+VOID
+EFIAPI
+InternalInflateWorker (
+  IN OUT VOID  *Buffer
+  )
+{
+  EFI_STATUS         Status;
+  DMG_INFLATE_BATCH  *Batch;
+  DMG_INFLATE_TASK   *Task;
+  UINTN              ProcessorNumber;
+  UINTN              Worker;
+  UINT32             Index;
+
+  Batch = Buffer;
+
+  Status = Batch->MpServices->WhoAmI (Batch->MpServices, &ProcessorNumber);
+  if (EFI_ERROR (Status) || ProcessorNumber == Batch->BspNumber) {
+    return;
+  }
+
+  Worker = ProcessorNumber < Batch->BspNumber ? ProcessorNumber : ProcessorNumber - 1;
+  if (Worker >= Batch->WorkerCount) {
+    return;
+  }
+
+  for (Index = (UINT32) Worker; Index < Batch->TaskCount; Index += (UINT32) Batch->WorkerCount) {
+    Task = &Batch->Tasks[Index];
+    Task->Result = DecompressZLIBWithWorkMemory (
+      Task->Data,
+      Task->Size,
+      Task->Compressed,
+      Task->CompressedSize,
+      &Batch->WorkerMemory[Worker * OC_ZLIB_DECOMPRESS_WORK_MEMORY_SIZE],
+      OC_ZLIB_DECOMPRESS_WORK_MEMORY_SIZE
+      ) == Task->Size;
+    Task->Done = TRUE;
+  }
+}
+
+STATIC
+VOID
+InternalInflateTasks (
+  IN OUT OC_APPLE_DISK_IMAGE_CONTEXT  *Context,
+  IN OUT DMG_INFLATE_TASK             *Tasks,
+  IN     UINT32                       TaskCount
+  )
+{
+  DMG_INFLATE_BATCH  Batch;
+  UINT32             Index;
+
+  Batch.MpServices   = Context->MpServices;
+  Batch.BspNumber    = Context->BspNumber;
+  Batch.WorkerCount  = Context->WorkerCount;
+  Batch.WorkerMemory = Context->WorkerMemory;
+  Batch.Tasks        = Tasks;
+  Batch.TaskCount    = TaskCount;
+
+  //
+  // StartupAllAPs fails when application processors are disabled or busy,
+  // leftover tasks are decompressed on the BSP.
+  //
+  if (TaskCount > 1) {
+    Context->MpServices->StartupAllAPs (
+      Context->MpServices,
+      InternalInflateWorker,
+      FALSE,
+      NULL,
+      0,
+      &Batch,
+      NULL
+      );
+  }
+
+  for (Index = 0; Index < TaskCount; ++Index) {
+    if (!Tasks[Index].Done) {
+      Tasks[Index].Result = DecompressZLIB (
+        Tasks[Index].Data,
+        Tasks[Index].Size,
+        Tasks[Index].Compressed,
+        Tasks[Index].CompressedSize
+        ) == Tasks[Index].Size;
+      Tasks[Index].Done = TRUE;
+    }
+  }
+}
+
+/**
+  Decompress the chunk together with uncached chunks following it.
+  Following chunks are put in cache, the chunk itself is returned.
+
+  @param[in,out] Context     Disk image context.
+  @param[in]     ChunkIndex  Index of the chunk in Context->Chunks.
+  @param[in]     ChunkSize   Decompressed chunk size.
+
+  @retval decompressed chunk data or NULL.
+**/
+STATIC
+UINT8 *
+InternalDecompressChunkBatch (
+  IN OUT OC_APPLE_DISK_IMAGE_CONTEXT  *Context,
+  IN     UINT32                       ChunkIndex,
+  IN     UINTN                        ChunkSize
+  )
+{
+  BOOLEAN                 Result;
+  DMG_INFLATE_TASK        Tasks[DMG_INFLATE_MAX_TASKS];
+  DMG_INFLATE_TASK        *Task;
+  UINT32                  TaskCount;
+  UINT32                  MaxTasks;
+  UINTN                   PrefetchSize;
+  UINT32                  Index;
+  UINT32                  EndIndex;
+  APPLE_DISK_IMAGE_CHUNK  *Chunk;
+  UINT64                  Size;
+  UINT8                   *ChunkData;
+
+  ZeroMem (Tasks, sizeof (Tasks));
+
+  TaskCount    = 0;
+  MaxTasks     = (UINT32) MIN (Context->WorkerCount * 2, ARRAY_SIZE (Tasks));
+  PrefetchSize = 0;
+  EndIndex     = ChunkIndex + MIN (Context->ChunkCount - ChunkIndex, DMG_INFLATE_PREFETCH_WINDOW);
+
+  for (Index = ChunkIndex; Index < EndIndex && TaskCount < MaxTasks; ++Index) {
+    Chunk = Context->Chunks[Index].Chunk;
+
+    if (Index != ChunkIndex) {
+      if (Chunk->Type != APPLE_DISK_IMAGE_CHUNK_TYPE_ZLIB
+        || InternalFindCacheEntry (Context, Chunk) != NULL) {
+        continue;
+      }
+
+      //
+      // Prefetch within half of the cache budget.
+      //
+      Result = OcOverflowMulU64 (
+                 Chunk->SectorCount,
+                 APPLE_DISK_IMAGE_SECTOR_SIZE,
+                 &Size
+                 );
+      if (Result || Size > Context->CacheBudget / 2 - PrefetchSize) {
+        break;
+      }
+    } else {
+      Size = ChunkSize;
+    }
+
+    //
+    // Verification is not thread-safe and is done on the BSP in advance.
+    //
+    if (Context->Verifier != NULL) {
+      Result = OcAppleChunklistVerifyDataRange (
+                 Context->Verifier,
+                 (UINTN)Chunk->CompressedOffset,
+                 (UINTN)Chunk->CompressedLength
+                 );
+      if (!Result) {
+        break;
+      }
+    }
+
+    Task                 = &Tasks[TaskCount];
+    Task->Chunk          = Chunk;
+    Task->CompressedSize = (UINTN)Chunk->CompressedLength;
+    Task->Size           = (UINTN)Size;
+    Task->Data           = AllocatePool (Task->Size);
+    Task->Compressed     = AllocatePool (Task->CompressedSize);
+    if (Task->Data == NULL || Task->Compressed == NULL) {
+      break;
+    }
+
+    Result = OcAppleRamDiskRead (
+               Context->ExtentTable,
+               (UINTN)Chunk->CompressedOffset,
+               Task->CompressedSize,
+               Task->Compressed
+               );
+    if (!Result) {
+      break;
+    }
+
+    if (Index != ChunkIndex) {
+      PrefetchSize += Task->Size;
+      ++Context->CacheStats.Prefetches;
+    }
+
+    ++Context->CacheStats.Misses;
+    ++TaskCount;
+  }
+
+  //
+  // Drop the task that failed to be prepared.
+  //
+  if (TaskCount < ARRAY_SIZE (Tasks)) {
+    if (Tasks[TaskCount].Data != NULL) {
+      FreePool (Tasks[TaskCount].Data);
+    }
+
+    if (Tasks[TaskCount].Compressed != NULL) {
+      FreePool (Tasks[TaskCount].Compressed);
+    }
+  }
+
+  if (TaskCount == 0) {
+    return NULL;
+  }
+
+  InternalInflateTasks (Context, Tasks, TaskCount);
+
+  ChunkData = Tasks[0].Result ? Tasks[0].Data : NULL;
+  if (ChunkData == NULL) {
+    FreePool (Tasks[0].Data);
+  }
+  FreePool (Tasks[0].Compressed);
+
+  for (Index = 1; Index < TaskCount; ++Index) {
+    Task = &Tasks[Index];
+    if (!Task->Result
+      || !InternalInsertCacheEntry (Context, Task->Chunk, Task->Data, Task->Size)) {
+      FreePool (Task->Data);
+    }
+
+    FreePool (Task->Compressed);
+  }
+
+  return ChunkData;
+}
+
+/**
+  Get decompressed chunk data from cache, decompressing it on miss.
+
+  @param[in,out] Context     Disk image context.
+  @param[in]     ChunkIndex  Index of the chunk in Context->Chunks.
+  @param[in]     ChunkSize   Decompressed chunk size.
+  @param[out]    Cached      Set to TRUE when returned data is owned by cache,
+                             otherwise it must be freed by the caller.
+
+  @retval decompressed chunk data or NULL.
+**/
+STATIC
+UINT8 *
+InternalGetCachedChunk (
+  IN OUT OC_APPLE_DISK_IMAGE_CONTEXT  *Context,
+  IN     UINT32                       ChunkIndex,
+  IN     UINTN                        ChunkSize,
+     OUT BOOLEAN                      *Cached
+  )
+{
+  CONST APPLE_DISK_IMAGE_CHUNK    *Chunk;
+  OC_APPLE_DISK_IMAGE_CACHE_ENTRY *Entry;
+  UINT8                           *ChunkData;
+
+  Chunk = Context->Chunks[ChunkIndex].Chunk;
+
+  Entry = InternalFindCacheEntry (Context, Chunk);
+  if (Entry != NULL) {
+    ++Context->CacheStats.Hits;
+    Entry->LastAccess = ++Context->CacheClock;
+    *Cached = TRUE;
+    return Entry->Data;
+  }
+
+  *Cached = FALSE;
+
+  //
+  // Prefetching is pointless when decompressed chunks cannot be cached.
+  //
+  if (Context->MpServices != NULL && ChunkSize <= Context->CacheBudget) {
+    ChunkData = InternalDecompressChunkBatch (Context, ChunkIndex, ChunkSize);
+  } else {
+    ChunkData = InternalDecompressChunk (Context, Chunk, ChunkSize);
+  }
+
+  if (ChunkData == NULL) {
+    return NULL;
+  }
+
+  *Cached = InternalInsertCacheEntry (Context, Chunk, ChunkData, ChunkSize);
+  return ChunkData;
+}
+
+VOID
+OcAppleDiskImageSetCacheBudget (
+  IN OUT OC_APPLE_DISK_IMAGE_CONTEXT  *Context,
+  IN     UINTN                        Budget
+  )
+{
+  OC_APPLE_DISK_IMAGE_CACHE_ENTRY *Oldest;
+
+  ASSERT (Context != NULL);
+
+  Context->CacheBudget = Budget;
+
+  while (Context->CacheSize > Budget) {
+    Oldest = InternalGetOldestCacheEntry (Context, NULL);
+    ASSERT (Oldest != NULL);
+    InternalDropCacheEntry (Context, Oldest);
+  }
+}
+
+VOID
+OcAppleDiskImageGetCacheStats (
+  IN  CONST OC_APPLE_DISK_IMAGE_CONTEXT  *Context,
+  OUT OC_APPLE_DISK_IMAGE_CACHE_STATS    *Stats
+  )
+{
+  ASSERT (Context != NULL);
+  ASSERT (Stats != NULL);
+
+  CopyMem (Stats, &Context->CacheStats, sizeof (*Stats));
+}
+
+EFI_STATUS
+OcAppleDiskImageSetMpServices (
+  IN OUT OC_APPLE_DISK_IMAGE_CONTEXT  *Context,
+  IN     EFI_MP_SERVICES_PROTOCOL     *MpServices  OPTIONAL
+  )
+{
+  EFI_STATUS  Status;
+  UINTN       NumberOfProcessors;
+  UINTN       NumberOfEnabledProcessors;
+  UINTN       BspNumber;
+  UINTN       WorkerCount;
+  UINT8       *WorkerMemory;
+
+  ASSERT (Context != NULL);
+
+  if (Context->WorkerMemory != NULL) {
+    FreePool (Context->WorkerMemory);
+  }
+
+  Context->MpServices   = NULL;
+  Context->BspNumber    = 0;
+  Context->WorkerCount  = 0;
+  Context->WorkerMemory = NULL;
+
+  if (MpServices == NULL) {
+    return EFI_SUCCESS;
+  }
+
+  Status = MpServices->GetNumberOfProcessors (
+    MpServices,
+    &NumberOfProcessors,
+    &NumberOfEnabledProcessors
+    );
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  if (NumberOfEnabledProcessors <= 1) {
+    return EFI_UNSUPPORTED;
+  }
+
+  Status = MpServices->WhoAmI (MpServices, &BspNumber);
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  //
+  // Disabled processors keep their index, their tasks are done on the BSP.
+  //
+  WorkerCount  = MIN (NumberOfProcessors - 1, OC_APPLE_DISK_IMAGE_MAX_WORKERS);
+  WorkerMemory = AllocatePool (WorkerCount * OC_ZLIB_DECOMPRESS_WORK_MEMORY_SIZE);
+  if (WorkerMemory == NULL) {
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  DEBUG ((
+    DEBUG_INFO,
+    "OCDI: Using %u/%u processors for decompression\n",
+    (UINT32) WorkerCount,
+    (UINT32) NumberOfEnabledProcessors
+    ));
+
+  Context->MpServices   = MpServices;
+  Context->BspNumber    = BspNumber;
+  Context->WorkerCount  = WorkerCount;
+  Context->WorkerMemory = WorkerMemory;
+
+  return EFI_SUCCESS;
+}
+
 BOOLEAN
 OcAppleDiskImageRead (
-  IN  OC_APPLE_DISK_IMAGE_CONTEXT  *Context,
-  IN  UINTN                        Lba,
-  IN  UINTN                        BufferSize,
-  OUT VOID                         *Buffer
+  IN OUT OC_APPLE_DISK_IMAGE_CONTEXT  *Context,
+  IN     UINTN                        Lba,
+  IN     UINTN                        BufferSize,
+     OUT VOID                         *Buffer
   )
 {
   BOOLEAN                     Result;
 
-  APPLE_DISK_IMAGE_BLOCK_DATA *BlockData;
+  UINT32                      ChunkIndex;
   APPLE_DISK_IMAGE_CHUNK      *Chunk;
   UINT64                      ChunkTotalLength;
   UINT64                      ChunkLength;
   UINT64                      ChunkOffset;
   UINT8                       *ChunkData;
-  UINT8                       *ChunkDataCompressed;
+  BOOLEAN                     ChunkCached;
 
   UINTN                       LbaCurrent;
   UINTN                       LbaOffset;
@@ -303,8 +940,6 @@ OcAppleDiskImageRead (
   UINTN                       BufferChunkSize;
   UINT8                       *BufferCurrent;
 
-  UINTN                       OutSize;
-
   ASSERT (Context != NULL);
   ASSERT (Buffer != NULL);
   ASSERT (Lba < Context->SectorCount);
@@ -313,13 +948,18 @@ OcAppleDiskImageRead (
   RemainingBufferSize = BufferSize;
   BufferCurrent       = Buffer;
 
-  while (RemainingBufferSize > 0) {
-    Result = InternalGetBlockChunk (Context, LbaCurrent, &BlockData, &Chunk);
-    if (!Result) {
-      return FALSE;
-    }
+  if (RemainingBufferSize == 0) {
+    return TRUE;
+  }
+
+  Result = InternalGetBlockChunk (Context, LbaCurrent, &ChunkIndex);
+  if (!Result) {
+    return FALSE;
+  }
 
-    LbaOffset = (LbaCurrent - (UINTN)DMG_SECTOR_START_ABS (BlockData, Chunk));
+  while (TRUE) {
+    Chunk     = Context->Chunks[ChunkIndex].Chunk;
+    LbaOffset = (LbaCurrent - (UINTN)Context->Chunks[ChunkIndex].SectorNumber);
     LbaLength = ((UINTN)Chunk->SectorCount - LbaOffset);
 
     Result = OcOverflowMulU64 (
@@ -354,6 +994,17 @@ OcAppleDiskImageRead (
 
       case APPLE_DISK_IMAGE_CHUNK_TYPE_RAW:
       {
+        if (Context->Verifier != NULL) {
+          Result = OcAppleChunklistVerifyDataRange (
+                     Context->Verifier,
+                     (UINTN)(Chunk->CompressedOffset + ChunkOffset),
+                     BufferChunkSize
+                     );
+          if (!Result) {
+            return FALSE;
+          }
+        }
+
         Result = OcAppleRamDiskRead (
                    Context->ExtentTable,
                    (UINTN)(Chunk->CompressedOffset + ChunkOffset),
@@ -369,36 +1020,20 @@ OcAppleDiskImageRead (
 
       case APPLE_DISK_IMAGE_CHUNK_TYPE_ZLIB:
       {
-        ChunkData = AllocatePool ((UINTN)(ChunkTotalLength + Chunk->CompressedLength));
+        ChunkData = InternalGetCachedChunk (
+                      Context,
+                      ChunkIndex,
+                      (UINTN)ChunkTotalLength,
+                      &ChunkCached
+                      );
         if (ChunkData == NULL) {
           return FALSE;
         }
 
-        ChunkDataCompressed = (ChunkData + (UINTN)ChunkTotalLength);
-        Result = OcAppleRamDiskRead (
-                   Context->ExtentTable,
-                   (UINTN)Chunk->CompressedOffset,
-                   (UINTN)Chunk->CompressedLength,
-                   ChunkDataCompressed
-                   );
-        if (!Result) {
-          FreePool (ChunkData);
-          return FALSE;
-        }
-
-        OutSize = DecompressZLIB (
-                    ChunkData,
-                    (UINTN)ChunkTotalLength,
-                    ChunkDataCompressed,
-                    (UINTN)Chunk->CompressedLength
-                    );
-        if (OutSize != (UINTN)ChunkTotalLength) {
+        CopyMem (BufferCurrent, (ChunkData + ChunkOffset), BufferChunkSize);
+        if (!ChunkCached) {
           FreePool (ChunkData);
-          return FALSE;
         }
-
-        CopyMem (BufferCurrent, (ChunkData + ChunkOffset), BufferChunkSize);
-        FreePool (ChunkData);
         break;
       }
 
@@ -416,6 +1051,21 @@ OcAppleDiskImageRead (
     RemainingBufferSize -= BufferChunkSize;
     BufferCurrent       += BufferChunkSize;
     LbaCurrent          += LbaLength;
+
+    if (RemainingBufferSize == 0) {
+      break;
+    }
+
+    //
+    // Advance to the next chunk, which must start right after the current one.
+    //
+    ++ChunkIndex;
+    if (ChunkIndex >= Context->ChunkCount
+      || Context->Chunks[ChunkIndex].SectorNumber != LbaCurrent) {
+      return FALSE;
+    }
+
+    Context->ChunkCursor = ChunkIndex;
   }
 
   return TRUE;
@@ -13,6 +13,7 @@
 #include <Uefi.h>
 
 #include <Library/BaseLib.h>
+#include <Library/BaseMemoryLib.h>
 #include <Library/DebugLib.h>
 #include <Library/MemoryAllocationLib.h>
 #include <Library/OcAppleDiskImageLib.h>
@@ -160,15 +161,144 @@ InternalSwapBlockData (
   return TRUE;
 }
 
+STATIC
+VOID
+InternalSiftSortedChunks (
+  IN OUT OC_APPLE_DISK_IMAGE_SORTED_CHUNK  *Chunks,
+  IN     UINT32                            Root,
+  IN     UINT32                            Count
+  )
+{
+  OC_APPLE_DISK_IMAGE_SORTED_CHUNK  Temp;
+  UINT32                            Child;
+
+  while ((Child = Root * 2 + 1) < Count) {
+    if (Child + 1 < Count
+      && Chunks[Child + 1].SectorNumber > Chunks[Child].SectorNumber) {
+      ++Child;
+    }
+
+    if (Chunks[Root].SectorNumber >= Chunks[Child].SectorNumber) {
+      break;
+    }
+
+    CopyMem (&Temp, &Chunks[Root], sizeof (Temp));
+    CopyMem (&Chunks[Root], &Chunks[Child], sizeof (Temp));
+    CopyMem (&Chunks[Child], &Temp, sizeof (Temp));
+    Root = Child;
+  }
+}
+
+/**
+  Flatten chunks of all blocks into one array sorted by absolute sector.
+  Chunks not covering any sectors, like comments and terminators, are skipped.
+  Overlapping chunks are rejected, so that every sector maps to one chunk.
+**/
+STATIC
+BOOLEAN
+InternalBuildSortedChunks (
+  IN  UINT32                            BlockCount,
+  IN  APPLE_DISK_IMAGE_BLOCK_DATA       **Blocks,
+  OUT UINT32                            *ChunkCount,
+  OUT OC_APPLE_DISK_IMAGE_SORTED_CHUNK  **Chunks
+  )
+{
+  UINT32                            NumChunks;
+  UINT32                            ChunksSize;
+  OC_APPLE_DISK_IMAGE_SORTED_CHUNK  *SortedChunks;
+  OC_APPLE_DISK_IMAGE_SORTED_CHUNK  Temp;
+  APPLE_DISK_IMAGE_CHUNK            *Chunk;
+  BOOLEAN                           Sorted;
+  UINT32                            BlockIndex;
+  UINT32                            Index;
+
+  NumChunks = 0;
+  for (BlockIndex = 0; BlockIndex < BlockCount; ++BlockIndex) {
+    if (OcOverflowAddU32 (NumChunks, Blocks[BlockIndex]->ChunkCount, &NumChunks)) {
+      return FALSE;
+    }
+  }
+
+  if (NumChunks == 0
+    || OcOverflowMulU32 (NumChunks, sizeof (*SortedChunks), &ChunksSize)) {
+    return FALSE;
+  }
+
+  SortedChunks = AllocatePool (ChunksSize);
+  if (SortedChunks == NULL) {
+    return FALSE;
+  }
+
+  NumChunks = 0;
+  Sorted    = TRUE;
+  for (BlockIndex = 0; BlockIndex < BlockCount; ++BlockIndex) {
+    for (Index = 0; Index < Blocks[BlockIndex]->ChunkCount; ++Index) {
+      Chunk = &Blocks[BlockIndex]->Chunks[Index];
+      if (Chunk->SectorCount == 0) {
+        continue;
+      }
+
+      //
+      // Sector range was validated in InternalSwapBlockData.
+      //
+      SortedChunks[NumChunks].SectorNumber = DMG_SECTOR_START_ABS (Blocks[BlockIndex], Chunk);
+      SortedChunks[NumChunks].Chunk        = Chunk;
+
+      if (NumChunks > 0
+        && SortedChunks[NumChunks - 1].SectorNumber > SortedChunks[NumChunks].SectorNumber) {
+        Sorted = FALSE;
+      }
+
+      ++NumChunks;
+    }
+  }
+
+  if (NumChunks == 0) {
+    FreePool (SortedChunks);
+    return FALSE;
+  }
+
+  //
+  // Chunks are normally stored in order, otherwise heap sort them.
+  //
+  if (!Sorted) {
+    for (Index = NumChunks / 2; Index > 0; --Index) {
+      InternalSiftSortedChunks (SortedChunks, Index - 1, NumChunks);
+    }
+
+    for (Index = NumChunks - 1; Index > 0; --Index) {
+      CopyMem (&Temp, &SortedChunks[0], sizeof (Temp));
+      CopyMem (&SortedChunks[0], &SortedChunks[Index], sizeof (Temp));
+      CopyMem (&SortedChunks[Index], &Temp, sizeof (Temp));
+      InternalSiftSortedChunks (SortedChunks, 0, Index);
+    }
+  }
+
+  for (Index = 1; Index < NumChunks; ++Index) {
+    if (SortedChunks[Index - 1].SectorNumber + SortedChunks[Index - 1].Chunk->SectorCount
+      > SortedChunks[Index].SectorNumber) {
+      DEBUG ((DEBUG_INFO, "OCDI: Overlapping chunks at sector %Lu\n", SortedChunks[Index].SectorNumber));
+      FreePool (SortedChunks);
+      return FALSE;
+    }
+  }
+
+  *ChunkCount = NumChunks;
+  *Chunks     = SortedChunks;
+  return TRUE;
+}
+
 BOOLEAN
 InternalParsePlist (
-  IN  CHAR8                        *Plist,
-  IN  UINT32                       PlistSize,
-  IN  UINTN                        SectorCount,
-  IN  UINTN                        DataForkOffset,
-  IN  UINTN                        DataForkSize,
-  OUT UINT32                       *BlockCount,
-  OUT APPLE_DISK_IMAGE_BLOCK_DATA  ***Blocks
+  IN  CHAR8                             *Plist,
+  IN  UINT32                            PlistSize,
+  IN  UINTN                             SectorCount,
+  IN  UINTN                             DataForkOffset,
+  IN  UINTN                             DataForkSize,
+  OUT UINT32                            *BlockCount,
+  OUT APPLE_DISK_IMAGE_BLOCK_DATA       ***Blocks,
+  OUT UINT32                            *ChunkCount,
+  OUT OC_APPLE_DISK_IMAGE_SORTED_CHUNK  **Chunks
   )
 {
   BOOLEAN                     Result;
@@ -196,6 +326,8 @@ InternalParsePlist (
   ASSERT (PlistSize > 0);
   ASSERT (BlockCount != NULL);
   ASSERT (Blocks != NULL);
+  ASSERT (ChunkCount != NULL);
+  ASSERT (Chunks != NULL);
 
   DmgBlocks = NULL;
 
@@ -300,9 +432,13 @@ InternalParsePlist (
     }
   }
 
+  Result = InternalBuildSortedChunks (NumDmgBlocks, DmgBlocks, ChunkCount, Chunks);
+  if (!Result) {
+    goto DONE_ERROR;
+  }
+
   *BlockCount = NumDmgBlocks;
   *Blocks     = DmgBlocks;
-  Result      = TRUE;
 
 DONE_ERROR:
   if (!Result && (DmgBlocks != NULL)) {
@@ -322,34 +458,54 @@ DONE_ERROR:
 
 BOOLEAN
 InternalGetBlockChunk (
-  IN  OC_APPLE_DISK_IMAGE_CONTEXT  *Context,
-  IN  UINTN                        Lba,
-  OUT APPLE_DISK_IMAGE_BLOCK_DATA  **Data,
-  OUT APPLE_DISK_IMAGE_CHUNK       **Chunk
+  IN OUT OC_APPLE_DISK_IMAGE_CONTEXT  *Context,
+  IN     UINTN                        Lba,
+     OUT UINT32                       *ChunkIndex
   )
 {
-  UINT32                      BlockIndex;
-  UINT32                      ChunkIndex;
-  APPLE_DISK_IMAGE_BLOCK_DATA *BlockData;
-  APPLE_DISK_IMAGE_CHUNK      *BlockChunk;
-
-  for (BlockIndex = 0; BlockIndex < Context->BlockCount; ++BlockIndex) {
-    BlockData = Context->Blocks[BlockIndex];
-
-    if ((Lba >= BlockData->SectorNumber)
-     && (Lba < (BlockData->SectorNumber + BlockData->SectorCount))) {
-      for (ChunkIndex = 0; ChunkIndex < BlockData->ChunkCount; ++ChunkIndex) {
-        BlockChunk = &BlockData->Chunks[ChunkIndex];
-
-        if ((Lba >= DMG_SECTOR_START_ABS (BlockData, BlockChunk))
-         && (Lba < (DMG_SECTOR_START_ABS (BlockData, BlockChunk) + BlockChunk->SectorCount))) {
-          *Data  = BlockData;
-          *Chunk = BlockChunk;
-          return TRUE;
-        }
-      }
+  OC_APPLE_DISK_IMAGE_SORTED_CHUNK  *Chunks;
+  UINT32                            Index;
+  UINT32                            Start;
+  UINT32                            End;
+
+  Chunks = Context->Chunks;
+
+  //
+  // Try the last found chunk and the next one first.
+  //
+  for (Index = Context->ChunkCursor; Index < MIN (Context->ChunkCursor + 2, Context->ChunkCount); ++Index) {
+    if (Lba >= Chunks[Index].SectorNumber
+      && Lba - Chunks[Index].SectorNumber < Chunks[Index].Chunk->SectorCount) {
+      Context->ChunkCursor = Index;
+      *ChunkIndex          = Index;
+      return TRUE;
     }
   }
 
-  return FALSE;
+  //
+  // Find the last chunk starting at or before Lba.
+  //
+  Start = 0;
+  End   = Context->ChunkCount;
+  while (Start < End) {
+    Index = Start + (End - Start) / 2;
+    if (Chunks[Index].SectorNumber <= Lba) {
+      Start = Index + 1;
+    } else {
+      End = Index;
+    }
+  }
+
+  if (Start == 0) {
+    return FALSE;
+  }
+
+  Index = Start - 1;
+  if (Lba - Chunks[Index].SectorNumber >= Chunks[Index].Chunk->SectorCount) {
+    return FALSE;
+  }
+
+  Context->ChunkCursor = Index;
+  *ChunkIndex          = Index;
+  return TRUE;
 }
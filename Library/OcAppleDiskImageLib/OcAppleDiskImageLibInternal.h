@@ -26,23 +26,72 @@
 #define DMG_PLIST_ID                 "ID"
 #define DMG_PLIST_NAME               "Name"
 
+//
+// Maximum amount of chunks decompressed at once, half of the cache
+// so that prefetched chunks do not evict each other.
+//
+#define DMG_INFLATE_MAX_TASKS        (OC_APPLE_DISK_IMAGE_CACHE_MAX_ENTRIES / 2)
+
+//
+// Maximum amount of chunks looked through for prefetching.
+//
+#define DMG_INFLATE_PREFETCH_WINDOW  64U
+
+//
+// Chunk decompression task.
+//
+typedef struct {
+  CONST APPLE_DISK_IMAGE_CHUNK  *Chunk;
+  UINT8                         *Compressed;
+  UINTN                         CompressedSize;
+  UINT8                         *Data;
+  UINTN                         Size;
+  BOOLEAN                       Done;
+  BOOLEAN                       Result;
+} DMG_INFLATE_TASK;
+
+//
+// Chunk decompression tasks shared with application processors.
+// Every worker handles every WorkerCount-th task starting from its index.
+//
+typedef struct {
+  EFI_MP_SERVICES_PROTOCOL  *MpServices;
+  UINTN                     BspNumber;
+  UINTN                     WorkerCount;
+  UINT8                     *WorkerMemory;
+  DMG_INFLATE_TASK          *Tasks;
+  UINT32                    TaskCount;
+} DMG_INFLATE_BATCH;
+
 BOOLEAN
 InternalParsePlist (
-  IN  CHAR8                        *Plist,
-  IN  UINT32                       PlistSize,
-  IN  UINTN                        SectorCount,
-  IN  UINTN                        DataForkOffset,
-  IN  UINTN                        DataForkSize,
-  OUT UINT32                       *BlockCount,
-  OUT APPLE_DISK_IMAGE_BLOCK_DATA  ***Blocks
+  IN  CHAR8                             *Plist,
+  IN  UINT32                            PlistSize,
+  IN  UINTN                             SectorCount,
+  IN  UINTN                             DataForkOffset,
+  IN  UINTN                             DataForkSize,
+  OUT UINT32                            *BlockCount,
+  OUT APPLE_DISK_IMAGE_BLOCK_DATA       ***Blocks,
+  OUT UINT32                            *ChunkCount,
+  OUT OC_APPLE_DISK_IMAGE_SORTED_CHUNK  **Chunks
   );
 
+/**
+  Find the chunk containing the sector.
+  The last found chunk and the one after it are checked first,
+  so that sequential reads do not need to search.
+
+  @param[in,out] Context     Disk image context.
+  @param[in]     Lba         Absolute sector number.
+  @param[out]    ChunkIndex  Index of the chunk in Context->Chunks.
+
+  @retval TRUE on success.
+**/
 BOOLEAN
 InternalGetBlockChunk (
-  IN  OC_APPLE_DISK_IMAGE_CONTEXT  *Context,
-  IN  UINTN                        Lba,
-  OUT APPLE_DISK_IMAGE_BLOCK_DATA  **Data,
-  OUT APPLE_DISK_IMAGE_CHUNK       **Chunk
+  IN OUT OC_APPLE_DISK_IMAGE_CONTEXT  *Context,
+  IN     UINTN                        Lba,
+     OUT UINT32                       *ChunkIndex
   );
 
 #endif // APPLE_DISK_IMAGE_LIB_INTERNAL_H
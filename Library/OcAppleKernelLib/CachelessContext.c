@@ -394,6 +394,20 @@ ScanExtensions (
             }
           }
 
+          Status = InternalKextIdentifierMapInsert (
+            &Context->BuiltInKextsMap,
+            BuiltinKext->Identifier,
+            NULL,
+            BuiltinKext
+            );
+          if (EFI_ERROR (Status)) {
+            FreeBuiltInKext (BuiltinKext);
+            FileKext->Close (FileKext);
+            File->SetPosition (File, 0);
+            FreePool (FileInfo);
+            return Status;
+          }
+
           InsertTailList (&Context->BuiltInKexts, &BuiltinKext->Link);
           DEBUG ((
             DEBUG_VERBOSE,
@@ -478,21 +492,14 @@ LookupBuiltinKextForIdentifier (
   IN     CONST CHAR8          *Identifier
   )
 {
-  BUILTIN_KEXT  *BuiltinKext;
-  LIST_ENTRY    *KextLink;
-
-  KextLink = GetFirstNode (&Context->BuiltInKexts);
-  while (!IsNull (&Context->BuiltInKexts, KextLink)) {
-    BuiltinKext = GET_BUILTIN_KEXT_FROM_LINK (KextLink);
- 
-    if (AsciiStrCmp (Identifier, BuiltinKext->Identifier) == 0) {
-      return BuiltinKext;
-    }
+  KEXT_IDENTIFIER_MAP_ENTRY  *Entry;
 
-    KextLink = GetNextNode (&Context->BuiltInKexts, KextLink);
+  Entry = InternalKextIdentifierMapLookup (&Context->BuiltInKextsMap, Identifier);
+  if (Entry == NULL) {
+    return NULL;
   }
 
-  return NULL;
+  return Entry->Kext;
 }
 
 STATIC
@@ -766,6 +773,8 @@ CachelessContextFree (
     }
     FreePool (BuiltinKext);
   }
+
+  InternalKextIdentifierMapFree (&Context->BuiltInKextsMap);
   
   ZeroMem (Context, sizeof (*Context));
 }
@@ -1294,6 +1303,120 @@ CachelessContextPerformInject (
   return EFI_NOT_FOUND;
 }
 
+STATIC
+VOID
+InternalApplyPatchedKextPatches (
+  IN     CACHELESS_CONTEXT  *Context,
+  IN     PATCHED_KEXT       *PatchedKext,
+  IN OUT PATCHER_CONTEXT    *Patcher
+  )
+{
+  EFI_STATUS             Status;
+  LIST_ENTRY             *KextLink;
+  KEXT_PATCH             *KextPatch;
+  PATCHER_GENERIC_PATCH  *Patches;
+  EFI_STATUS             *Results;
+  UINT32                 PatchCount;
+  UINT32                 BatchCount;
+  UINT32                 Index;
+
+  //
+  // Consecutive generic patches are applied in a single pass over the binary.
+  // Fallback to applying them one by one if we are out of memory.
+  //
+  PatchCount = 0;
+  KextLink   = GetFirstNode (&PatchedKext->Patches);
+  while (!IsNull (&PatchedKext->Patches, KextLink)) {
+    if (!GET_KEXT_PATCH_FROM_LINK (KextLink)->ApplyQuirk) {
+      ++PatchCount;
+    }
+
+    KextLink = GetNextNode (&PatchedKext->Patches, KextLink);
+  }
+
+  Patches = NULL;
+  Results = NULL;
+  if (PatchCount > 1) {
+    Patches = AllocatePool (PatchCount * sizeof (*Patches));
+    Results = AllocatePool (PatchCount * sizeof (*Results));
+    if (Patches == NULL || Results == NULL) {
+      if (Patches != NULL) {
+        FreePool (Patches);
+        Patches = NULL;
+      }
+      if (Results != NULL) {
+        FreePool (Results);
+        Results = NULL;
+      }
+    }
+  }
+
+  BatchCount = 0;
+  KextLink   = GetFirstNode (&PatchedKext->Patches);
+  while (TRUE) {
+    KextPatch = NULL;
+    if (!IsNull (&PatchedKext->Patches, KextLink)) {
+      KextPatch = GET_KEXT_PATCH_FROM_LINK (KextLink);
+    }
+
+    if (Patches != NULL && KextPatch != NULL && !KextPatch->ApplyQuirk) {
+      CopyMem (&Patches[BatchCount], &KextPatch->Patch, sizeof (*Patches));
+      ++BatchCount;
+      KextLink = GetNextNode (&PatchedKext->Patches, KextLink);
+      continue;
+    }
+
+    //
+    // Apply pending patches first to preserve the order with quirks.
+    //
+    if (BatchCount > 0) {
+      PatcherApplyGenericPatches (Patcher, Patches, BatchCount, Results);
+      for (Index = 0; Index < BatchCount; ++Index) {
+        DEBUG ((
+          EFI_ERROR (Results[Index]) ? DEBUG_WARN : DEBUG_INFO,
+          "OCAK: Cacheless patcher result for %a (%a) - %r\n",
+          PatchedKext->Identifier,
+          Patches[Index].Comment,
+          Results[Index]
+          ));
+      }
+
+      BatchCount = 0;
+    }
+
+    if (KextPatch == NULL) {
+      break;
+    }
+
+    if (KextPatch->ApplyQuirk) {
+      Status = KernelApplyQuirk (KextPatch->QuirkName, Patcher, Context->KernelVersion);
+      DEBUG ((
+        EFI_ERROR (Status) ? DEBUG_WARN : DEBUG_INFO,
+        "OCAK: Cacheless kernel quirk result for %a (%u) - %r\n",
+        PatchedKext->Identifier,
+        KextPatch->QuirkName,
+        Status
+        ));
+    } else {
+      Status = PatcherApplyGenericPatch (Patcher, &KextPatch->Patch);
+      DEBUG ((
+        EFI_ERROR (Status) ? DEBUG_WARN : DEBUG_INFO,
+        "OCAK: Cacheless patcher result for %a (%a) - %r\n",
+        PatchedKext->Identifier,
+        KextPatch->Patch.Comment,
+        Status
+        ));
+    }
+
+    KextLink = GetNextNode (&PatchedKext->Patches, KextLink);
+  }
+
+  if (Patches != NULL) {
+    FreePool (Patches);
+    FreePool (Results);
+  }
+}
+
 EFI_STATUS
 CachelessContextHookBuiltin (
   IN OUT CACHELESS_CONTEXT    *Context,
@@ -1305,7 +1428,6 @@ CachelessContextHookBuiltin (
   EFI_STATUS          Status;
   EFI_TIME            ModificationTime;
   BUILTIN_KEXT        *BuiltinKext;
-  KEXT_PATCH          *KextPatch;
   PATCHED_KEXT        *PatchedKext;
   DEPEND_KEXT         *DependKext;
   LIST_ENTRY          *KextLink;
@@ -1500,32 +1622,7 @@ CachelessContextHookBuiltin (
       //
       // Apply patches.
       //
-      KextLink = GetFirstNode (&PatchedKext->Patches);
-      while (!IsNull (&PatchedKext->Patches, KextLink)) {
-        KextPatch = GET_KEXT_PATCH_FROM_LINK (KextLink);
-
-        if (KextPatch->ApplyQuirk) {
-          Status = KernelApplyQuirk (KextPatch->QuirkName, &Patcher, Context->KernelVersion);
-          DEBUG ((
-            EFI_ERROR (Status) ? DEBUG_WARN : DEBUG_INFO,
-            "OCAK: Cacheless kernel quirk result for %a (%u) - %r\n",
-            PatchedKext->Identifier,
-            KextPatch->QuirkName,
-            Status
-            ));
-        } else {
-          Status = PatcherApplyGenericPatch (&Patcher, &KextPatch->Patch);
-          DEBUG ((
-            EFI_ERROR (Status) ? DEBUG_WARN : DEBUG_INFO,
-            "OCAK: Cacheless patcher result for %a (%a) - %r\n",
-            PatchedKext->Identifier,
-            KextPatch->Patch.Comment,
-            Status
-            ));
-        }
-
-        KextLink = GetNextNode (&PatchedKext->Patches, KextLink);
-      }
+      InternalApplyPatchedKextPatches (Context, PatchedKext, &Patcher);
 
       //
       // Block kext if requested.
@@ -1534,9 +1631,8 @@ CachelessContextHookBuiltin (
         Status = PatcherBlockKext (&Patcher);
         DEBUG ((
           EFI_ERROR (Status) ? DEBUG_WARN : DEBUG_INFO,
-          "OCAK: Cacheless blocker result for %a (%a) - %r\n",
+          "OCAK: Cacheless blocker result for %a - %r\n",
           PatchedKext->Identifier,
-          KextPatch->Patch.Comment,
           Status
           ));
       }
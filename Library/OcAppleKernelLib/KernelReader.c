@@ -31,6 +31,11 @@
 //
 #define KERNEL_HEADER_SIZE (EFI_PAGE_SIZE * 2)
 
+//
+// Compressed kernel is read and decompressed by chunks of this size.
+//
+#define KERNEL_COMP_CHUNK_SIZE BASE_1MB
+
 STATIC SHA384_CONTEXT mKernelDigestContext;
 STATIC UINT32         mKernelDigestPosition;
 STATIC BOOLEAN        mNeedKernelDigest;
@@ -201,11 +206,16 @@ ParseCompressedHeader (
 
   UINT32            KernelSize;
   MACH_COMP_HEADER  *CompHeader;
-  UINT8             *CompressedBuffer;
+  UINT8             *ChunkBuffer;
+  VOID              *Stream;
   UINT32            CompressionType;
   UINT32            CompressedSize;
   UINT32            DecompressedSize;
   UINT32            DecompressedHash;
+  UINT32            Position;
+  UINT32            ChunkSize;
+  UINT32            HashedSize;
+  UINT32            Hash;
 
   CompHeader       = (MACH_COMP_HEADER *)*Buffer;
   CompressionType  = CompHeader->Compression;
@@ -223,41 +233,99 @@ ParseCompressedHeader (
     return KernelSize;
   }
 
+  if (CompressionType != MACH_COMPRESSED_BINARY_INVERT_LZVN
+    && CompressionType != MACH_COMPRESSED_BINARY_INVERT_LZSS) {
+    DEBUG ((DEBUG_INFO, "OCAK: Comp kernel unsupported compression %08X at %08X\n", CompressionType, Offset));
+    return KernelSize;
+  }
+
   Status = ReplaceBuffer (DecompressedSize, Buffer, AllocatedSize, ReservedSize);
   if (EFI_ERROR (Status)) {
     DEBUG ((DEBUG_INFO, "OCAK: Decomp kernel (%u bytes) cannot be allocated at %08X\n", DecompressedSize, Offset));
     return KernelSize;
   }
 
-  CompressedBuffer = AllocatePool (CompressedSize);
-  if (CompressedBuffer == NULL) {
+  ChunkBuffer = AllocatePool (MIN (CompressedSize, KERNEL_COMP_CHUNK_SIZE));
+  if (ChunkBuffer == NULL) {
     DEBUG ((DEBUG_INFO, "OCAK: Comp kernel (%u bytes) cannot be allocated at %08X\n", CompressedSize, Offset));
     return KernelSize;
   }
 
-  Status = KernelGetFileData (File, Offset + sizeof (MACH_COMP_HEADER), CompressedSize, CompressedBuffer);
-  if (EFI_ERROR (Status)) {
-    DEBUG ((DEBUG_INFO, "OCAK: Comp kernel (%u bytes) cannot be read at %08X\n", CompressedSize, Offset));
-    FreePool (CompressedBuffer);
+  if (CompressionType == MACH_COMPRESSED_BINARY_INVERT_LZVN) {
+    Stream = DecompressLZVNStreamInit (*Buffer, DecompressedSize);
+  } else {
+    Stream = DecompressLZSSStreamInit (*Buffer, DecompressedSize);
+  }
+
+  if (Stream == NULL) {
+    DEBUG ((DEBUG_INFO, "OCAK: Comp kernel stream cannot be allocated at %08X\n", Offset));
+    FreePool (ChunkBuffer);
     return KernelSize;
   }
 
+  //
+  // Decompress the kernel as it is read, and hash the decompressed data
+  // while it is still in cache.
+  //
+  Hash       = 1;
+  HashedSize = 0;
+
+  for (Position = 0; Position < CompressedSize; Position += ChunkSize) {
+    ChunkSize = MIN (CompressedSize - Position, KERNEL_COMP_CHUNK_SIZE);
+
+    Status = KernelGetFileData (
+      File,
+      Offset + sizeof (MACH_COMP_HEADER) + Position,
+      ChunkSize,
+      ChunkBuffer
+      );
+    if (EFI_ERROR (Status)) {
+      DEBUG ((DEBUG_INFO, "OCAK: Comp kernel (%u bytes) cannot be read at %08X\n", CompressedSize, Offset));
+      KernelSize = 0;
+      break;
+    }
+
+    if (CompressionType == MACH_COMPRESSED_BINARY_INVERT_LZVN) {
+      KernelSize = (UINT32) DecompressLZVNStream (Stream, ChunkBuffer, ChunkSize);
+    } else {
+      KernelSize = DecompressLZSSStream (Stream, ChunkBuffer, ChunkSize);
+    }
+
+    //
+    // Every chunk of a valid kernel produces output until the buffer is full.
+    // Do not read the rest once the decoder reported corrupted data or stopped.
+    //
+    if (KernelSize <= HashedSize) {
+      DEBUG ((DEBUG_INFO, "OCAK: Comp kernel decoding failed at %u of %u bytes at %08X\n", Position, CompressedSize, Offset));
+      KernelSize = 0;
+      break;
+    }
+
+    Hash       = Adler32Update (Hash, *Buffer + HashedSize, KernelSize - HashedSize);
+    HashedSize = KernelSize;
+
+    if (KernelSize == DecompressedSize) {
+      break;
+    }
+  }
+
   if (CompressionType == MACH_COMPRESSED_BINARY_INVERT_LZVN) {
-    KernelSize = (UINT32)DecompressLZVN (*Buffer, DecompressedSize, CompressedBuffer, CompressedSize);
-  } else if (CompressionType == MACH_COMPRESSED_BINARY_INVERT_LZSS) {
-    KernelSize = (UINT32)DecompressLZSS (*Buffer, DecompressedSize, CompressedBuffer, CompressedSize);
+    DecompressLZVNStreamFree (Stream);
+  } else {
+    DecompressLZSSStreamFree (Stream);
   }
 
+  FreePool (ChunkBuffer);
+
   if (KernelSize != DecompressedSize) {
-    KernelSize = 0;
+    DEBUG ((DEBUG_INFO, "OCAK: Decomp kernel size mismatch %u != %u at %08X\n", KernelSize, DecompressedSize, Offset));
+    return 0;
   }
 
-  //
-  // TODO: implement adler32 hash verification.
-  //
-  (VOID) DecompressedHash;
-
-  FreePool (CompressedBuffer);
+  if (Hash != DecompressedHash) {
+    DEBUG ((DEBUG_INFO, "OCAK: Decomp kernel hash mismatch %08X != %08X at %08X\n", Hash, DecompressedHash, Offset));
+    return 0;
+  }
 
   return KernelSize;
 }
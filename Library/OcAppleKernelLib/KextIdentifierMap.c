@@ -0,0 +1,236 @@
+/** @file
+  Kext bundle identifier hash map.
+
+  Copyright (C) 2026, agent. All rights reserved.
+
+  All rights reserved.
+
+  This program and the accompanying materials
+  are licensed and made available under the terms and conditions of the BSD License
+  which accompanies this distribution.  The full text of the license may be found at
+  http://opensource.org/licenses/bsd-license.php
+
+  THE PROGRAM IS DISTRIBUTED UNDER THE BSD LICENSE ON AN "AS IS" BASIS,
+  WITHOUT WARRANTIES OR REPRESENTATIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED.
+**/
+
+#include <Base.h>
+
+#include <Library/BaseLib.h>
+#include <Library/BaseMemoryLib.h>
+#include <Library/DebugLib.h>
+#include <Library/MemoryAllocationLib.h>
+#include <Library/OcAppleKernelLib.h>
+#include <Library/OcGuardLib.h>
+
+#include "PrelinkedInternal.h"
+
+//
+// Minimal amount of map entries to allocate.
+//
+#define KEXT_IDENTIFIER_MAP_MIN_SIZE  64U
+
+STATIC
+KEXT_IDENTIFIER_MAP_ENTRY *
+InternalKextIdentifierMapFind (
+  IN CONST KEXT_IDENTIFIER_MAP_ENTRY  *Entries,
+  IN UINT32                           Mask,
+  IN CONST CHAR8                      *Identifier,
+  IN UINT32                           Hash
+  )
+{
+  UINT32  Slot;
+
+  Slot = Hash & Mask;
+
+  while (Entries[Slot].Identifier != NULL) {
+    if (Entries[Slot].Hash == Hash
+      && AsciiStrCmp (Entries[Slot].Identifier, Identifier) == 0) {
+      break;
+    }
+
+    Slot = (Slot + 1) & Mask;
+  }
+
+  //
+  // Returns either the matching or the first empty entry.
+  //
+  return (KEXT_IDENTIFIER_MAP_ENTRY *) &Entries[Slot];
+}
+
+STATIC
+EFI_STATUS
+InternalKextIdentifierMapResize (
+  IN OUT KEXT_IDENTIFIER_MAP  *Map,
+  IN     UINT32               MinCount
+  )
+{
+  KEXT_IDENTIFIER_MAP_ENTRY  *Entries;
+  KEXT_IDENTIFIER_MAP_ENTRY  *Entry;
+  UINT32                     Size;
+  UINT32                     Index;
+
+  //
+  // Keep load factor under 50% to ensure short probe sequences.
+  //
+  if (MinCount > BASE_64MB) {
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  Size = GetPowerOfTwo32 (MAX (MinCount, KEXT_IDENTIFIER_MAP_MIN_SIZE / 4)) * 4;
+
+  Entries = AllocateZeroPool (Size * sizeof (*Entries));
+  if (Entries == NULL) {
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  if (Map->Entries != NULL) {
+    for (Index = 0; Index <= Map->Mask; ++Index) {
+      if (Map->Entries[Index].Identifier != NULL) {
+        Entry = InternalKextIdentifierMapFind (
+          Entries,
+          Size - 1,
+          Map->Entries[Index].Identifier,
+          Map->Entries[Index].Hash
+          );
+        CopyMem (Entry, &Map->Entries[Index], sizeof (*Entry));
+      }
+    }
+
+    FreePool (Map->Entries);
+  }
+
+  Map->Entries = Entries;
+  Map->Mask    = Size - 1;
+
+  return EFI_SUCCESS;
+}
+
+EFI_STATUS
+InternalKextIdentifierMapInit (
+  OUT KEXT_IDENTIFIER_MAP  *Map,
+  IN  UINT32               Capacity
+  )
+{
+  ASSERT (Map != NULL);
+
+  ZeroMem (Map, sizeof (*Map));
+
+  return InternalKextIdentifierMapResize (Map, Capacity);
+}
+
+KEXT_IDENTIFIER_MAP_ENTRY *
+InternalKextIdentifierMapLookup (
+  IN CONST KEXT_IDENTIFIER_MAP  *Map,
+  IN CONST CHAR8                *Identifier
+  )
+{
+  KEXT_IDENTIFIER_MAP_ENTRY  *Entry;
+
+  ASSERT (Map != NULL);
+  ASSERT (Identifier != NULL);
+
+  if (Map->Entries == NULL) {
+    return NULL;
+  }
+
+  Entry = InternalKextIdentifierMapFind (
+    Map->Entries,
+    Map->Mask,
+    Identifier,
+    InternalGetSymbolNameHash (Identifier, (UINT32) AsciiStrLen (Identifier))
+    );
+  if (Entry->Identifier == NULL) {
+    return NULL;
+  }
+
+  return Entry;
+}
+
+EFI_STATUS
+InternalKextIdentifierMapInsert (
+  IN OUT KEXT_IDENTIFIER_MAP  *Map,
+  IN     CONST CHAR8          *Identifier,
+  IN     XML_NODE             *Plist  OPTIONAL,
+  IN     VOID                 *Kext   OPTIONAL
+  )
+{
+  EFI_STATUS                 Status;
+  KEXT_IDENTIFIER_MAP_ENTRY  *Entry;
+  UINT32                     Hash;
+
+  ASSERT (Map != NULL);
+  ASSERT (Identifier != NULL);
+
+  if (Map->Entries == NULL || (Map->Count + 1) * 2 > Map->Mask + 1) {
+    Status = InternalKextIdentifierMapResize (Map, Map->Count + 1);
+    if (EFI_ERROR (Status)) {
+      return Status;
+    }
+  }
+
+  Hash  = InternalGetSymbolNameHash (Identifier, (UINT32) AsciiStrLen (Identifier));
+  Entry = InternalKextIdentifierMapFind (Map->Entries, Map->Mask, Identifier, Hash);
+
+  if (Entry->Identifier == NULL) {
+    Entry->Identifier = Identifier;
+    Entry->Hash       = Hash;
+    ++Map->Count;
+  }
+
+  //
+  // The first inserted values win, like with in-order list lookup.
+  //
+  if (Entry->Plist == NULL) {
+    Entry->Plist = Plist;
+  }
+
+  if (Entry->Kext == NULL) {
+    Entry->Kext = Kext;
+  }
+
+  return EFI_SUCCESS;
+}
+
+VOID
+InternalKextIdentifierMapFree (
+  IN OUT KEXT_IDENTIFIER_MAP  *Map
+  )
+{
+  ASSERT (Map != NULL);
+
+  if (Map->Entries != NULL) {
+    FreePool (Map->Entries);
+  }
+
+  ZeroMem (Map, sizeof (*Map));
+}
+
+CONST CHAR8 *
+InternalKextPlistGetIdentifier (
+  IN XML_NODE  *KextPlist
+  )
+{
+  UINT32       FieldIndex;
+  UINT32       FieldCount;
+  CONST CHAR8  *KextPlistKey;
+  XML_NODE     *KextPlistValue;
+
+  FieldCount = PlistDictChildren (KextPlist);
+  for (FieldIndex = 0; FieldIndex < FieldCount; ++FieldIndex) {
+    KextPlistKey = PlistKeyValue (PlistDictChild (KextPlist, FieldIndex, &KextPlistValue));
+    if (KextPlistKey == NULL || KextPlistValue == NULL) {
+      continue;
+    }
+
+    if (AsciiStrCmp (KextPlistKey, INFO_BUNDLE_IDENTIFIER_KEY) == 0) {
+      if (PlistNodeCast (KextPlistValue, PLIST_NODE_TYPE_STRING) == NULL) {
+        return NULL;
+      }
+
+      return XmlNodeContent (KextPlistValue);
+    }
+  }
+
+  return NULL;
+}
@@ -19,6 +19,7 @@
 #include <Library/BaseLib.h>
 #include <Library/BaseMemoryLib.h>
 #include <Library/DebugLib.h>
+#include <Library/MemoryAllocationLib.h>
 #include <Library/OcAppleKernelLib.h>
 #include <Library/OcMachoLib.h>
 #include <Library/OcMiscLib.h>
@@ -279,6 +280,235 @@ PatcherGetSymbolAddress (
   return EFI_SUCCESS;
 }
 
+/**
+  Get segment range in file relative to the Mach-O header.
+**/
+STATIC
+BOOLEAN
+PatcherGetSegmentRange (
+  IN  PATCHER_CONTEXT           *Context,
+  IN  MACH_SEGMENT_COMMAND_ANY  *Segment,
+  OUT UINT32                    *Start,
+  OUT UINT32                    *End
+  )
+{
+  UINT64  FileOffset;
+  UINT64  FileSize;
+
+  if (Context->Is32Bit) {
+    FileOffset = Segment->Segment32.FileOffset;
+    FileSize   = Segment->Segment32.FileSize;
+  } else {
+    FileOffset = Segment->Segment64.FileOffset;
+    FileSize   = Segment->Segment64.FileSize;
+  }
+
+  if (FileSize == 0
+    || FileOffset < Context->MachContext.ContainerOffset
+    || FileOffset - Context->MachContext.ContainerOffset > MachoGetFileSize (&Context->MachContext)
+    || FileSize > MachoGetFileSize (&Context->MachContext)
+      - (FileOffset - Context->MachContext.ContainerOffset)) {
+    return FALSE;
+  }
+
+  *Start = (UINT32) (FileOffset - Context->MachContext.ContainerOffset);
+  *End   = (UINT32) (*Start + FileSize);
+  return TRUE;
+}
+
+/**
+  Resolve generic patch range in file relative to the Mach-O header.
+  Start is the symbol base when it is used, End is the end of the segment
+  containing the symbol when lookup is used, or the end of file otherwise.
+  Limit is not applied.
+**/
+STATIC
+EFI_STATUS
+PatcherGetGenericPatchRange (
+  IN OUT PATCHER_CONTEXT        *Context,
+  IN     PATCHER_GENERIC_PATCH  *Patch,
+  OUT    UINT32                 *Start,
+  OUT    UINT32                 *End
+  )
+{
+  EFI_STATUS                Status;
+  UINT8                     *Base;
+  UINT32                    BaseOffset;
+  UINT32                    SegmentStart;
+  UINT32                    SegmentEnd;
+  MACH_SEGMENT_COMMAND_ANY  *Segment;
+
+  *Start = 0;
+  *End   = MachoGetFileSize (&Context->MachContext);
+
+  if (Patch->Base == NULL) {
+    return EFI_SUCCESS;
+  }
+
+  Status = PatcherGetSymbolAddress (Context, Patch->Base, &Base);
+  if (EFI_ERROR (Status)) {
+    DEBUG ((
+      DEBUG_INFO,
+      "OCAK: %a-bit %a base lookup failure %r\n",
+      Context->Is32Bit ? "32" : "64",
+      Patch->Comment != NULL ? Patch->Comment : "Patch",
+      Status
+      ));
+    return Status;
+  }
+
+  BaseOffset = (UINT32) (Base - (UINT8 *) MachoGetMachHeader (&Context->MachContext));
+
+  if (BaseOffset > *End) {
+    return EFI_NOT_FOUND;
+  } else if (Patch->Find != NULL) {
+    //
+    // Do not look past the segment the symbol belongs to.
+    // Symbols in unknown segments keep looking till the end of file.
+    //
+    for (
+      Segment = MachoGetNextSegment (&Context->MachContext, NULL);
+      Segment != NULL;
+      Segment = MachoGetNextSegment (&Context->MachContext, Segment)
+      ) {
+      if (PatcherGetSegmentRange (Context, Segment, &SegmentStart, &SegmentEnd)
+        && BaseOffset >= SegmentStart && BaseOffset < SegmentEnd) {
+        *End = SegmentEnd;
+        break;
+      }
+    }
+  }
+
+  *Start = BaseOffset;
+  return EFI_SUCCESS;
+}
+
+//
+// Maximum amount of candidate matches tracked per batched patch.
+// Patches with more matches are searched separately.
+//
+#define PATCHER_BATCH_MAX_CANDIDATES  512U
+
+//
+// Maximum amount of replaced ranges rechecked for new matches.
+// Following patches are searched separately after it is exceeded.
+//
+#define PATCHER_BATCH_MAX_DIRTY  256U
+
+typedef struct {
+  UINT32      Start;
+  UINT32      End;
+} PATCHER_BATCH_RANGE;
+
+typedef struct {
+  EFI_STATUS  Status;
+  UINT32      Start;
+  UINT32      End;
+  UINT32      Anchor;
+  UINT32      Next;
+  UINT32      MatchCount;
+  UINT32      *Matches;
+  BOOLEAN     Scan;
+} PATCHER_BATCH_PATCH;
+
+STATIC
+EFI_STATUS
+PatcherReportGenericPatch (
+  IN PATCHER_CONTEXT        *Context,
+  IN PATCHER_GENERIC_PATCH  *Patch,
+  IN UINT32                 ReplaceCount
+  )
+{
+  DEBUG ((
+    DEBUG_INFO,
+    "OCAK: %a-bit %a replace count - %u\n",
+    Context->Is32Bit ? "32" : "64",
+    Patch->Comment != NULL ? Patch->Comment : "Patch",
+    ReplaceCount
+    ));
+
+  if (ReplaceCount > 0 && Patch->Count > 0 && ReplaceCount != Patch->Count) {
+    DEBUG ((
+      DEBUG_INFO,
+      "OCAK: %a-bit %a performed only %u replacements out of %u\n",
+      Context->Is32Bit ? "32" : "64",
+      Patch->Comment != NULL ? Patch->Comment : "Patch",
+      ReplaceCount,
+      Patch->Count
+      ));
+  }
+
+  if (ReplaceCount > 0) {
+    return EFI_SUCCESS;
+  }
+
+  return EFI_NOT_FOUND;
+}
+
+STATIC
+BOOLEAN
+PatcherBatchMatch (
+  IN CONST UINT8   *Pattern,
+  IN CONST UINT8   *PatternMask OPTIONAL,
+  IN UINT32        PatternSize,
+  IN CONST UINT8   *Data
+  )
+{
+  UINT32  Index;
+
+  if (PatternMask == NULL) {
+    return CompareMem (Data, Pattern, PatternSize) == 0;
+  }
+
+  for (Index = 0; Index < PatternSize; ++Index) {
+    if ((Data[Index] & PatternMask[Index]) != Pattern[Index]) {
+      return FALSE;
+    }
+  }
+
+  return TRUE;
+}
+
+STATIC
+VOID
+PatcherBatchReplace (
+  IN     PATCHER_GENERIC_PATCH  *Patch,
+  IN OUT UINT8                  *Data
+  )
+{
+  UINT32  Index;
+
+  if (Patch->ReplaceMask == NULL) {
+    CopyMem (Data, Patch->Replace, Patch->Size);
+  } else {
+    for (Index = 0; Index < Patch->Size; ++Index) {
+      Data[Index] = (Data[Index] & ~Patch->ReplaceMask[Index]) | (Patch->Replace[Index] & Patch->ReplaceMask[Index]);
+    }
+  }
+}
+
+STATIC
+VOID
+PatcherBatchAddDirty (
+  IN OUT PATCHER_BATCH_RANGE  *Dirty,
+  IN OUT UINT32               *DirtyCount,
+  IN     UINT32               Offset,
+  IN     UINT32               Size
+  )
+{
+  //
+  // Count overflows too, so that the caller knows the list is incomplete.
+  //
+  if (*DirtyCount < PATCHER_BATCH_MAX_DIRTY) {
+    Dirty[*DirtyCount].Start = Offset;
+    Dirty[*DirtyCount].End   = Offset + Size;
+  }
+
+  if (*DirtyCount <= PATCHER_BATCH_MAX_DIRTY) {
+    ++*DirtyCount;
+  }
+}
+
 EFI_STATUS
 PatcherApplyGenericPatch (
   IN OUT PATCHER_CONTEXT        *Context,
@@ -288,26 +518,18 @@ PatcherApplyGenericPatch (
   EFI_STATUS     Status;
   UINT8          *Base;
   UINT32         Size;
+  UINT32         Start;
+  UINT32         End;
   UINT32         ReplaceCount;
 
-  Base = (UINT8 *) MachoGetMachHeader (&Context->MachContext);
-  Size = MachoGetFileSize (&Context->MachContext);
-  if (Patch->Base != NULL) {
-    Status = PatcherGetSymbolAddress (Context, Patch->Base, &Base);
-    if (EFI_ERROR (Status)) {
-      DEBUG ((
-        DEBUG_INFO,
-        "OCAK: %a-bit %a base lookup failure %r\n",
-        Context->Is32Bit ? "32" : "64",
-        Patch->Comment != NULL ? Patch->Comment : "Patch",
-        Status
-        ));
-      return Status;
-    }
-
-    Size -= (UINT32)(Base - (UINT8 *) MachoGetMachHeader (&Context->MachContext));
+  Status = PatcherGetGenericPatchRange (Context, Patch, &Start, &End);
+  if (EFI_ERROR (Status)) {
+    return Status;
   }
 
+  Base = (UINT8 *) MachoGetMachHeader (&Context->MachContext) + Start;
+  Size = End - Start;
+
   if (Patch->Find == NULL) {
     if (Size < Patch->Size) {
       DEBUG ((
@@ -338,30 +560,399 @@ PatcherApplyGenericPatch (
     Patch->Skip
     );
 
-  DEBUG ((
-    DEBUG_INFO,
-    "OCAK: %a-bit %a replace count - %u\n",
-    Context->Is32Bit ? "32" : "64",
-    Patch->Comment != NULL ? Patch->Comment : "Patch",
-    ReplaceCount
-    ));
+  return PatcherReportGenericPatch (Context, Patch, ReplaceCount);
+}
 
-  if (ReplaceCount > 0 && Patch->Count > 0 && ReplaceCount != Patch->Count) {
-    DEBUG ((
-      DEBUG_INFO,
-      "OCAK: %a-bit %a performed only %u replacements out of %u\n",
-      Context->Is32Bit ? "32" : "64",
-      Patch->Comment != NULL ? Patch->Comment : "Patch",
-      ReplaceCount,
-      Patch->Count
-      ));
+/**
+  Find next match of a batched patch at or after Offset.
+  Offsets are relative to the Mach-O header.
+**/
+STATIC
+BOOLEAN
+PatcherBatchFindNext (
+  IN     CONST UINT8            *Data,
+  IN     PATCHER_GENERIC_PATCH  *Patch,
+  IN     PATCHER_BATCH_PATCH    *Batch,
+  IN OUT UINT32                 *CandidateIndex,
+  IN OUT UINT32                 *Offset
+  )
+{
+  INT32   Result;
+  UINT32  Candidate;
+
+  if (Batch->Scan) {
+    if (*Offset >= Batch->End) {
+      return FALSE;
+    }
+
+    Result = FindPattern (
+      Patch->Find,
+      Patch->Mask,
+      Patch->Size,
+      &Data[Batch->Start],
+      Batch->End - Batch->Start,
+      (INT32) (*Offset - Batch->Start)
+      );
+    if (Result < 0) {
+      return FALSE;
+    }
+
+    *Offset = Batch->Start + (UINT32) Result;
+    return TRUE;
   }
 
-  if (ReplaceCount > 0) {
+  //
+  // Candidates are sorted, but may no longer match due to previous patches.
+  //
+  while (*CandidateIndex < Batch->MatchCount) {
+    Candidate = Batch->Matches[(*CandidateIndex)++];
+    if (Candidate >= *Offset
+      && PatcherBatchMatch (Patch->Find, Patch->Mask, Patch->Size, &Data[Candidate])) {
+      *Offset = Candidate;
+      return TRUE;
+    }
+  }
+
+  return FALSE;
+}
+
+/**
+  Add matches created by replacements of previous patches to candidate list.
+**/
+STATIC
+VOID
+PatcherBatchAddDirtyMatches (
+  IN     CONST UINT8            *Data,
+  IN     PATCHER_GENERIC_PATCH  *Patch,
+  IN OUT PATCHER_BATCH_PATCH    *Batch,
+  IN     PATCHER_BATCH_RANGE    *Dirty,
+  IN     UINT32                 DirtyCount
+  )
+{
+  UINT32  Index;
+  UINT32  Start;
+  UINT32  End;
+  UINT32  Offset;
+  UINT32  Insert;
+
+  for (Index = 0; Index < DirtyCount && !Batch->Scan; ++Index) {
+    //
+    // Check every pattern position overlapping the modified range.
+    //
+    Start = Dirty[Index].Start >= Patch->Size ? Dirty[Index].Start - Patch->Size + 1 : 0;
+    Start = MAX (Start, Batch->Start);
+    End   = MIN (Dirty[Index].End, Batch->End - Patch->Size + 1);
+
+    for (Offset = Start; Offset < End; ++Offset) {
+      if (!PatcherBatchMatch (Patch->Find, Patch->Mask, Patch->Size, &Data[Offset])) {
+        continue;
+      }
+
+      //
+      // Keep the list sorted and unique, insertions are rare.
+      //
+      Insert = Batch->MatchCount;
+      while (Insert > 0 && Batch->Matches[Insert - 1] > Offset) {
+        --Insert;
+      }
+
+      if (Insert > 0 && Batch->Matches[Insert - 1] == Offset) {
+        continue;
+      }
+
+      if (Batch->MatchCount == PATCHER_BATCH_MAX_CANDIDATES) {
+        Batch->Scan = TRUE;
+        break;
+      }
+
+      CopyMem (
+        &Batch->Matches[Insert + 1],
+        &Batch->Matches[Insert],
+        (Batch->MatchCount - Insert) * sizeof (Batch->Matches[0])
+        );
+      Batch->Matches[Insert] = Offset;
+      ++Batch->MatchCount;
+    }
+  }
+}
+
+EFI_STATUS
+PatcherApplyGenericPatches (
+  IN OUT PATCHER_CONTEXT        *Context,
+  IN     PATCHER_GENERIC_PATCH  *Patches,
+  IN     UINT32                 PatchCount,
+  OUT    EFI_STATUS             *Results  OPTIONAL
+  )
+{
+  EFI_STATUS             Status;
+  EFI_STATUS             PatchStatus;
+  UINT8                  *Data;
+  UINT32                 DataSize;
+  UINT32                 Index;
+  UINT32                 Offset;
+  UINT32                 ScanStart;
+  UINT32                 ScanEnd;
+  UINT32                 Anchor;
+  UINT32                 Position;
+  UINT32                 CandidateIndex;
+  UINT32                 Skip;
+  UINT32                 Count;
+  UINT32                 ReplaceCount;
+  UINT32                 DirtyCount;
+  UINT32                 ByteIndex;
+  UINT32                 Heads[256];
+  UINT8                  *PairFilter;
+  UINT32                 *Matches;
+  PATCHER_BATCH_PATCH    *Batches;
+  PATCHER_BATCH_PATCH    *Batch;
+  PATCHER_BATCH_RANGE    *Dirty;
+  PATCHER_GENERIC_PATCH  *Patch;
+
+  ASSERT (Context != NULL);
+  ASSERT (Patches != NULL || PatchCount == 0);
+
+  if (PatchCount == 0) {
     return EFI_SUCCESS;
   }
 
-  return EFI_NOT_FOUND;
+  Data     = (UINT8 *) MachoGetMachHeader (&Context->MachContext);
+  DataSize = MachoGetFileSize (&Context->MachContext);
+
+  Batches    = AllocateZeroPool (PatchCount * sizeof (*Batches));
+  Matches    = AllocatePool (PatchCount * PATCHER_BATCH_MAX_CANDIDATES * sizeof (*Matches));
+  Dirty      = AllocatePool (PATCHER_BATCH_MAX_DIRTY * sizeof (*Dirty));
+  PairFilter = AllocateZeroPool (BASE_64KB / OC_CHAR_BIT);
+  if (Batches == NULL || Matches == NULL || Dirty == NULL || PairFilter == NULL) {
+    if (Batches != NULL) {
+      FreePool (Batches);
+    }
+    if (Matches != NULL) {
+      FreePool (Matches);
+    }
+    if (Dirty != NULL) {
+      FreePool (Dirty);
+    }
+    if (PairFilter != NULL) {
+      FreePool (PairFilter);
+    }
+
+    //
+    // Fallback to applying the patches one by one.
+    //
+    Status = EFI_SUCCESS;
+    for (Index = 0; Index < PatchCount; ++Index) {
+      PatchStatus = PatcherApplyGenericPatch (Context, &Patches[Index]);
+      if (Results != NULL) {
+        Results[Index] = PatchStatus;
+      }
+      if (EFI_ERROR (PatchStatus)) {
+        Status = PatchStatus;
+      }
+    }
+    return Status;
+  }
+
+  ZeroMem (Heads, sizeof (Heads));
+  ScanStart = DataSize;
+  ScanEnd   = 0;
+
+  //
+  // Compile the patches: resolve search ranges and index every pattern
+  // by its anchor, the first pair of fully unmasked bytes if any.
+  //
+  for (Index = 0; Index < PatchCount; ++Index) {
+    Patch         = &Patches[Index];
+    Batch         = &Batches[Index];
+    Batch->Status = EFI_SUCCESS;
+    Batch->Matches = &Matches[Index * PATCHER_BATCH_MAX_CANDIDATES];
+
+    Batch->Status = PatcherGetGenericPatchRange (Context, Patch, &Batch->Start, &Batch->End);
+    if (EFI_ERROR (Batch->Status)) {
+      continue;
+    }
+
+    if (Patch->Find == NULL) {
+      continue;
+    }
+
+    if (Patch->Limit > 0 && Patch->Limit < Batch->End - Batch->Start) {
+      Batch->End = Batch->Start + Patch->Limit;
+    }
+
+    if (Patch->Size == 0 || Batch->End - Batch->Start < Patch->Size) {
+      //
+      // Nothing can be found, just report it as is.
+      //
+      Batch->MatchCount = 0;
+      continue;
+    }
+
+    Anchor = Patch->Size;
+    for (Position = 0; Position < Patch->Size; ++Position) {
+      if (Patch->Mask == NULL || Patch->Mask[Position] == 0xFF) {
+        if (Anchor == Patch->Size) {
+          Anchor = Position;
+        }
+
+        if (Position + 1 < Patch->Size
+          && (Patch->Mask == NULL || Patch->Mask[Position + 1] == 0xFF)) {
+          Anchor = Position;
+          break;
+        }
+      }
+    }
+
+    if (Anchor == Patch->Size) {
+      //
+      // Patterns without exact bytes are rare, search them separately.
+      //
+      Batch->Scan = TRUE;
+      continue;
+    }
+
+    Batch->Anchor  = Anchor;
+    Batch->Next    = Heads[Patch->Find[Anchor]];
+    Heads[Patch->Find[Anchor]] = Index + 1;
+
+    if (Anchor + 1 < Patch->Size
+      && (Patch->Mask == NULL || Patch->Mask[Anchor + 1] == 0xFF)) {
+      Position = ((UINT32) Patch->Find[Anchor] << 8U) | Patch->Find[Anchor + 1];
+      PairFilter[Position / OC_CHAR_BIT] |= (UINT8) (1U << (Position % OC_CHAR_BIT));
+    } else {
+      for (ByteIndex = 0; ByteIndex < 256; ++ByteIndex) {
+        Position = ((UINT32) Patch->Find[Anchor] << 8U) | ByteIndex;
+        PairFilter[Position / OC_CHAR_BIT] |= (UINT8) (1U << (Position % OC_CHAR_BIT));
+      }
+    }
+
+    ScanStart = MIN (ScanStart, Batch->Start + Anchor);
+    ScanEnd   = MAX (ScanEnd, Batch->End);
+  }
+
+  //
+  // Find candidates for all indexed patterns in a single pass.
+  //
+  for (Offset = ScanStart; Offset < ScanEnd; ++Offset) {
+    if (Heads[Data[Offset]] == 0) {
+      continue;
+    }
+
+    if (Offset + 1 < ScanEnd) {
+      Position = ((UINT32) Data[Offset] << 8U) | Data[Offset + 1];
+      if ((PairFilter[Position / OC_CHAR_BIT] & (1U << (Position % OC_CHAR_BIT))) == 0) {
+        continue;
+      }
+    }
+
+    for (Index = Heads[Data[Offset]]; Index != 0; Index = Batch->Next) {
+      Patch = &Patches[Index - 1];
+      Batch = &Batches[Index - 1];
+
+      if (Batch->Scan
+        || Offset < Batch->Start + Batch->Anchor
+        || Offset - Batch->Anchor + Patch->Size > Batch->End) {
+        continue;
+      }
+
+      Position = Offset - Batch->Anchor;
+      if (!PatcherBatchMatch (Patch->Find, Patch->Mask, Patch->Size, &Data[Position])) {
+        continue;
+      }
+
+      if (Batch->MatchCount == PATCHER_BATCH_MAX_CANDIDATES) {
+        //
+        // Too many matches to track, search this pattern separately.
+        //
+        Batch->Scan = TRUE;
+        continue;
+      }
+
+      Batch->Matches[Batch->MatchCount++] = Position;
+    }
+  }
+
+  //
+  // Apply the patches in order like PatcherApplyGenericPatch would do.
+  // Replacements may create new matches for the following patches,
+  // so modified ranges are searched again.
+  //
+  Status     = EFI_SUCCESS;
+  DirtyCount = 0;
+
+  for (Index = 0; Index < PatchCount; ++Index) {
+    Patch = &Patches[Index];
+    Batch = &Batches[Index];
+
+    if (EFI_ERROR (Batch->Status)) {
+      PatchStatus = Batch->Status;
+    } else if (Patch->Find == NULL) {
+      if (Batch->End - Batch->Start < Patch->Size) {
+        DEBUG ((
+          DEBUG_INFO,
+          "OCAK: %a-bit %a is borked, not found\n",
+          Context->Is32Bit ? "32" : "64",
+          Patch->Comment != NULL ? Patch->Comment : "Patch"
+          ));
+        PatchStatus = EFI_NOT_FOUND;
+      } else {
+        CopyMem (&Data[Batch->Start], Patch->Replace, Patch->Size);
+        PatchStatus = EFI_SUCCESS;
+        PatcherBatchAddDirty (Dirty, &DirtyCount, Batch->Start, Patch->Size);
+      }
+    } else {
+      if (Patch->Size > 0 && Batch->End - Batch->Start >= Patch->Size) {
+        if (DirtyCount > PATCHER_BATCH_MAX_DIRTY) {
+          Batch->Scan = TRUE;
+        } else {
+          PatcherBatchAddDirtyMatches (Data, Patch, Batch, Dirty, DirtyCount);
+        }
+      }
+
+      ReplaceCount   = 0;
+      CandidateIndex = 0;
+      Offset         = Batch->Start;
+      Skip           = Patch->Skip;
+      Count          = Patch->Count;
+
+      while (Patch->Size > 0
+        && PatcherBatchFindNext (Data, Patch, Batch, &CandidateIndex, &Offset)) {
+        if (Skip > 0) {
+          --Skip;
+          Offset += Patch->Size;
+          continue;
+        }
+
+        PatcherBatchReplace (Patch, &Data[Offset]);
+        PatcherBatchAddDirty (Dirty, &DirtyCount, Offset, Patch->Size);
+        ++ReplaceCount;
+        Offset += Patch->Size;
+
+        if (Count > 0) {
+          --Count;
+          if (Count == 0) {
+            break;
+          }
+        }
+      }
+
+      PatchStatus = PatcherReportGenericPatch (Context, Patch, ReplaceCount);
+    }
+
+    if (Results != NULL) {
+      Results[Index] = PatchStatus;
+    }
+
+    if (EFI_ERROR (PatchStatus)) {
+      Status = PatchStatus;
+    }
+  }
+
+  FreePool (Batches);
+  FreePool (Matches);
+  FreePool (Dirty);
+  FreePool (PairFilter);
+
+  return Status;
 }
 
 EFI_STATUS
@@ -279,6 +279,8 @@ InternalKxldStateBuildLinkedSymbolTable (
   Kext->NumberOfCxxSymbols = NumCxxSymbols;
   Kext->LinkedSymbolTable  = SymbolTable;
 
+  InternalBuildLinkedSymbolIndex (Kext, Context);
+
   return EFI_SUCCESS;
 }
 
@@ -20,6 +20,7 @@ WITHOUT WARRANTIES OR REPRESENTATIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED.
 #include <Library/BaseLib.h>
 #include <Library/BaseMemoryLib.h>
 #include <Library/DebugLib.h>
+#include <Library/MemoryAllocationLib.h>
 #include <Library/OcAppleKernelLib.h>
 #include <Library/OcGuardLib.h>
 #include <Library/OcMachoLib.h>
@@ -35,12 +36,140 @@ WITHOUT WARRANTIES OR REPRESENTATIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED.
 // Symbols
 //
 
+UINT32
+InternalGetSymbolNameHash (
+  IN CONST CHAR8  *Name,
+  IN UINT32       Length
+  )
+{
+  UINT32  Hash;
+  UINT32  Index;
+
+  //
+  // FNV-1a, which is fast and distributes mangled C++ names well enough.
+  //
+  Hash = 0x811C9DC5U;
+  for (Index = 0; Index < Length; ++Index) {
+    Hash ^= (UINT8) Name[Index];
+    Hash *= 0x01000193U;
+  }
+
+  return Hash;
+}
+
+VOID
+InternalBuildLinkedSymbolIndex (
+  IN OUT PRELINKED_KEXT     *Kext,
+  IN     PRELINKED_CONTEXT  *Context
+  )
+{
+  UINT32                      *SymbolIndex;
+  UINT32                      IndexMask;
+  UINT32                      IndexSize;
+  UINT32                      Index;
+  UINT32                      Slot;
+  UINT32                      Entry;
+  CONST PRELINKED_KEXT_SYMBOL *Symbol;
+  CONST PRELINKED_KEXT_SYMBOL *IndexedSymbol;
+
+  ASSERT (Kext->LinkedSymbolTable != NULL);
+
+  if (Kext->LinkedSymbolIndex != NULL
+    || Kext->NumberOfSymbols == 0
+    || Context->LinearSymbolLookup) {
+    return;
+  }
+
+  if (Kext->NumberOfSymbols > BASE_1GB / sizeof (*SymbolIndex)) {
+    return;
+  }
+
+  //
+  // GetPowerOfTwo32 rounds down, so this gives more than 2 and at most 4
+  // slots per symbol, i.e. a load factor between 25% and 50%, which keeps
+  // probe sequences short.
+  //
+  IndexMask = GetPowerOfTwo32 (Kext->NumberOfSymbols) * 4 - 1;
+  if (OcOverflowMulU32 (IndexMask + 1, sizeof (*SymbolIndex), &IndexSize)) {
+    return;
+  }
+
+  SymbolIndex = AllocateZeroPool (IndexSize);
+  if (SymbolIndex == NULL) {
+    DEBUG ((DEBUG_INFO, "OCAK: No memory for %a symbol index, using linear lookup\n", Kext->Identifier));
+    return;
+  }
+
+  for (Index = 0; Index < Kext->NumberOfSymbols; ++Index) {
+    Symbol = &Kext->LinkedSymbolTable[Index];
+    Slot   = InternalGetSymbolNameHash (Symbol->Name, Symbol->Length) & IndexMask;
+
+    while ((Entry = SymbolIndex[Slot]) != 0) {
+      //
+      // Preserve the first occurrence to match linear lookup results.
+      //
+      IndexedSymbol = &Kext->LinkedSymbolTable[Entry - 1];
+      if (IndexedSymbol->Length == Symbol->Length
+        && CompareMem (IndexedSymbol->Name, Symbol->Name, Symbol->Length) == 0) {
+        break;
+      }
+
+      Slot = (Slot + 1) & IndexMask;
+    }
+
+    if (Entry == 0) {
+      SymbolIndex[Slot] = Index + 1;
+    }
+  }
+
+  Kext->LinkedSymbolIndex     = SymbolIndex;
+  Kext->LinkedSymbolIndexMask = IndexMask;
+}
+
+STATIC
+CONST PRELINKED_KEXT_SYMBOL *
+InternalOcGetSymbolIndexedName (
+  IN PRELINKED_KEXT                   *Kext,
+  IN CONST CHAR8                      *LookupValue,
+  IN UINT32                           LookupValueLength,
+  IN UINT32                           LookupValueHash,
+  IN OC_GET_SYMBOL_LEVEL              SymbolLevel
+  )
+{
+  CONST PRELINKED_KEXT_SYMBOL *Symbol;
+  UINT32                      Slot;
+  UINT32                      Entry;
+
+  Slot = LookupValueHash & Kext->LinkedSymbolIndexMask;
+
+  while ((Entry = Kext->LinkedSymbolIndex[Slot]) != 0) {
+    Symbol = &Kext->LinkedSymbolTable[Entry - 1];
+    if (Symbol->Length == LookupValueLength
+      && CompareMem (Symbol->Name, LookupValue, LookupValueLength) == 0) {
+      //
+      // C++ symbols are put at the end of LinkedSymbolTable.
+      //
+      if (SymbolLevel == OcGetSymbolOnlyCxx
+        && Entry - 1 < Kext->NumberOfSymbols - Kext->NumberOfCxxSymbols) {
+        return NULL;
+      }
+
+      return Symbol;
+    }
+
+    Slot = (Slot + 1) & Kext->LinkedSymbolIndexMask;
+  }
+
+  return NULL;
+}
+
 STATIC
 CONST PRELINKED_KEXT_SYMBOL *
 InternalOcGetSymbolWorkerName (
   IN PRELINKED_KEXT                   *Kext,
   IN CONST CHAR8                      *LookupValue,
   IN UINT32                           LookupValueLength,
+  IN UINT32                           LookupValueHash,
   IN OC_GET_SYMBOL_LEVEL              SymbolLevel
   )
 {
@@ -55,7 +184,18 @@ InternalOcGetSymbolWorkerName (
   //
   Kext->Processed = TRUE;
 
-  if (Kext->LinkedSymbolTable != NULL) {
+  if (Kext->LinkedSymbolIndex != NULL) {
+    Symbols = InternalOcGetSymbolIndexedName (
+      Kext,
+      LookupValue,
+      LookupValueLength,
+      LookupValueHash,
+      SymbolLevel
+      );
+    if (Symbols != NULL) {
+      return Symbols;
+    }
+  } else if (Kext->LinkedSymbolTable != NULL) {
     NumSymbols = Kext->NumberOfSymbols;
     Symbols    = Kext->LinkedSymbolTable;
 
@@ -103,6 +243,7 @@ InternalOcGetSymbolWorkerName (
                  Dependency,
                  LookupValue,
                  LookupValueLength,
+                 LookupValueHash,
                  OcGetSymbolOnlyCxx
                  );
       if (Symbols != NULL) {
@@ -114,9 +255,165 @@ InternalOcGetSymbolWorkerName (
   return NULL;
 }
 
+/**
+  Compare LinkedSymbolTable entries by value, then by position, so that
+  the sorted value index preserves linear lookup precedence.
+**/
+STATIC
+BOOLEAN
+InternalSymbolValueLess (
+  IN CONST PRELINKED_KEXT_SYMBOL  *SymbolTable,
+  IN UINT32                       First,
+  IN UINT32                       Second
+  )
+{
+  if (SymbolTable[First].Value != SymbolTable[Second].Value) {
+    return SymbolTable[First].Value < SymbolTable[Second].Value;
+  }
+
+  return First < Second;
+}
+
+STATIC
+VOID
+InternalSiftSymbolValueIndex (
+  IN     CONST PRELINKED_KEXT_SYMBOL  *SymbolTable,
+  IN OUT UINT32                       *ValueIndex,
+  IN     UINT32                       Root,
+  IN     UINT32                       Count
+  )
+{
+  UINT32  Child;
+  UINT32  Temp;
+
+  while ((Child = Root * 2 + 1) < Count) {
+    if (Child + 1 < Count
+      && InternalSymbolValueLess (SymbolTable, ValueIndex[Child], ValueIndex[Child + 1])) {
+      ++Child;
+    }
+
+    if (!InternalSymbolValueLess (SymbolTable, ValueIndex[Root], ValueIndex[Child])) {
+      return;
+    }
+
+    Temp              = ValueIndex[Root];
+    ValueIndex[Root]  = ValueIndex[Child];
+    ValueIndex[Child] = Temp;
+    Root              = Child;
+  }
+}
+
+/**
+  Lazily build LinkedSymbolTable index sorted by symbol value.
+  Heap sort is used as it needs no extra memory and has no bad cases.
+
+  @param[in,out] Kext        Kext dependency with LinkedSymbolTable.
+  @param[in]     Context     Prelinking context.
+**/
+STATIC
+VOID
+InternalBuildLinkedSymbolValueIndex (
+  IN OUT PRELINKED_KEXT     *Kext,
+  IN     PRELINKED_CONTEXT  *Context
+  )
+{
+  UINT32  *ValueIndex;
+  UINT32  IndexSize;
+  UINT32  Index;
+  UINT32  Temp;
+
+  ASSERT (Kext->LinkedSymbolTable != NULL);
+
+  if (Kext->LinkedSymbolValueIndex != NULL
+    || Kext->NumberOfSymbols == 0
+    || Context->LinearSymbolLookup) {
+    return;
+  }
+
+  if (OcOverflowMulU32 (Kext->NumberOfSymbols, sizeof (*ValueIndex), &IndexSize)) {
+    return;
+  }
+
+  ValueIndex = AllocatePool (IndexSize);
+  if (ValueIndex == NULL) {
+    DEBUG ((DEBUG_INFO, "OCAK: No memory for %a value index, using linear lookup\n", Kext->Identifier));
+    return;
+  }
+
+  for (Index = 0; Index < Kext->NumberOfSymbols; ++Index) {
+    ValueIndex[Index] = Index;
+  }
+
+  for (Index = Kext->NumberOfSymbols / 2; Index > 0; --Index) {
+    InternalSiftSymbolValueIndex (Kext->LinkedSymbolTable, ValueIndex, Index - 1, Kext->NumberOfSymbols);
+  }
+
+  for (Index = Kext->NumberOfSymbols - 1; Index > 0; --Index) {
+    Temp              = ValueIndex[0];
+    ValueIndex[0]     = ValueIndex[Index];
+    ValueIndex[Index] = Temp;
+    InternalSiftSymbolValueIndex (Kext->LinkedSymbolTable, ValueIndex, 0, Index);
+  }
+
+  Kext->LinkedSymbolValueIndex = ValueIndex;
+}
+
+STATIC
+CONST PRELINKED_KEXT_SYMBOL *
+InternalOcGetSymbolIndexedValue (
+  IN PRELINKED_KEXT                   *Kext,
+  IN UINT64                           LookupValue,
+  IN OC_GET_SYMBOL_LEVEL              SymbolLevel
+  )
+{
+  CONST PRELINKED_KEXT_SYMBOL *Symbols;
+  CONST UINT32                *ValueIndex;
+  UINT32                      Low;
+  UINT32                      High;
+  UINT32                      Middle;
+  UINT32                      FirstCxxSymbol;
+
+  Symbols    = Kext->LinkedSymbolTable;
+  ValueIndex = Kext->LinkedSymbolValueIndex;
+
+  //
+  // Find the first entry not less than LookupValue.
+  //
+  Low  = 0;
+  High = Kext->NumberOfSymbols;
+  while (Low < High) {
+    Middle = Low + (High - Low) / 2;
+    if (Symbols[ValueIndex[Middle]].Value < LookupValue) {
+      Low = Middle + 1;
+    } else {
+      High = Middle;
+    }
+  }
+
+  //
+  // Entries with equal values are ordered by position, pick the first
+  // one from the requested range. C++ symbols are put at the end.
+  //
+  FirstCxxSymbol = 0;
+  if (SymbolLevel == OcGetSymbolOnlyCxx) {
+    FirstCxxSymbol = Kext->NumberOfSymbols - Kext->NumberOfCxxSymbols;
+  }
+
+  while (Low < Kext->NumberOfSymbols && Symbols[ValueIndex[Low]].Value == LookupValue) {
+    if (ValueIndex[Low] >= FirstCxxSymbol) {
+      return &Symbols[ValueIndex[Low]];
+    }
+
+    ++Low;
+  }
+
+  return NULL;
+}
+
 STATIC
 CONST PRELINKED_KEXT_SYMBOL *
 InternalOcGetSymbolWorkerValue (
+  IN PRELINKED_CONTEXT                *Context,
   IN PRELINKED_KEXT                   *Kext,
   IN UINT64                           LookupValue,
   IN OC_GET_SYMBOL_LEVEL              SymbolLevel
@@ -134,21 +431,30 @@ InternalOcGetSymbolWorkerValue (
   Kext->Processed = TRUE;
 
   if (Kext->LinkedSymbolTable != NULL) {
+    InternalBuildLinkedSymbolValueIndex (Kext, Context);
+  }
+
+  if (Kext->LinkedSymbolValueIndex != NULL) {
+    Symbols = InternalOcGetSymbolIndexedValue (Kext, LookupValue, SymbolLevel);
+    if (Symbols != NULL) {
+      return Symbols;
+    }
+  } else if (Kext->LinkedSymbolTable != NULL) {
     NumSymbols = Kext->NumberOfSymbols;
     Symbols    = Kext->LinkedSymbolTable;
 
     if (SymbolLevel == OcGetSymbolOnlyCxx) {
       NumSymbols = Kext->NumberOfCxxSymbols;
-      Symbols    = &Kext->LinkedSymbolTable[(Kext->NumberOfSymbols - Kext->NumberOfCxxSymbols) & ~15ULL];
+      Symbols    = &Kext->LinkedSymbolTable[Kext->NumberOfSymbols - Kext->NumberOfCxxSymbols];
     }
     //
     // WARN! Hot path! Do not change this code unless you have decent profiling data.
     // We are not allowed to use SIMD in UEFI, but we can still do better with larger iteration.
-    // Up to 15 C symbols extra may get parsed, but it is fine, as they will not match.
     // Increasing the iteration block to more than 16 no longer pays off.
-    // Note, lower loop is not on hot path.
+    // The range matches the indexed lookup exactly, the remaining up to 15 symbols
+    // are checked one by one.
     //
-    SymbolsEnd = &Symbols[NumSymbols & ~15ULL];
+    SymbolsEnd = &Symbols[NumSymbols & ~15U];
     while (Symbols < SymbolsEnd) {
       #define MATCH(X) if (Symbols[X].Value == LookupValue) { return &Symbols[X]; }
       MATCH (0) MATCH (1) MATCH (2)  MATCH (3)  MATCH (4)  MATCH (5)  MATCH (6)  MATCH (7)
@@ -156,6 +462,15 @@ InternalOcGetSymbolWorkerValue (
       #undef MATCH
       Symbols += 16;
     }
+
+    SymbolsEnd = &Symbols[NumSymbols & 15U];
+    while (Symbols < SymbolsEnd) {
+      if (Symbols->Value == LookupValue) {
+        return Symbols;
+      }
+
+      ++Symbols;
+    }
   }
 
   if (SymbolLevel != OcGetSymbolFirstLevel) {
@@ -170,6 +485,7 @@ InternalOcGetSymbolWorkerValue (
       }
 
       Symbols = InternalOcGetSymbolWorkerValue (
+                 Context,
                  Dependency,
                  LookupValue,
                  OcGetSymbolOnlyCxx
@@ -196,6 +512,7 @@ InternalOcGetSymbolName (
   PRELINKED_KEXT              *Dependency;
   UINT32                      Index;
   UINT32                      LookupValueLength;
+  UINT32                      LookupValueHash;
 
   Symbol = NULL;
   LookupValueLength = (UINT32)AsciiStrLen (LookupValue);
@@ -207,11 +524,17 @@ InternalOcGetSymbolName (
     return NULL;
   }
 
+  //
+  // Hash once, the same value is used for every kext in dependency walk.
+  //
+  LookupValueHash = InternalGetSymbolNameHash (LookupValue, LookupValueLength);
+
   if ((SymbolLevel == OcGetSymbolOnlyCxx) && (Kext->LinkedSymbolTable != NULL)) {
     Symbol = InternalOcGetSymbolWorkerName (
       Kext,
       LookupValue,
       LookupValueLength,
+      LookupValueHash,
       SymbolLevel
       );
   } else {
@@ -225,6 +548,7 @@ InternalOcGetSymbolName (
                  Dependency,
                  LookupValue,
                  LookupValueLength,
+                 LookupValueHash,
                  SymbolLevel
                  );
       if (Symbol != NULL) {
@@ -254,7 +578,7 @@ InternalOcGetSymbolValue (
   Symbol = NULL;
 
   if ((SymbolLevel == OcGetSymbolOnlyCxx) && (Kext->LinkedSymbolTable != NULL)) {
-    Symbol = InternalOcGetSymbolWorkerValue (Kext, LookupValue, SymbolLevel);
+    Symbol = InternalOcGetSymbolWorkerValue (Context, Kext, LookupValue, SymbolLevel);
   } else {
     for (Index = 0; Index < ARRAY_SIZE (Kext->Dependencies); ++Index) {
       Dependency = Kext->Dependencies[Index];
@@ -263,6 +587,7 @@ InternalOcGetSymbolValue (
       }
 
       Symbol = InternalOcGetSymbolWorkerValue (
+                 Context,
                  Dependency,
                  LookupValue,
                  SymbolLevel
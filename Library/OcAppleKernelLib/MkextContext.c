@@ -232,6 +232,7 @@ InsertCachedMkextKext (
   IN     UINT32             BinSize
   )
 {
+  EFI_STATUS      Status;
   MKEXT_KEXT      *MkextKext;
 
   MkextKext = AllocateZeroPool (sizeof (*MkextKext));
@@ -248,6 +249,18 @@ InsertCachedMkextKext (
     return NULL;
   }
 
+  Status = InternalKextIdentifierMapInsert (
+    &Context->CachedKextsMap,
+    MkextKext->Identifier,
+    NULL,
+    MkextKext
+    );
+  if (EFI_ERROR (Status)) {
+    FreePool (MkextKext->Identifier);
+    FreePool (MkextKext);
+    return NULL;
+  }
+
   InsertTailList (&Context->CachedKexts, &MkextKext->Link);
 
   DEBUG ((DEBUG_VERBOSE, "OCAK: Inserted %a into mkext cache\n", Identifier));
@@ -255,6 +268,102 @@ InsertCachedMkextKext (
   return MkextKext;
 }
 
+STATIC
+VOID
+IndexMkextV2Kexts (
+  IN OUT MKEXT_CONTEXT      *Context
+  )
+{
+  EFI_STATUS          Status;
+  UINT32              Index;
+  UINT32              PlistBundlesCount;
+  XML_NODE            *PlistBundle;
+  CONST CHAR8         *KextIdentifier;
+
+  ASSERT (Context->MkextVersion == MKEXT_VERSION_V2);
+
+  //
+  // Bundle dicts appended by injection are not parsed, so the index built once
+  // stays complete for the rest of the context lifetime.
+  //
+  PlistBundlesCount = XmlNodeChildren (Context->MkextKexts);
+  for (Index = 0; Index < PlistBundlesCount; Index++) {
+    PlistBundle = PlistNodeCast (XmlNodeChild (Context->MkextKexts, Index), PLIST_NODE_TYPE_DICT);
+    if (PlistBundle == NULL) {
+      //
+      // Leave malformed mkext for linear lookup, which fails on such entries.
+      //
+      return;
+    }
+
+    KextIdentifier = InternalKextPlistGetIdentifier (PlistBundle);
+    if (KextIdentifier == NULL) {
+      continue;
+    }
+
+    Status = InternalKextIdentifierMapInsert (
+      &Context->CachedKextsMap,
+      KextIdentifier,
+      PlistBundle,
+      NULL
+      );
+    if (EFI_ERROR (Status)) {
+      return;
+    }
+  }
+
+  Context->MkextKextsIndexed = TRUE;
+}
+
+STATIC
+EFI_STATUS
+GetMkextV2KextBinaryOffset (
+  IN     MKEXT_CONTEXT      *Context,
+  IN     XML_NODE           *PlistBundle,
+  IN     CONST CHAR8        *Identifier,
+     OUT UINT32             *KextBinOffset
+  )
+{
+  UINT32              PlistBundleIndex;
+  UINT32              PlistBundleCount;
+  CONST CHAR8         *PlistBundleKey;
+  XML_NODE            *PlistBundleKeyValue;
+  CONST CHAR8         *KextIdentifier;
+
+  KextIdentifier  = NULL;
+  *KextBinOffset  = 0;
+
+  PlistBundleCount = PlistDictChildren (PlistBundle);
+  for (PlistBundleIndex = 0; PlistBundleIndex < PlistBundleCount; PlistBundleIndex++) {
+    PlistBundleKey = PlistKeyValue (PlistDictChild (PlistBundle, PlistBundleIndex, &PlistBundleKeyValue));
+    if (PlistBundleKey == NULL || PlistBundleKeyValue == NULL) {
+      continue;
+    }
+
+    if (AsciiStrCmp (PlistBundleKey, INFO_BUNDLE_IDENTIFIER_KEY) == 0) {
+      KextIdentifier = XmlNodeContent (PlistBundleKeyValue);
+    }
+
+    if (AsciiStrCmp (PlistBundleKey, MKEXT_EXECUTABLE_KEY) == 0) {
+      //
+      // Ensure binary offset is before plist offset.
+      //
+      if (!PlistIntegerValue (PlistBundleKeyValue, KextBinOffset, sizeof (*KextBinOffset), TRUE)) {
+        return EFI_INVALID_PARAMETER;
+      }
+    }
+  }
+
+  if (KextIdentifier != NULL
+    && AsciiStrCmp (KextIdentifier, Identifier) == 0
+    && *KextBinOffset > 0
+    && *KextBinOffset < Context->MkextSize - sizeof (MKEXT_V2_FILE_ENTRY)) {
+    return EFI_SUCCESS;
+  }
+
+  return EFI_NOT_FOUND;
+}
+
 MKEXT_KEXT *
 InternalCachedMkextKext (
   IN OUT MKEXT_CONTEXT      *Context,
@@ -264,8 +373,8 @@ InternalCachedMkextKext (
   MKEXT_HEADER_ANY    *MkextHeader;
   MKEXT_V2_FILE_ENTRY *MkextV2FileEntry;
 
-  MKEXT_KEXT          *MkextKext;
-  LIST_ENTRY          *KextLink;
+  EFI_STATUS                 Status;
+  KEXT_IDENTIFIER_MAP_ENTRY  *Entry;
   UINT32              Index;
   UINT32              PlistOffsetSize;
   UINT32              BinOffsetSize;
@@ -293,15 +402,9 @@ InternalCachedMkextKext (
   //
   // Try to get cached kext.
   //
-  KextLink = GetFirstNode (&Context->CachedKexts);
-  while (!IsNull (&Context->CachedKexts, KextLink)) {
-    MkextKext = GET_MKEXT_KEXT_FROM_LINK (KextLink);
-
-    if (AsciiStrCmp (Identifier, MkextKext->Identifier) == 0) {
-      return MkextKext;
-    }
-
-    KextLink = GetNextNode (&Context->CachedKexts, KextLink);
+  Entry = InternalKextIdentifierMapLookup (&Context->CachedKextsMap, Identifier);
+  if (Entry != NULL && Entry->Kext != NULL) {
+    return Entry->Kext;
   }
 
   //
@@ -390,50 +493,50 @@ InternalCachedMkextKext (
   // Mkext v2.
   //
   } else if (Context->MkextVersion == MKEXT_VERSION_V2) {
-    KextIdentifier  = NULL;
-    KextBinOffset   = 0;
+    KextBinOffset = 0;
+
+    if (!Context->MkextKextsIndexed) {
+      IndexMkextV2Kexts (Context);
+    }
+
+    //
+    // Evaluate the first bundle dict with matching identifier from the index.
+    // Fall back to enumerating bundle dicts should it be unusable, as a later
+    // duplicate may still be valid.
+    //
+    if (Context->MkextKextsIndexed) {
+      Entry = InternalKextIdentifierMapLookup (&Context->CachedKextsMap, Identifier);
+      if (Entry == NULL || Entry->Plist == NULL) {
+        return NULL;
+      }
+
+      Status = GetMkextV2KextBinaryOffset (Context, Entry->Plist, Identifier, &KextBinOffset);
+      if (Status == EFI_INVALID_PARAMETER) {
+        return NULL;
+      }
+
+      IsKextMatch = !EFI_ERROR (Status);
+    }
 
     //
     // Enumerate bundle dicts.
     //
-    PlistBundlesCount = XmlNodeChildren (Context->MkextKexts);
+    PlistBundlesCount = IsKextMatch ? 0 : XmlNodeChildren (Context->MkextKexts);
     for (Index = 0; Index < PlistBundlesCount; Index++) {
       PlistBundle = PlistNodeCast (XmlNodeChild (Context->MkextKexts, Index), PLIST_NODE_TYPE_DICT);
       if (PlistBundle == NULL) {
         return NULL;
       }
 
-      PlistBundleCount = PlistDictChildren (PlistBundle);
-      for (PlistBundleIndex = 0; PlistBundleIndex < PlistBundleCount; PlistBundleIndex++) {
-        PlistBundleKey = PlistKeyValue (PlistDictChild (PlistBundle, PlistBundleIndex, &PlistBundleKeyValue));
-        if (PlistBundleKey == NULL || PlistBundleKeyValue == NULL) {
-          continue;
-        }
-        
-        if (AsciiStrCmp (PlistBundleKey, INFO_BUNDLE_IDENTIFIER_KEY) == 0) {
-          KextIdentifier = XmlNodeContent (PlistBundleKeyValue);
-        }
-
-        if (AsciiStrCmp (PlistBundleKey, MKEXT_EXECUTABLE_KEY) == 0) {
-          //
-          // Ensure binary offset is before plist offset.
-          //
-          if (!PlistIntegerValue (PlistBundleKeyValue, &KextBinOffset, sizeof (KextBinOffset), TRUE)) {
-            return NULL;
-          }
-        }
+      Status = GetMkextV2KextBinaryOffset (Context, PlistBundle, Identifier, &KextBinOffset);
+      if (Status == EFI_INVALID_PARAMETER) {
+        return NULL;
       }
 
-      if (KextIdentifier != NULL
-        && AsciiStrCmp (KextIdentifier, Identifier) == 0
-        && KextBinOffset > 0
-        && KextBinOffset < Context->MkextSize - sizeof (MKEXT_V2_FILE_ENTRY)) {
+      if (!EFI_ERROR (Status)) {
         IsKextMatch = TRUE;
         break;
       }
-
-      KextIdentifier  = NULL;
-      KextBinOffset   = 0;
     }
 
     //
@@ -1090,6 +1193,8 @@ MkextContextFree (
     FreePool (MkextKext);
   }
 
+  InternalKextIdentifierMapFree (&Context->CachedKextsMap);
+
   if (Context->MkextInfoDocument != NULL) {
     XmlDocumentFree (Context->MkextInfoDocument);
   }
@@ -1430,6 +1535,36 @@ MkextContextApplyPatch (
   return PatcherApplyGenericPatch (&Patcher, Patch);
 }
 
+EFI_STATUS
+MkextContextApplyPatches (
+  IN OUT MKEXT_CONTEXT          *Context,
+  IN     CONST CHAR8            *Identifier,
+  IN     PATCHER_GENERIC_PATCH  *Patches,
+  IN     UINT32                 PatchCount,
+  OUT    EFI_STATUS             *Results
+  )
+{
+  EFI_STATUS            Status;
+  PATCHER_CONTEXT       Patcher;
+  UINT32                Index;
+
+  ASSERT (Context != NULL);
+  ASSERT (Identifier != NULL);
+  ASSERT (Patches != NULL);
+  ASSERT (Results != NULL);
+
+  Status = PatcherInitContextFromMkext (&Patcher, Context, Identifier);
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_INFO, "OCAK: Failed to mkext find %a - %r\n", Identifier, Status));
+    for (Index = 0; Index < PatchCount; ++Index) {
+      Results[Index] = Status;
+    }
+    return Status;
+  }
+
+  return PatcherApplyGenericPatches (&Patcher, Patches, PatchCount, Results);
+}
+
 EFI_STATUS
 MkextContextApplyQuirk (
   IN OUT MKEXT_CONTEXT        *Context,
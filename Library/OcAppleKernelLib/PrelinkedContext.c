@@ -470,6 +470,8 @@ PrelinkedContextFree (
 
   ZeroMem (&Context->PrelinkedKexts, sizeof (Context->PrelinkedKexts));
 
+  InternalKextIdentifierMapFree (&Context->KextMap);
+
   //
   // We do not need to iterate InjectedKexts here, as its memory was freed above.
   //
@@ -1189,6 +1191,21 @@ PrelinkedInjectKext (
   // Let other kexts depend on this one.
   //
   if (PrelinkedKext != NULL) {
+    //
+    // Drop the index on failure, it is rebuilt from the lists on next lookup.
+    //
+    if (Context->KextMap.Entries != NULL) {
+      Status = InternalKextIdentifierMapInsert (
+        &Context->KextMap,
+        PrelinkedKext->Identifier,
+        NULL,
+        PrelinkedKext
+        );
+      if (EFI_ERROR (Status)) {
+        InternalKextIdentifierMapFree (&Context->KextMap);
+      }
+    }
+
     InsertTailList (&Context->PrelinkedKexts, &PrelinkedKext->Link);
     //
     // Additionally register this kext in the injected list, as this is required
@@ -1223,6 +1240,36 @@ PrelinkedContextApplyPatch (
   return PatcherApplyGenericPatch (&Patcher, Patch);
 }
 
+EFI_STATUS
+PrelinkedContextApplyPatches (
+  IN OUT PRELINKED_CONTEXT      *Context,
+  IN     CONST CHAR8            *Identifier,
+  IN     PATCHER_GENERIC_PATCH  *Patches,
+  IN     UINT32                 PatchCount,
+  OUT    EFI_STATUS             *Results
+  )
+{
+  EFI_STATUS            Status;
+  PATCHER_CONTEXT       Patcher;
+  UINT32                Index;
+
+  ASSERT (Context != NULL);
+  ASSERT (Identifier != NULL);
+  ASSERT (Patches != NULL);
+  ASSERT (Results != NULL);
+
+  Status = PatcherInitContextFromPrelinked (&Patcher, Context, Identifier);
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_INFO, "OCAK: Failed to pk find %a - %r\n", Identifier, Status));
+    for (Index = 0; Index < PatchCount; ++Index) {
+      Results[Index] = Status;
+    }
+    return Status;
+  }
+
+  return PatcherApplyGenericPatches (&Patcher, Patches, PatchCount, Results);
+}
+
 EFI_STATUS
 PrelinkedContextApplyQuirk (
   IN OUT PRELINKED_CONTEXT    *Context,
@@ -127,6 +127,20 @@ struct PRELINKED_KEXT_ {
   //
   PRELINKED_KEXT_SYMBOL    *LinkedSymbolTable;
   //
+  // Open addressing hash index of LinkedSymbolTable names, may be NULL.
+  // Each slot contains LinkedSymbolTable index + 1, 0 marks an empty slot.
+  //
+  UINT32                   *LinkedSymbolIndex;
+  //
+  // LinkedSymbolIndex slot count minus 1, slot count is a power of two.
+  //
+  UINT32                   LinkedSymbolIndexMask;
+  //
+  // LinkedSymbolTable indices sorted by symbol value, may be NULL.
+  // Built lazily on first lookup by value.
+  //
+  UINT32                   *LinkedSymbolValueIndex;
+  //
   // A flag set during dependency walk BFS to avoid going through the same path.
   //
   BOOLEAN                  Processed;
@@ -198,6 +212,17 @@ InternalCachedPrelinkedKext (
   IN     CONST CHAR8        *Identifier
   );
 
+/**
+  Index PRELINKED_CONTEXT cached kexts and KextList dictionaries by identifier.
+  Called on first lookup. When several KextList dictionaries share a bundle
+  identifier, the first one wins, like with in-order KextList scan.
+  The map is left empty on failure.
+**/
+EFI_STATUS
+InternalIndexPrelinkedKexts (
+  IN OUT PRELINKED_CONTEXT  *Prelinked
+  );
+
 /**
   Gets cached kernel PRELINKED_KEXT from PRELINKED_CONTEXT.
 **/
@@ -206,6 +231,75 @@ InternalCachedPrelinkedKernel (
   IN OUT PRELINKED_CONTEXT  *Prelinked
   );
 
+/**
+  Initialise kext identifier map.
+
+  @param[out] Map       Kext identifier map.
+  @param[in]  Capacity  Expected amount of identifiers.
+
+  @retval EFI_SUCCESS on success.
+**/
+EFI_STATUS
+InternalKextIdentifierMapInit (
+  OUT KEXT_IDENTIFIER_MAP  *Map,
+  IN  UINT32               Capacity
+  );
+
+/**
+  Lookup kext identifier map entry.
+
+  @param[in] Map         Kext identifier map.
+  @param[in] Identifier  Kext bundle identifier.
+
+  @return  map entry or NULL. Valid only until the next insertion.
+**/
+KEXT_IDENTIFIER_MAP_ENTRY *
+InternalKextIdentifierMapLookup (
+  IN CONST KEXT_IDENTIFIER_MAP  *Map,
+  IN CONST CHAR8                *Identifier
+  );
+
+/**
+  Insert or update kext identifier map entry. Already set Plist and Kext
+  values of an existing entry are preserved.
+
+  @param[in,out] Map         Kext identifier map.
+  @param[in]     Identifier  Kext bundle identifier, must outlive the map.
+  @param[in]     Plist       Kext Info.plist dictionary, optional.
+  @param[in]     Kext        Cached kext, optional.
+
+  @retval EFI_SUCCESS on success.
+**/
+EFI_STATUS
+InternalKextIdentifierMapInsert (
+  IN OUT KEXT_IDENTIFIER_MAP  *Map,
+  IN     CONST CHAR8          *Identifier,
+  IN     XML_NODE             *Plist  OPTIONAL,
+  IN     VOID                 *Kext   OPTIONAL
+  );
+
+/**
+  Free kext identifier map.
+
+  @param[in,out] Map         Kext identifier map.
+**/
+VOID
+InternalKextIdentifierMapFree (
+  IN OUT KEXT_IDENTIFIER_MAP  *Map
+  );
+
+/**
+  Get CFBundleIdentifier from kext Info.plist dictionary.
+
+  @param[in] KextPlist   Kext Info.plist dictionary.
+
+  @return  bundle identifier or NULL.
+**/
+CONST CHAR8 *
+InternalKextPlistGetIdentifier (
+  IN XML_NODE  *KextPlist
+  );
+
 /**
   Scan PRELINKED_KEXT for dependencies.
 **/
@@ -414,6 +508,34 @@ InternalOcGetSymbolValue (
   IN OC_GET_SYMBOL_LEVEL  SymbolLevel
   );
 
+/**
+  Calculate symbol name hash for LinkedSymbolIndex lookup.
+
+  @param[in] Name     Symbol name.
+  @param[in] Length   Symbol name length.
+
+  @return  symbol name hash.
+**/
+UINT32
+InternalGetSymbolNameHash (
+  IN CONST CHAR8  *Name,
+  IN UINT32       Length
+  );
+
+/**
+  Build hash index for LinkedSymbolTable of a dependency kext.
+  Failure to build the index is not fatal, the lookup falls back to
+  a linear scan in this case.
+
+  @param[in,out] Kext        Kext dependency with LinkedSymbolTable.
+  @param[in]     Context     Prelinking context.
+**/
+VOID
+InternalBuildLinkedSymbolIndex (
+  IN OUT PRELINKED_KEXT     *Kext,
+  IN     PRELINKED_CONTEXT  *Context
+  );
+
 VOID
 InternalSolveSymbolValue (
   IN  BOOLEAN             Is32Bit,
@@ -441,6 +441,8 @@ InternalScanBuildLinkedSymbolTable (
   Kext->NumberOfCxxSymbols = NumCxxSymbols;
   Kext->LinkedSymbolTable  = SymbolTable;
 
+  InternalBuildLinkedSymbolIndex (Kext, Context);
+
   return EFI_SUCCESS;
 }
 
@@ -652,6 +654,16 @@ InternalFreePrelinkedKext (
     Kext->LinkedSymbolTable = NULL;
   }
 
+  if (Kext->LinkedSymbolIndex != NULL) {
+    FreePool (Kext->LinkedSymbolIndex);
+    Kext->LinkedSymbolIndex = NULL;
+  }
+
+  if (Kext->LinkedSymbolValueIndex != NULL) {
+    FreePool (Kext->LinkedSymbolValueIndex);
+    Kext->LinkedSymbolValueIndex = NULL;
+  }
+
   if (Kext->LinkedVtables != NULL) {
     FreePool (Kext->LinkedVtables);
     Kext->LinkedVtables = NULL;
@@ -660,8 +672,71 @@ InternalFreePrelinkedKext (
   FreePool (Kext);
 }
 
+EFI_STATUS
+InternalIndexPrelinkedKexts (
+  IN OUT PRELINKED_CONTEXT  *Prelinked
+  )
+{
+  EFI_STATUS      Status;
+  LIST_ENTRY      *Kext;
+  PRELINKED_KEXT  *CachedKext;
+  UINT32          Index;
+  UINT32          KextCount;
+  XML_NODE        *KextPlist;
+  CONST CHAR8     *KextIdentifier;
+
+  KextCount = XmlNodeChildren (Prelinked->KextList);
+
+  Status = InternalKextIdentifierMapInit (&Prelinked->KextMap, KextCount);
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  //
+  // Cached kexts go first, as they are looked up before KextList.
+  // The kernel is matched separately by InternalCachedPrelinkedKext.
+  //
+  Kext = GetFirstNode (&Prelinked->PrelinkedKexts);
+  while (!IsNull (&Prelinked->PrelinkedKexts, Kext)) {
+    CachedKext = GET_PRELINKED_KEXT_FROM_LINK (Kext);
+    if (AsciiStrCmp (CachedKext->Identifier, PRELINK_KERNEL_IDENTIFIER) != 0) {
+      Status = InternalKextIdentifierMapInsert (&Prelinked->KextMap, CachedKext->Identifier, NULL, CachedKext);
+      if (EFI_ERROR (Status)) {
+        InternalKextIdentifierMapFree (&Prelinked->KextMap);
+        return Status;
+      }
+    }
+
+    Kext = GetNextNode (&Prelinked->PrelinkedKexts, Kext);
+  }
+
+  //
+  // Duplicate bundle identifiers resolve to the first KextList entry.
+  //
+  for (Index = 0; Index < KextCount; ++Index) {
+    KextPlist = PlistNodeCast (XmlNodeChild (Prelinked->KextList, Index), PLIST_NODE_TYPE_DICT);
+    if (KextPlist == NULL) {
+      continue;
+    }
+
+    KextIdentifier = InternalKextPlistGetIdentifier (KextPlist);
+    if (KextIdentifier == NULL) {
+      continue;
+    }
+
+    Status = InternalKextIdentifierMapInsert (&Prelinked->KextMap, KextIdentifier, KextPlist, NULL);
+    if (EFI_ERROR (Status)) {
+      InternalKextIdentifierMapFree (&Prelinked->KextMap);
+      return Status;
+    }
+  }
+
+  return EFI_SUCCESS;
+}
+
+STATIC
 PRELINKED_KEXT *
-InternalCachedPrelinkedKext (
+InternalCachedPrelinkedKextLinear (
   IN OUT PRELINKED_CONTEXT  *Prelinked,
   IN     CONST CHAR8        *Identifier
   )
@@ -711,6 +786,70 @@ InternalCachedPrelinkedKext (
   return NewKext;
 }
 
+PRELINKED_KEXT *
+InternalCachedPrelinkedKext (
+  IN OUT PRELINKED_CONTEXT  *Prelinked,
+  IN     CONST CHAR8        *Identifier
+  )
+{
+  EFI_STATUS                 Status;
+  PRELINKED_KEXT             *NewKext;
+  LIST_ENTRY                 *Kext;
+  KEXT_IDENTIFIER_MAP_ENTRY  *Entry;
+
+  //
+  // Kernel is always the first cached entry when present.
+  //
+  if (AsciiStrCmp (Identifier, PRELINK_KERNEL_IDENTIFIER) == 0) {
+    Kext = GetFirstNode (&Prelinked->PrelinkedKexts);
+    if (IsNull (&Prelinked->PrelinkedKexts, Kext)) {
+      return NULL;
+    }
+
+    return GET_PRELINKED_KEXT_FROM_LINK (Kext);
+  }
+
+  //
+  // Index is built on first lookup. Keep using list scan when it cannot be.
+  //
+  if (Prelinked->KextMap.Entries == NULL) {
+    Status = InternalIndexPrelinkedKexts (Prelinked);
+    if (EFI_ERROR (Status)) {
+      DEBUG ((DEBUG_INFO, "OCAK: Failed to index prelinked kexts - %r\n", Status));
+      return InternalCachedPrelinkedKextLinear (Prelinked, Identifier);
+    }
+  }
+
+  //
+  // Find cached entry if any.
+  //
+  Entry = InternalKextIdentifierMapLookup (&Prelinked->KextMap, Identifier);
+  if (Entry == NULL) {
+    return NULL;
+  }
+
+  if (Entry->Kext != NULL) {
+    return Entry->Kext;
+  }
+
+  //
+  // Try with real entry.
+  //
+  if (Entry->Plist == NULL) {
+    return NULL;
+  }
+
+  NewKext = InternalCreatePrelinkedKext (Prelinked, Entry->Plist, Identifier);
+  if (NewKext == NULL) {
+    return NULL;
+  }
+
+  Entry->Kext = NewKext;
+  InsertTailList (&Prelinked->PrelinkedKexts, &NewKext->Link);
+
+  return NewKext;
+}
+
 PRELINKED_KEXT *
 InternalCachedPrelinkedKernel (
   IN OUT PRELINKED_CONTEXT  *Prelinked
@@ -55,6 +55,20 @@ InternalLoadDmg (
   IN     OC_DMG_LOADING_SUPPORT      DmgLoading
   );
 
+/**
+  Verify DMG data not yet verified while loading the boot file.
+  Must be called before starting the image loaded off the DMG.
+
+  @param[in] DmgLoadContext  Loaded DMG context.
+
+  @retval EFI_SUCCESS             All DMG data is trusted.
+  @retval EFI_SECURITY_VIOLATION  DMG data has been altered.
+**/
+EFI_STATUS
+InternalVerifyDmg (
+  IN INTERNAL_DMG_LOAD_CONTEXT  *DmgLoadContext
+  );
+
 VOID
 InternalUnloadDmg (
   IN INTERNAL_DMG_LOAD_CONTEXT  *DmgLoadContext
@@ -1168,6 +1168,13 @@ InternalLoadBootEntry (
     FreePool (EntryData);
   }
 
+  if (!EFI_ERROR (Status) && BootEntry->IsFolder) {
+    Status = InternalVerifyDmg (DmgLoadContext);
+    if (EFI_ERROR (Status)) {
+      gBS->UnloadImage (*EntryHandle);
+    }
+  }
+
   if (!EFI_ERROR (Status)) {
     OptionalStatus = gBS->HandleProtocol (
       *EntryHandle,
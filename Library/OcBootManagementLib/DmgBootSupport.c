@@ -17,6 +17,7 @@
 #include <Guid/FileInfo.h>
 
 #include <Library/OcAppleSecureBootLib.h>
+#include <Library/BaseLib.h>
 #include <Library/BaseMemoryLib.h>
 #include <Library/DebugLib.h>
 #include <Library/DevicePathLib.h>
@@ -25,6 +26,7 @@
 #include <Library/OcAppleKeysLib.h>
 #include <Library/OcFileLib.h>
 #include <Library/OcStringLib.h>
+#include <Library/PcdLib.h>
 #include <Library/UefiBootServicesTableLib.h>
 #include <Library/UefiLib.h>
 #include <Library/UefiRuntimeServicesTableLib.h>
@@ -169,12 +171,16 @@ InternalGetDiskImageBootFile (
       return NULL;
     }
 
-    Result = OcAppleDiskImageVerifyData (
+    //
+    // Verify DMG chunks as they are read instead of hashing the whole image
+    // upfront. The rest is verified by InternalVerifyDmg before StartImage.
+    //
+    Result = OcAppleDiskImageVerifyDataLazy (
                Context->DmgContext,
                &ChunklistContext
                );
     if (!Result) {
-      DEBUG ((DEBUG_WARN, "OCB: DMG has been altered\n"));
+      DEBUG ((DEBUG_WARN, "OCB: Failed to prepare DMG verification\n"));
       return NULL;
     }
   }
@@ -336,6 +342,8 @@ InternalLoadDmg (
   UINT32                   ChunklistFileSize;
   VOID                     *ChunklistBuffer;
 
+  EFI_MP_SERVICES_PROTOCOL *MpServices;
+
   CHAR16 *DevPathText;
 
   ASSERT (Context != NULL);
@@ -422,6 +430,21 @@ InternalLoadDmg (
     return NULL;
   }
 
+  //
+  // Decompress DMG chunks on application processors when enabled at build time.
+  //
+  if (FeaturePcdGet (PcdDmgDecompressOnAps)) {
+    Status = gBS->LocateProtocol (
+      &gEfiMpServiceProtocolGuid,
+      NULL,
+      (VOID **) &MpServices
+      );
+    if (!EFI_ERROR (Status)) {
+      Status = OcAppleDiskImageSetMpServices (Context->DmgContext, MpServices);
+      DEBUG ((DEBUG_INFO, "OCB: DMG decompression on APs - %r\n", Status));
+    }
+  }
+
   ChunklistBuffer   = NULL;
   ChunklistFileSize = 0;
 
@@ -494,6 +517,25 @@ InternalLoadDmg (
   return DevPath;
 }
 
+EFI_STATUS
+InternalVerifyDmg (
+  IN INTERNAL_DMG_LOAD_CONTEXT  *DmgLoadContext
+  )
+{
+  ASSERT (DmgLoadContext->DmgContext != NULL);
+
+  //
+  // DMG memory is handed to the kernel as is, so it must not contain
+  // any bytes left unverified by lazy reads once the booter starts.
+  //
+  if (!OcAppleDiskImageVerifyRemainingData (DmgLoadContext->DmgContext)) {
+    DEBUG ((DEBUG_WARN, "OCB: DMG has been altered, aborting\n"));
+    return EFI_SECURITY_VIOLATION;
+  }
+
+  return EFI_SUCCESS;
+}
+
 VOID
 InternalUnloadDmg (
   IN INTERNAL_DMG_LOAD_CONTEXT  *DmgLoadContext
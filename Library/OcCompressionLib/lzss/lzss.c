@@ -137,6 +137,105 @@ u_int32_t decompress_lzss(
     return (u_int32_t)(dst - dststart);
 }
 
+/*
+ * Incremental decoder state. Mirrors the locals of decompress_lzss, so that
+ * decoding can be suspended at any source byte and resumed with the next
+ * chunk of data.
+ */
+struct decode_state {
+    u_int8_t text_buf[N + F - 1];
+    u_int8_t * dststart;
+    u_int8_t * dst;
+    const u_int8_t * dstend;
+    int r;
+    unsigned int flags;
+    /* current flags bit is read but not decoded yet */
+    int have_flags;
+    /* first byte of a position and length pair split across chunks */
+    int have_pos;
+    int pos;
+};
+
+/*******************************************************************************
+*******************************************************************************/
+void * decompress_lzss_stream_init(
+    u_int8_t       * dst,
+    u_int32_t        dstlen)
+{
+    struct decode_state *sp;
+
+    if (dstlen > OC_COMPRESSION_MAX_LENGTH) {
+        return NULL;
+    }
+
+    sp = (struct decode_state *) malloc(sizeof(*sp));
+    if (!sp) return NULL;
+
+    bzero(sp, sizeof(*sp));
+    memset(sp->text_buf, ' ', N - F);
+    sp->dststart = dst;
+    sp->dst = dst;
+    sp->dstend = dst + dstlen;
+    sp->r = N - F;
+    return sp;
+}
+
+/*******************************************************************************
+*******************************************************************************/
+u_int32_t decompress_lzss_stream(
+    void           * context,
+    const u_int8_t * src,
+    u_int32_t        srclen)
+{
+    struct decode_state *sp = (struct decode_state *) context;
+    const u_int8_t * srcend = src + srclen;
+    int  i, j, k;
+    u_int8_t c;
+
+    while (sp->dst < sp->dstend) {
+        if (!sp->have_flags) {
+            if (((sp->flags >> 1) & 0x100) == 0) {
+                if (src < srcend) c = *src++; else break;
+                sp->flags = c | 0xFF00;  /* uses higher byte cleverly */
+            } else {                     /* to count eight */
+                sp->flags >>= 1;
+            }
+            sp->have_flags = 1;
+        }
+        if (sp->flags & 1) {
+            if (src < srcend) c = *src++; else break;
+            *sp->dst++ = c;
+            sp->text_buf[sp->r++] = c;
+            sp->r &= (N - 1);
+        } else {
+            if (!sp->have_pos) {
+                if (src < srcend) sp->pos = *src++; else break;
+                sp->have_pos = 1;
+            }
+            if (src < srcend) j = *src++; else break;
+            sp->have_pos = 0;
+            i = sp->pos | ((j & 0xF0) << 4);
+            j = (j & 0x0F) + THRESHOLD;
+            for (k = 0; k <= j; k++) {
+                c = sp->text_buf[(i + k) & (N - 1)];
+                if (sp->dst < sp->dstend) *sp->dst++ = c; else break;
+                sp->text_buf[sp->r++] = c;
+                sp->r &= (N - 1);
+            }
+        }
+        sp->have_flags = 0;
+    }
+
+    return (u_int32_t)(sp->dst - sp->dststart);
+}
+
+/*******************************************************************************
+*******************************************************************************/
+void decompress_lzss_stream_free(void * context)
+{
+    free(context);
+}
+
 /*
  * initialize state, mostly the trees
  *
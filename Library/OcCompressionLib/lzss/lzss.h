@@ -29,6 +29,9 @@ typedef INT32 int32_t;
 
 #define compress_lzss CompressLZSS
 #define decompress_lzss DecompressLZSS
+#define decompress_lzss_stream_init DecompressLZSSStreamInit
+#define decompress_lzss_stream DecompressLZSSStream
+#define decompress_lzss_stream_free DecompressLZSSStreamFree
 
 #ifdef memset
 #undef memset
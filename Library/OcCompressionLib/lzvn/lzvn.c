@@ -614,6 +614,8 @@ sml_m:
   opc_len = 1;
   if (src_len <= opc_len)
     return; // source truncated
+  if (D == 0)
+    goto invalid_match_distance;
   M = (size_t)extract(opc, 0, 4);
   PTR_LEN_INC(src_ptr, src_len, opc_len);
   goto copy_match;
@@ -632,6 +634,8 @@ lrg_m:
   opc_len = 2;
   if (src_len <= opc_len)
     return; // source truncated
+  if (D == 0)
+    goto invalid_match_distance;
   M = src_ptr[1] + 16;
   PTR_LEN_INC(src_ptr, src_len, opc_len);
   goto copy_match;
@@ -817,6 +821,143 @@ invalid_match_distance:
 #endif
 }
 
+/*! @abstract Minimum space left in both source and destination buffers for
+ * lzvn_decode_fast to decode one instruction without bounds checks. Covers the
+ * longest instruction (2 + 271 bytes) and the slop of 16-byte wide copies. */
+#define LZVN_FAST_MARGIN 320
+
+/*! @abstract Copy 16 bytes from SRC to DST. */
+LZFSE_INLINE void copy16(unsigned char *dst, const unsigned char *src) {
+  store8(dst, load8(src));
+  store8(dst + 8, load8(src + 8));
+}
+
+/*! @abstract Decode source to destination while far from the buffer ends.
+ *  Stops before the first instruction which needs bounds checks, is invalid,
+ *  or ends the stream, so that lzvn_decode can handle the rest.
+ *  Updates \p state (src,dst,d_prev). */
+static void lzvn_decode_fast(lzvn_decoder_state *state) {
+  const unsigned char *src_ptr = state->src;
+  unsigned char *dst_ptr = state->dst;
+  size_t D = state->d_prev;
+  size_t opc_len;
+  size_t L;
+  size_t M;
+  size_t new_d;
+  size_t P;
+  size_t i;
+  unsigned char opc;
+  uint16_t opc23;
+
+  // Partially expanded match is only left when destination is full.
+  if (state->L != 0 || state->M != 0)
+    return;
+
+  while ((size_t)(state->src_end - src_ptr) >= LZVN_FAST_MARGIN &&
+         (size_t)(state->dst_end - dst_ptr) >= LZVN_FAST_MARGIN) {
+    opc = src_ptr[0];
+
+    if (opc >= 0xE0) {
+      if (opc < 0xF0) {
+        // sml_l and lrg_l: literal only.
+        if (opc == 0xE0) {
+          L = src_ptr[1] + 16;
+          src_ptr += 2;
+        } else {
+          L = opc & 0xF;
+          src_ptr += 1;
+        }
+        for (i = 0; i < L; i += 16)
+          copy16(&dst_ptr[i], &src_ptr[i]);
+        src_ptr += L;
+        dst_ptr += L;
+        continue;
+      }
+
+      // sml_m and lrg_m: match only, previous distance.
+      if (D == 0)
+        break;
+      if (opc == 0xF0) {
+        M = src_ptr[1] + 16;
+        src_ptr += 2;
+      } else {
+        M = opc & 0xF;
+        src_ptr += 1;
+      }
+    } else {
+      if ((opc >> 4) == 0x7 || (opc >> 4) == 0xD)
+        break; // udef
+      if ((opc & 0xE0) == 0xA0) {
+        // med_d
+        opc_len = 3;
+        L = (size_t)extract(opc, 3, 2);
+        opc23 = load2(&src_ptr[1]);
+        M = (size_t)((extract(opc, 0, 3) << 2 | extract(opc23, 0, 2)) + 3);
+        new_d = (size_t)extract(opc23, 2, 14);
+      } else if ((opc & 7) == 7) {
+        // lrg_d
+        opc_len = 3;
+        L = (size_t)extract(opc, 6, 2);
+        M = (size_t)extract(opc, 3, 3) + 3;
+        new_d = load2(&src_ptr[1]);
+      } else if ((opc & 7) == 6) {
+        if (opc == 0x0E || opc == 0x16) {
+          // nop
+          src_ptr += 1;
+          continue;
+        }
+        if (opc < 0x40)
+          break; // eos or udef
+        // pre_d
+        opc_len = 1;
+        L = (size_t)extract(opc, 6, 2);
+        M = (size_t)extract(opc, 3, 3) + 3;
+        new_d = D;
+      } else {
+        // sml_d
+        opc_len = 2;
+        L = (size_t)extract(opc, 6, 2);
+        M = (size_t)extract(opc, 3, 3) + 3;
+        new_d = (size_t)extract(opc, 0, 3) << 8 | src_ptr[1];
+      }
+
+      if (new_d == 0 || new_d > (size_t)(dst_ptr + L - state->dst_begin))
+        break; // invalid match distance
+
+      //  The literal is 0-3 bytes and we are far from the buffer ends.
+      src_ptr += opc_len;
+      store4(dst_ptr, load4(src_ptr));
+      src_ptr += L;
+      dst_ptr += L;
+      D = new_d;
+    }
+
+    //  Match copy must behave as a byte-by-byte copy in increasing address
+    //  order, as the source and destination windows may overlap when D < M.
+    if (D >= 16) {
+      for (i = 0; i < M; i += 16)
+        copy16(&dst_ptr[i], dst_ptr + i - D);
+    } else if (D >= 8) {
+      for (i = 0; i < M; i += 8)
+        store8(&dst_ptr[i], load8(dst_ptr + i - D));
+    } else {
+      //  Expand the first period byte-by-byte up to the smallest multiple of D,
+      //  which is at least 8 bytes. The match repeats with this period too,
+      //  so the rest can be copied with eight byte copies from there.
+      P = (8 + D - 1) / D * D;
+      for (i = 0; i < P; ++i)
+        dst_ptr[i] = *(dst_ptr + i - D);
+      for (; i < M; i += 8)
+        store8(&dst_ptr[i], load8(dst_ptr + i - P));
+    }
+    dst_ptr += M;
+  }
+
+  state->src = src_ptr;
+  state->dst = dst_ptr;
+  state->d_prev = D;
+}
+
 size_t lzvn_decode_buffer(unsigned char *dst, size_t dst_size,
                           const unsigned char *src, size_t src_size) {
   // Init LZVN decoder state
@@ -837,9 +978,135 @@ size_t lzvn_decode_buffer(unsigned char *dst, size_t dst_size,
   dstate.d_prev = 0;
   dstate.end_of_stream = 0;
 
-  // Run LZVN decoder
+  // Run LZVN decoder, use bounds checked decoder for the last bytes
+  lzvn_decode_fast(&dstate);
   lzvn_decode(&dstate);
 
   // This is how much we decompressed
   return dstate.dst - dst;
 }
+
+/*! @abstract Maximum size of a single instruction including the first byte
+ * of the next one, rounded up. Pending input never exceeds this size unless
+ * the stream is corrupted. */
+#define LZVN_STREAM_PENDING_MAX 512
+
+/*! @abstract Incremental decoder state. */
+typedef struct {
+  lzvn_decoder_state state;
+  // Bytes of an instruction split across input chunks
+  unsigned char pending[LZVN_STREAM_PENDING_MAX];
+  size_t pending_size;
+  // Decoding finished or failed, further input is ignored
+  int done;
+  // Source data is corrupted
+  int failed;
+} lzvn_stream_state;
+
+void *lzvn_decode_stream_init(unsigned char *dst, size_t dst_size) {
+  lzvn_stream_state *stream;
+
+  if (dst_size > OC_COMPRESSION_MAX_LENGTH) {
+    return NULL;
+  }
+
+  stream = malloc(sizeof(*stream));
+  if (stream == NULL) {
+    return NULL;
+  }
+
+  memset(stream, 0x00, sizeof(*stream));
+  stream->state.dst_begin = dst;
+  stream->state.dst = dst;
+  stream->state.dst_end = dst + dst_size;
+
+  return stream;
+}
+
+size_t lzvn_decode_stream(void *context, const unsigned char *src,
+                          size_t src_size) {
+  lzvn_stream_state *stream = context;
+  lzvn_decoder_state *state = &stream->state;
+  size_t copy_size;
+  size_t consumed;
+
+  if (stream->failed) {
+    return 0;
+  }
+
+  if (stream->done || src_size == 0) {
+    return state->dst - state->dst_begin;
+  }
+
+  // Complete the instruction left from the previous chunk first.
+  while (stream->pending_size > 0 && src_size > 0) {
+    copy_size = LZVN_STREAM_PENDING_MAX - stream->pending_size;
+    if (copy_size > src_size)
+      copy_size = src_size;
+    memcpy(&stream->pending[stream->pending_size], src, copy_size);
+
+    state->src = stream->pending;
+    state->src_end = stream->pending + stream->pending_size + copy_size;
+    lzvn_decode_fast(state);
+    lzvn_decode(state);
+
+    if (state->end_of_stream || state->dst == state->dst_end) {
+      stream->done = 1;
+      return state->dst - state->dst_begin;
+    }
+
+    consumed = state->src - stream->pending;
+    if (consumed >= stream->pending_size) {
+      // Continue right from the chunk.
+      src += consumed - stream->pending_size;
+      src_size -= consumed - stream->pending_size;
+      stream->pending_size = 0;
+      break;
+    }
+
+    // Still not enough data, or the stream is corrupted.
+    if (consumed == 0 && stream->pending_size + copy_size == LZVN_STREAM_PENDING_MAX) {
+      stream->done = 1;
+      stream->failed = 1;
+      return 0;
+    }
+
+    memmove(stream->pending, &stream->pending[consumed],
+            stream->pending_size + copy_size - consumed);
+    stream->pending_size += copy_size - consumed;
+    src += copy_size;
+    src_size -= copy_size;
+  }
+
+  if (src_size == 0) {
+    return state->dst - state->dst_begin;
+  }
+
+  state->src = src;
+  state->src_end = src + src_size;
+  lzvn_decode_fast(state);
+  lzvn_decode(state);
+
+  if (state->end_of_stream || state->dst == state->dst_end) {
+    stream->done = 1;
+    return state->dst - state->dst_begin;
+  }
+
+  // Save the incomplete instruction for the next chunk.
+  stream->pending_size = state->src_end - state->src;
+  if (stream->pending_size >= LZVN_STREAM_PENDING_MAX) {
+    // No instruction is this long, the decoder stopped on invalid data.
+    stream->pending_size = 0;
+    stream->done = 1;
+    stream->failed = 1;
+    return 0;
+  } else if (stream->pending_size > 0) {
+    memcpy(stream->pending, state->src, stream->pending_size);
+  }
+
+  return state->dst - state->dst_begin;
+}
+
+void lzvn_decode_stream_free(void *context) {
+  free(context);
+}
@@ -16,6 +16,7 @@
 #define LZVN_H
 
 #include <Library/BaseMemoryLib.h>
+#include <Library/MemoryAllocationLib.h>
 #include <Library/OcCompressionLib.h>
 
 typedef UINT16 uint16_t;
@@ -30,6 +31,9 @@ typedef UINTN size_t;
 typedef UINTN uintmax_t;
 
 #define lzvn_decode_buffer DecompressLZVN
+#define lzvn_decode_stream_init DecompressLZVNStreamInit
+#define lzvn_decode_stream DecompressLZVNStream
+#define lzvn_decode_stream_free DecompressLZVNStreamFree
 
 #ifdef memset
 #undef memset
@@ -39,7 +43,22 @@ typedef UINTN uintmax_t;
 #undef memcpy
 #endif
 
+#ifdef memmove
+#undef memmove
+#endif
+
+#ifdef malloc
+#undef malloc
+#endif
+
+#ifdef free
+#undef free
+#endif
+
 #define memset(Dst, Value, Size) SetMem ((Dst), (Size), (UINT8)(Value))
 #define memcpy(Dst, Src, Size) CopyMem ((Dst), (Src), (Size))
+#define memmove(Dst, Src, Size) CopyMem ((Dst), (Src), (Size))
+#define malloc(Size) AllocatePool (Size)
+#define free(Ptr) FreePool (Ptr)
 
 #endif /* LZVN_H */
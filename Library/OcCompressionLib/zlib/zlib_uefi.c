@@ -76,6 +76,99 @@ DecompressZLIB (
   return 0;
 }
 
+typedef struct {
+  UINT8  *Memory;
+  UINTN  Size;
+  UINTN  Used;
+} ZLIB_WORK_MEMORY;
+
+STATIC
+voidpf
+ZlibWorkMemoryAlloc (
+  voidpf    opaque,
+  unsigned  items,
+  unsigned  size
+  )
+{
+  ZLIB_WORK_MEMORY  *Work;
+  UINTN             Size;
+  voidpf            Result;
+
+  Work = (ZLIB_WORK_MEMORY *) opaque;
+
+  if (size != 0 && items > MAX_UINTN / size) {
+    return Z_NULL;
+  }
+
+  Size = ALIGN_VALUE ((UINTN) items * size, sizeof (UINT64));
+  if (Size > Work->Size - Work->Used) {
+    return Z_NULL;
+  }
+
+  Result      = Work->Memory + Work->Used;
+  Work->Used += Size;
+  return Result;
+}
+
+STATIC
+void
+ZlibWorkMemoryFree (
+  voidpf  opaque,
+  voidpf  ptr
+  )
+{
+  //
+  // Work memory is released as a whole by the caller.
+  //
+  (void) opaque;
+  (void) ptr;
+}
+
+UINTN
+DecompressZLIBWithWorkMemory (
+  OUT UINT8        *Dst,
+  IN  UINTN        DstLen,
+  IN  CONST UINT8  *Src,
+  IN  UINTN        SrcLen,
+  IN  VOID         *WorkMemory,
+  IN  UINTN        WorkMemorySize
+  )
+{
+  z_stream          Stream;
+  ZLIB_WORK_MEMORY  Work;
+  int               Result;
+
+  if (SrcLen > OC_COMPRESSION_MAX_LENGTH || DstLen > OC_COMPRESSION_MAX_LENGTH) {
+    return 0;
+  }
+
+  Work.Memory = WorkMemory;
+  Work.Size   = WorkMemorySize;
+  Work.Used   = 0;
+
+  Stream.next_in  = (Bytef *) Src;
+  Stream.avail_in = (uInt) SrcLen;
+  Stream.zalloc   = ZlibWorkMemoryAlloc;
+  Stream.zfree    = ZlibWorkMemoryFree;
+  Stream.opaque   = &Work;
+
+  if (inflateInit (&Stream) != Z_OK) {
+    return 0;
+  }
+
+  Stream.next_out  = Dst;
+  Stream.avail_out = (uInt) DstLen;
+
+  Result = inflate (&Stream, Z_FINISH);
+  inflateEnd (&Stream);
+
+  if (Result == Z_STREAM_END) {
+    return Stream.total_out;
+  }
+
+  return 0;
+}
+
 UINT32
 Adler32 (
   IN CONST UINT8  *Buffer,
@@ -84,3 +177,13 @@ Adler32 (
 {
   return adler32 (1, Buffer, BufferLen);
 }
+
+UINT32
+Adler32Update (
+  IN UINT32       Adler,
+  IN CONST UINT8  *Buffer,
+  IN UINT32       BufferLen
+  )
+{
+  return adler32 (Adler, Buffer, BufferLen);
+}
@@ -0,0 +1,41 @@
+/** @file
+  Copyright (C) 2026, agent. All rights reserved.
+
+This program and the accompanying materials
+are licensed and made available under the terms and conditions of the BSD License
+which accompanies this distribution.  The full text of the license may be found at
+http://opensource.org/licenses/bsd-license.php
+
+THE PROGRAM IS DISTRIBUTED UNDER THE BSD LICENSE ON AN "AS IS" BASIS,
+WITHOUT WARRANTIES OR REPRESENTATIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED.
+
+**/
+#include <Base.h>
+
+#include <Library/DebugLib.h>
+
+#include "../Sha2Internal.h"
+
+//
+// SHA extensions are not used on IA32, as firmwares are not required
+// to enable SSE there.
+//
+
+BOOLEAN
+InternalSha256ShaNiSupported (
+  VOID
+  )
+{
+  return FALSE;
+}
+
+VOID
+InternalSha256BlocksShaNi (
+  IN OUT UINT32       *State,
+  IN     CONST UINT8  *Data,
+  IN     UINTN        BlockNb
+  )
+{
+  ASSERT (FALSE);
+  InternalSha256BlocksGeneric (State, Data, BlockNb);
+}
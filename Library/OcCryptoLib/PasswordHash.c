@@ -13,11 +13,68 @@ WITHOUT WARRANTIES OR REPRESENTATIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED.
 
 #include <Base.h>
 
+#include <Library/BaseLib.h>
 #include <Library/BaseMemoryLib.h>
 #include <Library/DebugLib.h>
 #include <Library/OcGuardLib.h>
 #include <Library/OcCryptoLib.h>
 
+//
+// Number of hashing iterations. The iteration count has been chosen to take
+// roughly three seconds on modern hardware with the original implementation.
+// It cannot be changed without invalidating existing password hashes.
+//
+#define OC_PASSWORD_ITERATIONS  5000000U
+
+//
+// Maximum size of the padded iterated message for the fast path.
+// Fits 175 bytes of password and salt.
+//
+#define OC_PASSWORD_MAX_BLOCKS  2U
+
+//
+// Size of the message length field in SHA-512 padding.
+//
+#define OC_PASSWORD_LENGTH_SIZE  16U
+
+/**
+  Apply iterated SHA-512 to Hash || Password || Salt. The message has a constant
+  size, so it is padded once and only the digest is rewritten every iteration.
+
+  @param[in,out] Message  Padded message buffer starting with the digest of
+                          the previous iteration followed by Password and Salt.
+                          On return starts with the resulting digest.
+  @param[in]     BlockNb  Number of SHA-512 blocks in Message.
+  @param[out]    Context  SHA-512 context used for hashing.
+**/
+STATIC
+VOID
+InternalIterateSha512 (
+  IN OUT UINT8           *Message,
+  IN     UINTN           BlockNb,
+  OUT    SHA512_CONTEXT  *Context
+  )
+{
+  UINT32  Index;
+  UINT32  Index2;
+  UINT64  InitialState[ARRAY_SIZE (Context->State)];
+
+  Sha512Init (Context);
+  CopyMem (InitialState, Context->State, sizeof (InitialState));
+
+  for (Index = 0; Index < OC_PASSWORD_ITERATIONS; ++Index) {
+    Sha512Transform (Context, Message, BlockNb);
+
+    for (Index2 = 0; Index2 < ARRAY_SIZE (InitialState); ++Index2) {
+      WriteUnaligned64 (
+        (UINT64 *) &Message[Index2 * sizeof (UINT64)],
+        SwapBytes64 (Context->State[Index2])
+        );
+      Context->State[Index2] = InitialState[Index2];
+    }
+  }
+}
+
 VOID
 OcHashPasswordSha512 (
   IN  CONST UINT8  *Password,
@@ -28,7 +85,10 @@ OcHashPasswordSha512 (
   )
 {
   UINT32         Index;
+  UINTN          MessageSize;
+  UINTN          BlockNb;
   SHA512_CONTEXT ShaContext;
+  UINT8          Message[OC_PASSWORD_MAX_BLOCKS * SHA512_BLOCK_SIZE];
 
   ASSERT (Password != NULL);
   ASSERT (PasswordSize > 0);
@@ -40,16 +100,38 @@ OcHashPasswordSha512 (
   Sha512Final  (&ShaContext, Hash);
   //
   // The hash function is applied iteratively to slow down bruteforce attacks.
-  // The iteration count has been chosen to take roughly three seconds on
-  // modern hardware.
+  // Password and Salt are re-added into hashing to, in case of a hash
+  // collision, again yield a unique hash in the subsequent iteration.
   //
-  for (Index = 0; Index < 5000000; ++Index) {
-    Sha512Init   (&ShaContext);
-    Sha512Update (&ShaContext, Hash, SHA512_DIGEST_SIZE);
+  MessageSize = (UINTN) SHA512_DIGEST_SIZE + PasswordSize + SaltSize;
+  if (PasswordSize < sizeof (Message) && SaltSize < sizeof (Message)
+    && MessageSize + 1 + OC_PASSWORD_LENGTH_SIZE <= sizeof (Message)) {
     //
-    // Password and Salt are re-added into hashing to, in case of a hash
-    // collision, again yield a unique hash in the subsequent iteration.
+    // Pad the message once: 0x80, zeroes, and 128-bit big-endian bit length.
     //
+    BlockNb = (MessageSize + 1 + OC_PASSWORD_LENGTH_SIZE + SHA512_BLOCK_SIZE - 1)
+      / SHA512_BLOCK_SIZE;
+    ZeroMem (Message, BlockNb * SHA512_BLOCK_SIZE);
+    CopyMem (Message, Hash, SHA512_DIGEST_SIZE);
+    CopyMem (&Message[SHA512_DIGEST_SIZE], Password, PasswordSize);
+    CopyMem (&Message[SHA512_DIGEST_SIZE + PasswordSize], Salt, SaltSize);
+    Message[MessageSize] = 0x80;
+    WriteUnaligned64 (
+      (UINT64 *) &Message[BlockNb * SHA512_BLOCK_SIZE - sizeof (UINT64)],
+      SwapBytes64 (MessageSize * 8)
+      );
+
+    InternalIterateSha512 (Message, BlockNb, &ShaContext);
+    CopyMem (Hash, Message, SHA512_DIGEST_SIZE);
+
+    SecureZeroMem (Message, sizeof (Message));
+    SecureZeroMem (&ShaContext, sizeof (ShaContext));
+    return;
+  }
+
+  for (Index = 0; Index < OC_PASSWORD_ITERATIONS; ++Index) {
+    Sha512Init   (&ShaContext);
+    Sha512Update (&ShaContext, Hash, SHA512_DIGEST_SIZE);
     Sha512Update (&ShaContext, Password, PasswordSize);
     Sha512Update (&ShaContext, Salt, SaltSize);
     Sha512Final  (&ShaContext, Hash);
@@ -37,6 +37,8 @@ WITHOUT WARRANTIES OR REPRESENTATIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED.
 
 #include <Library/OcCryptoLib.h>
 
+#include "Sha2Internal.h"
+
 
 #define UNPACK64(x, str)                         \
   do {                                           \
@@ -93,7 +95,7 @@ WITHOUT WARRANTIES OR REPRESENTATIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED.
 
 
 
-STATIC CONST UINT32 SHA256_K[64] = {
+CONST UINT32 gOcSha256K[64] = {
   0x428A2F98, 0x71374491, 0xB5C0FBCF, 0xE9B5DBA5, 0x3956C25B, 0x59F111F1, 0x923F82A4, 0xAB1C5ED5,
   0xD807AA98, 0x12835B01, 0x243185BE, 0x550C7DC3, 0x72BE5D74, 0x80DEB1FE, 0x9BDC06A7, 0xC19BF174,
   0xE49B69C1, 0xEFBE4786, 0x0FC19DC6, 0x240CA1CC, 0x2DE92C6F, 0x4A7484AA, 0x5CB0A9DC, 0x76F988DA,
@@ -143,6 +145,11 @@ STATIC CONST UINT32 SHA256_H0[8] = {
   0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19
 };
 
+//
+// Selected Sha 256 implementation, resolved on first use
+//
+STATIC OC_SHA256_BACKEND mSha256Backend = OcSha256BackendAuto;
+
 //
 // Sha 384 Init State
 //
@@ -167,56 +174,115 @@ STATIC CONST UINT64 SHA512_H0[8] = {
 // Sha 256 functions
 //
 VOID
-Sha256Transform (
-  SHA256_CONTEXT  *Context,
-  CONST UINT8     *Data
+InternalSha256BlocksGeneric (
+  IN OUT UINT32       *State,
+  IN     CONST UINT8  *Data,
+  IN     UINTN        BlockNb
   )
 {
   UINT32 A, B, C, D, E, F, G, H, Index1, Index2, T1, T2;
   UINT32 M[64];
 
-  for (Index1 = 0, Index2 = 0; Index1 < 16; Index1++, Index2 += 4) {
-    M[Index1] = ((UINT32)Data[Index2] << 24)
-                | ((UINT32)Data[Index2 + 1] << 16)
-                | ((UINT32)Data[Index2 + 2] << 8)
-                | ((UINT32)Data[Index2 + 3]);
+  for (; BlockNb > 0; --BlockNb, Data += SHA256_BLOCK_SIZE) {
+    for (Index1 = 0, Index2 = 0; Index1 < 16; Index1++, Index2 += 4) {
+      M[Index1] = ((UINT32)Data[Index2] << 24)
+                  | ((UINT32)Data[Index2 + 1] << 16)
+                  | ((UINT32)Data[Index2 + 2] << 8)
+                  | ((UINT32)Data[Index2 + 3]);
+    }
+
+    for ( ; Index1 < 64; ++Index1) {
+      M[Index1] = SHA256_SIG1 (M[Index1 - 2]) + M[Index1 - 7]
+        + SHA256_SIG0 (M[Index1 - 15]) + M[Index1 - 16];
+    }
+
+    A = State[0];
+    B = State[1];
+    C = State[2];
+    D = State[3];
+    E = State[4];
+    F = State[5];
+    G = State[6];
+    H = State[7];
+
+    for (Index1 = 0; Index1 < 64; ++Index1) {
+      T1 = H + SHA256_EP1 (E) + CH (E, F, G) + gOcSha256K[Index1] + M[Index1];
+      T2 = SHA256_EP0 (A) + MAJ (A, B, C);
+      H = G;
+      G = F;
+      F = E;
+      E = D + T1;
+      D = C;
+      C = B;
+      B = A;
+      A = T1 + T2;
+    }
+
+    State[0] += A;
+    State[1] += B;
+    State[2] += C;
+    State[3] += D;
+    State[4] += E;
+    State[5] += F;
+    State[6] += G;
+    State[7] += H;
   }
+}
 
-  for ( ; Index1 < 64; ++Index1) {
-    M[Index1] = SHA256_SIG1 (M[Index1 - 2]) + M[Index1 - 7]
-      + SHA256_SIG0 (M[Index1 - 15]) + M[Index1 - 16];
+BOOLEAN
+Sha256SetBackend (
+  IN OC_SHA256_BACKEND  Backend
+  )
+{
+  if (Backend == OcSha256BackendAuto) {
+    if (InternalSha256ShaNiSupported ()) {
+      Backend = OcSha256BackendShaNi;
+    } else if (InternalSha256MultiSupported ()) {
+      Backend = OcSha256BackendMultiBuffer;
+    } else {
+      Backend = OcSha256BackendGeneric;
+    }
+  } else if (Backend == OcSha256BackendShaNi) {
+    if (!InternalSha256ShaNiSupported ()) {
+      return FALSE;
+    }
+  } else if (Backend == OcSha256BackendMultiBuffer) {
+    if (!InternalSha256MultiSupported ()) {
+      return FALSE;
+    }
+  } else if (Backend != OcSha256BackendGeneric) {
+    return FALSE;
   }
 
-  A = Context->State[0];
-  B = Context->State[1];
-  C = Context->State[2];
-  D = Context->State[3];
-  E = Context->State[4];
-  F = Context->State[5];
-  G = Context->State[6];
-  H = Context->State[7];
-
-  for (Index1 = 0; Index1 < 64; ++Index1) {
-    T1 = H + SHA256_EP1 (E) + CH (E, F, G) + SHA256_K[Index1] + M[Index1];
-    T2 = SHA256_EP0 (A) + MAJ (A, B, C);
-    H = G;
-    G = F;
-    F = E;
-    E = D + T1;
-    D = C;
-    C = B;
-    B = A;
-    A = T1 + T2;
+  mSha256Backend = Backend;
+  return TRUE;
+}
+
+OC_SHA256_BACKEND
+Sha256GetBackend (
+  VOID
+  )
+{
+  if (mSha256Backend == OcSha256BackendAuto) {
+    Sha256SetBackend (OcSha256BackendAuto);
   }
 
-  Context->State[0] += A;
-  Context->State[1] += B;
-  Context->State[2] += C;
-  Context->State[3] += D;
-  Context->State[4] += E;
-  Context->State[5] += F;
-  Context->State[6] += G;
-  Context->State[7] += H;
+  return mSha256Backend;
+}
+
+STATIC
+VOID
+InternalSha256Blocks (
+  IN OUT UINT32       *State,
+  IN     CONST UINT8  *Data,
+  IN     UINTN        BlockNb
+  )
+{
+  if (Sha256GetBackend () == OcSha256BackendShaNi) {
+    InternalSha256BlocksShaNi (State, Data, BlockNb);
+  } else {
+    InternalSha256BlocksGeneric (State, Data, BlockNb);
+  }
 }
 
 VOID
@@ -239,13 +305,30 @@ Sha256Update (
   UINTN          Len
   )
 {
-  UINT32 Index;
+  UINTN  BlockNb;
+  UINTN  CopyLen;
+
+  while (Len > 0) {
+    //
+    // Process whole blocks directly from the caller buffer.
+    //
+    if (Context->DataLen == 0 && Len >= SHA256_BLOCK_SIZE) {
+      BlockNb = Len / SHA256_BLOCK_SIZE;
+      InternalSha256Blocks (Context->State, Data, BlockNb);
+      Context->BitLen += LShiftU64 (BlockNb, 9);
+      Data += BlockNb * SHA256_BLOCK_SIZE;
+      Len  -= BlockNb * SHA256_BLOCK_SIZE;
+      continue;
+    }
+
+    CopyLen = MIN (Len, SHA256_BLOCK_SIZE - Context->DataLen);
+    CopyMem (&Context->Data[Context->DataLen], Data, CopyLen);
+    Context->DataLen += (UINT32) CopyLen;
+    Data += CopyLen;
+    Len  -= CopyLen;
 
-  for (Index = 0; Index < Len; ++Index) {
-    Context->Data[Context->DataLen] = Data[Index];
-    Context->DataLen++;
-    if (Context->DataLen == 64) {
-      Sha256Transform (Context, Context->Data);
+    if (Context->DataLen == SHA256_BLOCK_SIZE) {
+      InternalSha256Blocks (Context->State, Context->Data, 1);
       Context->BitLen += 512;
       Context->DataLen = 0;
     }
@@ -271,7 +354,7 @@ Sha256Final (
   } else {
     Context->Data[Index++] = 0x80;
     ZeroMem (Context->Data + Index, 64-Index);
-    Sha256Transform (Context, Context->Data);
+    InternalSha256Blocks (Context->State, Context->Data, 1);
     ZeroMem (Context->Data, 56);
   }
 
@@ -287,7 +370,7 @@ Sha256Final (
   Context->Data[58] = (UINT8) (Context->BitLen >> 40);
   Context->Data[57] = (UINT8) (Context->BitLen >> 48);
   Context->Data[56] = (UINT8) (Context->BitLen >> 56);
-  Sha256Transform (Context, Context->Data);
+  InternalSha256Blocks (Context->State, Context->Data, 1);
 
   //
   // Since this implementation uses little endian byte ordering and SHA uses big endian,
@@ -320,6 +403,66 @@ Sha256 (
   ZeroMem (&Ctx, sizeof (Ctx));
 }
 
+VOID
+Sha256Multi (
+  OUT UINT8        *Hashes,
+  IN  CONST UINT8  **Data,
+  IN  CONST UINTN  *Lengths,
+  IN  UINTN        Count
+  )
+{
+  SHA256_CONTEXT  Ctx;
+  UINT32          State[SHA256_MULTI_LANES][8];
+  CONST UINT8     *LaneData[SHA256_MULTI_LANES];
+  UINTN           Lanes;
+  UINTN           BlockNb;
+  UINTN           Size;
+  UINTN           Index;
+  UINTN           Index2;
+
+  for (Index = 0; Index < Count; Index += Lanes) {
+    Lanes = MIN (Count - Index, SHA256_MULTI_LANES);
+
+    if (Lanes == 1 || Sha256GetBackend () != OcSha256BackendMultiBuffer) {
+      for (Index2 = 0; Index2 < Lanes; ++Index2) {
+        Sha256 (
+          &Hashes[(Index + Index2) * SHA256_DIGEST_SIZE],
+          Data[Index + Index2],
+          Lengths[Index + Index2]
+          );
+      }
+      continue;
+    }
+
+    //
+    // Hash the common amount of whole blocks in parallel. Unused lanes
+    // duplicate the first one and their results are discarded.
+    //
+    BlockNb = MAX_UINTN;
+    for (Index2 = 0; Index2 < SHA256_MULTI_LANES; ++Index2) {
+      LaneData[Index2] = Data[Index + (Index2 < Lanes ? Index2 : 0)];
+      CopyMem (State[Index2], SHA256_H0, sizeof (State[Index2]));
+      if (Index2 < Lanes) {
+        BlockNb = MIN (BlockNb, Lengths[Index + Index2] / SHA256_BLOCK_SIZE);
+      }
+    }
+
+    InternalSha256BlocksMulti (State, LaneData, BlockNb);
+
+    Size = BlockNb * SHA256_BLOCK_SIZE;
+    for (Index2 = 0; Index2 < Lanes; ++Index2) {
+      CopyMem (Ctx.State, State[Index2], sizeof (Ctx.State));
+      Ctx.DataLen = 0;
+      Ctx.BitLen  = LShiftU64 (BlockNb, 9);
+      Sha256Update (&Ctx, LaneData[Index2] + Size, Lengths[Index + Index2] - Size);
+      Sha256Final (&Ctx, &Hashes[(Index + Index2) * SHA256_DIGEST_SIZE]);
+    }
+  }
+
+  ZeroMem (&Ctx, sizeof (Ctx));
+  ZeroMem (State, sizeof (State));
+}
+
 
 //
 // Sha 512 functions
@@ -0,0 +1,157 @@
+/** @file
+  Multi-buffer SHA-256 implementation hashing several independent buffers
+  at once, one per vector lane.
+
+  Copyright (C) 2026, agent. All rights reserved.
+
+This program and the accompanying materials
+are licensed and made available under the terms and conditions of the BSD License
+which accompanies this distribution.  The full text of the license may be found at
+http://opensource.org/licenses/bsd-license.php
+
+THE PROGRAM IS DISTRIBUTED UNDER THE BSD LICENSE ON AN "AS IS" BASIS,
+WITHOUT WARRANTIES OR REPRESENTATIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED.
+
+**/
+
+#include <Base.h>
+
+#include <Library/OcCryptoLib.h>
+
+#include "Sha2Internal.h"
+
+//
+// Vector extensions are available in GCC and Clang. SSE2 is architectural
+// on X64 and is always usable in UEFI, while IA32 firmwares may not
+// enable it.
+//
+#if defined (MDE_CPU_X64) && defined (__GNUC__)
+  #define OC_SHA256_VECTOR
+#endif
+
+#ifdef OC_SHA256_VECTOR
+
+typedef UINT32 OC_SHA256_VEC __attribute__ ((vector_size (16)));
+
+#define VROTR(x, n) (((x) >> (n)) | ((x) << (32 - (n))))
+
+#define VCH(x, y, z)  (((x) & (y)) ^ (~(x) & (z)))
+#define VMAJ(x, y, z) (((x) & (y)) ^ ((x) & (z)) ^ ((y) & (z)))
+
+#define VEP0(x)  (VROTR (x, 2)  ^ VROTR (x, 13) ^ VROTR (x, 22))
+#define VEP1(x)  (VROTR (x, 6)  ^ VROTR (x, 11) ^ VROTR (x, 25))
+#define VSIG0(x) (VROTR (x, 7)  ^ VROTR (x, 18) ^ ((x) >> 3))
+#define VSIG1(x) (VROTR (x, 17) ^ VROTR (x, 19) ^ ((x) >> 10))
+
+#define LOAD32_BE(p) (((UINT32) (p)[0] << 24) | ((UINT32) (p)[1] << 16) \
+  | ((UINT32) (p)[2] << 8) | (UINT32) (p)[3])
+
+BOOLEAN
+InternalSha256MultiSupported (
+  VOID
+  )
+{
+  return TRUE;
+}
+
+__attribute__ ((target ("sse2")))
+VOID
+InternalSha256BlocksMulti (
+  IN OUT UINT32       State[SHA256_MULTI_LANES][8],
+  IN     CONST UINT8  *Data[SHA256_MULTI_LANES],
+  IN     UINTN        BlockNb
+  )
+{
+  OC_SHA256_VEC  Wv[8];
+  OC_SHA256_VEC  W[16];
+  OC_SHA256_VEC  A, B, C, D, E, F, G, H;
+  OC_SHA256_VEC  T1;
+  OC_SHA256_VEC  T2;
+  UINTN          Offset;
+  UINTN          Index;
+  UINTN          Index2;
+
+  for (Index = 0; Index < 8; ++Index) {
+    Wv[Index] = (OC_SHA256_VEC) {
+      State[0][Index], State[1][Index], State[2][Index], State[3][Index]
+    };
+  }
+
+  for (Offset = 0; Offset < BlockNb * SHA256_BLOCK_SIZE; Offset += SHA256_BLOCK_SIZE) {
+    A = Wv[0];
+    B = Wv[1];
+    C = Wv[2];
+    D = Wv[3];
+    E = Wv[4];
+    F = Wv[5];
+    G = Wv[6];
+    H = Wv[7];
+
+    for (Index = 0; Index < 64; ++Index) {
+      Index2 = Index & 15U;
+      if (Index < 16) {
+        W[Index2] = (OC_SHA256_VEC) {
+          LOAD32_BE (&Data[0][Offset + Index * 4]),
+          LOAD32_BE (&Data[1][Offset + Index * 4]),
+          LOAD32_BE (&Data[2][Offset + Index * 4]),
+          LOAD32_BE (&Data[3][Offset + Index * 4])
+        };
+      } else {
+        W[Index2] += VSIG1 (W[(Index - 2) & 15U]) + W[(Index - 7) & 15U]
+          + VSIG0 (W[(Index - 15) & 15U]);
+      }
+
+      T1 = H + VEP1 (E) + VCH (E, F, G) + gOcSha256K[Index] + W[Index2];
+      T2 = VEP0 (A) + VMAJ (A, B, C);
+      H = G;
+      G = F;
+      F = E;
+      E = D + T1;
+      D = C;
+      C = B;
+      B = A;
+      A = T1 + T2;
+    }
+
+    Wv[0] += A;
+    Wv[1] += B;
+    Wv[2] += C;
+    Wv[3] += D;
+    Wv[4] += E;
+    Wv[5] += F;
+    Wv[6] += G;
+    Wv[7] += H;
+  }
+
+  for (Index = 0; Index < 8; ++Index) {
+    for (Index2 = 0; Index2 < SHA256_MULTI_LANES; ++Index2) {
+      State[Index2][Index] = Wv[Index][Index2];
+    }
+  }
+}
+
+#else // OC_SHA256_VECTOR
+
+BOOLEAN
+InternalSha256MultiSupported (
+  VOID
+  )
+{
+  return FALSE;
+}
+
+VOID
+InternalSha256BlocksMulti (
+  IN OUT UINT32       State[SHA256_MULTI_LANES][8],
+  IN     CONST UINT8  *Data[SHA256_MULTI_LANES],
+  IN     UINTN        BlockNb
+  )
+{
+  UINTN  Index;
+
+  for (Index = 0; Index < SHA256_MULTI_LANES; ++Index) {
+    InternalSha256BlocksGeneric (State[Index], Data[Index], BlockNb);
+  }
+}
+
+#endif // OC_SHA256_VECTOR
@@ -0,0 +1,89 @@
+/** @file
+  Copyright (C) 2026, agent. All rights reserved.
+
+This program and the accompanying materials
+are licensed and made available under the terms and conditions of the BSD License
+which accompanies this distribution.  The full text of the license may be found at
+http://opensource.org/licenses/bsd-license.php
+
+THE PROGRAM IS DISTRIBUTED UNDER THE BSD LICENSE ON AN "AS IS" BASIS,
+WITHOUT WARRANTIES OR REPRESENTATIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED.
+
+**/
+
+#ifndef SHA2_INTERNAL_H
+#define SHA2_INTERNAL_H
+
+#include <Library/OcCryptoLib.h>
+
+//
+// SHA-256 round constants.
+//
+extern CONST UINT32 gOcSha256K[64];
+
+/**
+  Process whole SHA-256 blocks with the portable implementation.
+
+  @param[in,out] State    SHA-256 state to update.
+  @param[in]     Data     Data to process, BlockNb * SHA256_BLOCK_SIZE bytes.
+  @param[in]     BlockNb  Number of blocks to process.
+**/
+VOID
+InternalSha256BlocksGeneric (
+  IN OUT UINT32       *State,
+  IN     CONST UINT8  *Data,
+  IN     UINTN        BlockNb
+  );
+
+/**
+  Check whether SHA extensions are usable on the current CPU.
+
+  @retval TRUE when InternalSha256BlocksShaNi may be called.
+**/
+BOOLEAN
+InternalSha256ShaNiSupported (
+  VOID
+  );
+
+/**
+  Process whole SHA-256 blocks with SHA extensions.
+
+  @param[in,out] State    SHA-256 state to update.
+  @param[in]     Data     Data to process, BlockNb * SHA256_BLOCK_SIZE bytes.
+  @param[in]     BlockNb  Number of blocks to process.
+**/
+VOID
+InternalSha256BlocksShaNi (
+  IN OUT UINT32       *State,
+  IN     CONST UINT8  *Data,
+  IN     UINTN        BlockNb
+  );
+
+/**
+  Check whether the multi-buffer implementation runs on vector units.
+
+  @retval TRUE when InternalSha256BlocksMulti is faster than hashing
+          each buffer separately with the portable implementation.
+**/
+BOOLEAN
+InternalSha256MultiSupported (
+  VOID
+  );
+
+/**
+  Process whole SHA-256 blocks of SHA256_MULTI_LANES independent
+  buffers in parallel.
+
+  @param[in,out] State    SHA-256 states to update, one per lane.
+  @param[in]     Data     Data to process, one pointer per lane,
+                          each BlockNb * SHA256_BLOCK_SIZE bytes.
+  @param[in]     BlockNb  Number of blocks to process in every lane.
+**/
+VOID
+InternalSha256BlocksMulti (
+  IN OUT UINT32       State[SHA256_MULTI_LANES][8],
+  IN     CONST UINT8  *Data[SHA256_MULTI_LANES],
+  IN     UINTN        BlockNb
+  );
+
+#endif // SHA2_INTERNAL_H
@@ -0,0 +1,312 @@
+/** @file
+  SHA-256 implementation using Intel SHA extensions.
+
+  Copyright (C) 2026, agent. All rights reserved.
+
+This program and the accompanying materials
+are licensed and made available under the terms and conditions of the BSD License
+which accompanies this distribution.  The full text of the license may be found at
+http://opensource.org/licenses/bsd-license.php
+
+THE PROGRAM IS DISTRIBUTED UNDER THE BSD LICENSE ON AN "AS IS" BASIS,
+WITHOUT WARRANTIES OR REPRESENTATIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED.
+
+**/
+#include <Base.h>
+
+#include <Library/BaseLib.h>
+#include <Library/DebugLib.h>
+#include <Register/Intel/Cpuid.h>
+
+#include "../Sha2Internal.h"
+
+//
+// CPUID.(EAX=07H,ECX=0):EBX.SHA[bit 29].
+//
+#define SHA256_NI_CPUID_SHA  BIT29
+
+#if defined(__GNUC__)
+
+//
+// Register allocation. SHA256RNDS2 implicitly uses XMM0 for the message
+// and round constants sum.
+//
+#define SHA256_NI_TMP0  "%%xmm3"
+#define SHA256_NI_TMP1  "%%xmm4"
+#define SHA256_NI_TMP2  "%%xmm5"
+#define SHA256_NI_TMP3  "%%xmm6"
+
+//
+// Load and byte swap message dwords for the rounds in Group.
+//
+#define SHA256_NI_LOAD(Group, Tmp)                \
+  "movdqu " #Group "*16(%[Data]), %%xmm0\n\t"     \
+  "pshufb %%xmm8, %%xmm0\n\t"                     \
+  "movdqa %%xmm0, " Tmp "\n\t"
+
+//
+// Perform the first two rounds of Group, XMM1 is ABEF, XMM2 is CDGH.
+//
+#define SHA256_NI_ROUNDS_LO(Group, Tmp)           \
+  "movdqa " Tmp ", %%xmm0\n\t"                    \
+  "movdqu " #Group "*16(%[K]), %%xmm11\n\t"       \
+  "paddd %%xmm11, %%xmm0\n\t"                     \
+  "sha256rnds2 %%xmm1, %%xmm2\n\t"
+
+//
+// Perform the last two rounds of the current group.
+//
+#define SHA256_NI_ROUNDS_HI                       \
+  "pshufd $0x0E, %%xmm0, %%xmm0\n\t"              \
+  "sha256rnds2 %%xmm2, %%xmm1\n\t"
+
+//
+// Finish message schedule of Next group from Cur and Prev groups.
+//
+#define SHA256_NI_MSG2(Cur, Prev, Next)           \
+  "movdqa " Cur ", %%xmm7\n\t"                    \
+  "palignr $4, " Prev ", %%xmm7\n\t"              \
+  "paddd %%xmm7, " Next "\n\t"                    \
+  "sha256msg2 " Cur ", " Next "\n\t"
+
+//
+// Start message schedule in Prev group from Cur group.
+//
+#define SHA256_NI_MSG1(Cur, Prev)                 \
+  "sha256msg1 " Cur ", " Prev "\n\t"
+
+//
+// Swaps bytes in every dword.
+//
+STATIC CONST UINT8 mSha256NiShuffleMask[16] = {
+  3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12
+};
+
+BOOLEAN
+InternalSha256ShaNiSupported (
+  VOID
+  )
+{
+  UINT32                  MaxLeaf;
+  UINT32                  Ebx;
+  CPUID_VERSION_INFO_ECX  Ecx;
+
+  AsmCpuid (CPUID_SIGNATURE, &MaxLeaf, NULL, NULL, NULL);
+  if (MaxLeaf < CPUID_STRUCTURED_EXTENDED_FEATURE_FLAGS) {
+    return FALSE;
+  }
+
+  AsmCpuid (CPUID_VERSION_INFO, NULL, NULL, &Ecx.Uint32, NULL);
+  if (Ecx.Bits.SSSE3 == 0 || Ecx.Bits.SSE4_1 == 0) {
+    return FALSE;
+  }
+
+  AsmCpuidEx (
+    CPUID_STRUCTURED_EXTENDED_FEATURE_FLAGS,
+    CPUID_STRUCTURED_EXTENDED_FEATURE_FLAGS_SUB_LEAF_INFO,
+    NULL,
+    &Ebx,
+    NULL,
+    NULL
+    );
+
+  return (Ebx & SHA256_NI_CPUID_SHA) != 0;
+}
+
+//
+// Allow XMM registers in the assembly below regardless of the toolchain
+// floating point settings.
+//
+__attribute__ ((target ("sse4.1,sha")))
+VOID
+InternalSha256BlocksShaNi (
+  IN OUT UINT32       *State,
+  IN     CONST UINT8  *Data,
+  IN     UINTN        BlockNb
+  )
+{
+  CONST UINT8  *End;
+
+  if (BlockNb == 0) {
+    return;
+  }
+
+  End = Data + BlockNb * SHA256_BLOCK_SIZE;
+
+  __asm__ __volatile__ (
+    //
+    // Convert ABCD EFGH state into ABEF CDGH layout.
+    //
+    "movdqu (%[State]), %%xmm1\n\t"
+    "movdqu 16(%[State]), %%xmm2\n\t"
+    "movdqu (%[Mask]), %%xmm8\n\t"
+    "pshufd $0xB1, %%xmm1, %%xmm1\n\t"
+    "pshufd $0x1B, %%xmm2, %%xmm2\n\t"
+    "movdqa %%xmm1, %%xmm7\n\t"
+    "palignr $8, %%xmm2, %%xmm1\n\t"
+    "pblendw $0xF0, %%xmm7, %%xmm2\n\t"
+
+    "1:\n\t"
+    "movdqa %%xmm1, %%xmm9\n\t"
+    "movdqa %%xmm2, %%xmm10\n\t"
+
+    //
+    // Rounds 0-3.
+    //
+    SHA256_NI_LOAD (0, SHA256_NI_TMP0)
+    SHA256_NI_ROUNDS_LO (0, SHA256_NI_TMP0)
+    SHA256_NI_ROUNDS_HI
+    //
+    // Rounds 4-7.
+    //
+    SHA256_NI_LOAD (1, SHA256_NI_TMP1)
+    SHA256_NI_ROUNDS_LO (1, SHA256_NI_TMP1)
+    SHA256_NI_ROUNDS_HI
+    SHA256_NI_MSG1 (SHA256_NI_TMP1, SHA256_NI_TMP0)
+    //
+    // Rounds 8-11.
+    //
+    SHA256_NI_LOAD (2, SHA256_NI_TMP2)
+    SHA256_NI_ROUNDS_LO (2, SHA256_NI_TMP2)
+    SHA256_NI_ROUNDS_HI
+    SHA256_NI_MSG1 (SHA256_NI_TMP2, SHA256_NI_TMP1)
+    //
+    // Rounds 12-15.
+    //
+    SHA256_NI_LOAD (3, SHA256_NI_TMP3)
+    SHA256_NI_ROUNDS_LO (3, SHA256_NI_TMP3)
+    SHA256_NI_MSG2 (SHA256_NI_TMP3, SHA256_NI_TMP2, SHA256_NI_TMP0)
+    SHA256_NI_ROUNDS_HI
+    SHA256_NI_MSG1 (SHA256_NI_TMP3, SHA256_NI_TMP2)
+    //
+    // Rounds 16-19.
+    //
+    SHA256_NI_ROUNDS_LO (4, SHA256_NI_TMP0)
+    SHA256_NI_MSG2 (SHA256_NI_TMP0, SHA256_NI_TMP3, SHA256_NI_TMP1)
+    SHA256_NI_ROUNDS_HI
+    SHA256_NI_MSG1 (SHA256_NI_TMP0, SHA256_NI_TMP3)
+    //
+    // Rounds 20-23.
+    //
+    SHA256_NI_ROUNDS_LO (5, SHA256_NI_TMP1)
+    SHA256_NI_MSG2 (SHA256_NI_TMP1, SHA256_NI_TMP0, SHA256_NI_TMP2)
+    SHA256_NI_ROUNDS_HI
+    SHA256_NI_MSG1 (SHA256_NI_TMP1, SHA256_NI_TMP0)
+    //
+    // Rounds 24-27.
+    //
+    SHA256_NI_ROUNDS_LO (6, SHA256_NI_TMP2)
+    SHA256_NI_MSG2 (SHA256_NI_TMP2, SHA256_NI_TMP1, SHA256_NI_TMP3)
+    SHA256_NI_ROUNDS_HI
+    SHA256_NI_MSG1 (SHA256_NI_TMP2, SHA256_NI_TMP1)
+    //
+    // Rounds 28-31.
+    //
+    SHA256_NI_ROUNDS_LO (7, SHA256_NI_TMP3)
+    SHA256_NI_MSG2 (SHA256_NI_TMP3, SHA256_NI_TMP2, SHA256_NI_TMP0)
+    SHA256_NI_ROUNDS_HI
+    SHA256_NI_MSG1 (SHA256_NI_TMP3, SHA256_NI_TMP2)
+    //
+    // Rounds 32-35.
+    //
+    SHA256_NI_ROUNDS_LO (8, SHA256_NI_TMP0)
+    SHA256_NI_MSG2 (SHA256_NI_TMP0, SHA256_NI_TMP3, SHA256_NI_TMP1)
+    SHA256_NI_ROUNDS_HI
+    SHA256_NI_MSG1 (SHA256_NI_TMP0, SHA256_NI_TMP3)
+    //
+    // Rounds 36-39.
+    //
+    SHA256_NI_ROUNDS_LO (9, SHA256_NI_TMP1)
+    SHA256_NI_MSG2 (SHA256_NI_TMP1, SHA256_NI_TMP0, SHA256_NI_TMP2)
+    SHA256_NI_ROUNDS_HI
+    SHA256_NI_MSG1 (SHA256_NI_TMP1, SHA256_NI_TMP0)
+    //
+    // Rounds 40-43.
+    //
+    SHA256_NI_ROUNDS_LO (10, SHA256_NI_TMP2)
+    SHA256_NI_MSG2 (SHA256_NI_TMP2, SHA256_NI_TMP1, SHA256_NI_TMP3)
+    SHA256_NI_ROUNDS_HI
+    SHA256_NI_MSG1 (SHA256_NI_TMP2, SHA256_NI_TMP1)
+    //
+    // Rounds 44-47.
+    //
+    SHA256_NI_ROUNDS_LO (11, SHA256_NI_TMP3)
+    SHA256_NI_MSG2 (SHA256_NI_TMP3, SHA256_NI_TMP2, SHA256_NI_TMP0)
+    SHA256_NI_ROUNDS_HI
+    SHA256_NI_MSG1 (SHA256_NI_TMP3, SHA256_NI_TMP2)
+    //
+    // Rounds 48-51.
+    //
+    SHA256_NI_ROUNDS_LO (12, SHA256_NI_TMP0)
+    SHA256_NI_MSG2 (SHA256_NI_TMP0, SHA256_NI_TMP3, SHA256_NI_TMP1)
+    SHA256_NI_ROUNDS_HI
+    SHA256_NI_MSG1 (SHA256_NI_TMP0, SHA256_NI_TMP3)
+    //
+    // Rounds 52-55.
+    //
+    SHA256_NI_ROUNDS_LO (13, SHA256_NI_TMP1)
+    SHA256_NI_MSG2 (SHA256_NI_TMP1, SHA256_NI_TMP0, SHA256_NI_TMP2)
+    SHA256_NI_ROUNDS_HI
+    //
+    // Rounds 56-59.
+    //
+    SHA256_NI_ROUNDS_LO (14, SHA256_NI_TMP2)
+    SHA256_NI_MSG2 (SHA256_NI_TMP2, SHA256_NI_TMP1, SHA256_NI_TMP3)
+    SHA256_NI_ROUNDS_HI
+    //
+    // Rounds 60-63.
+    //
+    SHA256_NI_ROUNDS_LO (15, SHA256_NI_TMP3)
+    SHA256_NI_ROUNDS_HI
+    "paddd %%xmm9, %%xmm1\n\t"
+    "paddd %%xmm10, %%xmm2\n\t"
+    "add $64, %[Data]\n\t"
+    "cmp %[End], %[Data]\n\t"
+    "jne 1b\n\t"
+
+    //
+    // Convert ABEF CDGH layout back into ABCD EFGH state.
+    //
+    "pshufd $0x1B, %%xmm1, %%xmm1\n\t"
+    "pshufd $0xB1, %%xmm2, %%xmm2\n\t"
+    "movdqa %%xmm1, %%xmm7\n\t"
+    "pblendw $0xF0, %%xmm2, %%xmm1\n\t"
+    "palignr $8, %%xmm7, %%xmm2\n\t"
+    "movdqu %%xmm1, (%[State])\n\t"
+    "movdqu %%xmm2, 16(%[State])\n\t"
+    : [Data]  "+r" (Data)
+    : [State] "r" (State),
+      [End]   "r" (End),
+      [K]     "r" (gOcSha256K),
+      [Mask]  "r" (mSha256NiShuffleMask)
+    : "xmm0", "xmm1", "xmm2", "xmm3", "xmm4", "xmm5", "xmm6", "xmm7",
+      "xmm8", "xmm9", "xmm10", "xmm11", "cc", "memory"
+    );
+}
+
+#else
+
+//
+// MSVC has no inline assembly on X64, use the portable implementation.
+//
+
+BOOLEAN
+InternalSha256ShaNiSupported (
+  VOID
+  )
+{
+  return FALSE;
+}
+
+VOID
+InternalSha256BlocksShaNi (
+  IN OUT UINT32       *State,
+  IN     CONST UINT8  *Data,
+  IN     UINTN        BlockNb
+  )
+{
+  ASSERT (FALSE);
+  InternalSha256BlocksGeneric (State, Data, BlockNb);
+}
+
+#endif
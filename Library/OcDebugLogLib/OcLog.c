@@ -139,6 +139,249 @@ GetLogPath (
   return LogPath;
 }
 
+STATIC
+EFI_STATUS
+OcLogAppendBuffer (
+  IN OUT OC_LOG_PRIVATE_DATA  *Private,
+  IN     CONST CHAR8          *Timing,
+  IN     UINTN                TimingLength,
+  IN     CONST CHAR8          *Line,
+  IN     UINTN                LineLength
+  )
+{
+  UINTN  Length;
+
+  //
+  // Track the buffer tail to avoid rescanning the whole log for every line.
+  //
+  Length = Private->AsciiBufferLength;
+  if (Private->AsciiBufferSize - Length <= TimingLength + LineLength) {
+    return EFI_BUFFER_TOO_SMALL;
+  }
+
+  CopyMem (&Private->AsciiBuffer[Length], Timing, TimingLength);
+  Length += TimingLength;
+  CopyMem (&Private->AsciiBuffer[Length], Line, LineLength);
+  Length += LineLength;
+  Private->AsciiBuffer[Length] = '\0';
+
+  Private->AsciiBufferLength = Length;
+  return EFI_SUCCESS;
+}
+
+STATIC
+VOID
+OcLogFlushFile (
+  IN OUT OC_LOG_PRIVATE_DATA  *Private,
+  IN     BOOLEAN              Sync
+  )
+{
+  EFI_STATUS  Status;
+  UINTN       Length;
+  UINTN       WrittenSize;
+
+  //
+  // Must be called at TPL_CALLBACK or lower. Avoid recursion when
+  // the file system driver logs something while we write.
+  //
+  if ((Private->OcLog.Options & OC_LOG_FILE) == 0
+    || Private->OcLog.FileSystem == NULL
+    || Private->FileFlushing) {
+    return;
+  }
+
+  Length = Private->AsciiBufferLength;
+  if (Length == Private->FileFlushedLength
+    && (!Sync || !Private->FileSyncPending)) {
+    return;
+  }
+
+  Private->FileFlushing = TRUE;
+
+  if (Private->LogFile != NULL && Length > Private->FileFlushedLength) {
+    //
+    // Append only the data written since the last flush.
+    //
+    Status = Private->LogFile->SetPosition (Private->LogFile, Private->FileFlushedLength);
+    if (!EFI_ERROR (Status)) {
+      WrittenSize = Length - Private->FileFlushedLength;
+      Status = Private->LogFile->Write (
+        Private->LogFile,
+        &WrittenSize,
+        &Private->AsciiBuffer[Private->FileFlushedLength]
+        );
+      if (!EFI_ERROR (Status) && WrittenSize != Length - Private->FileFlushedLength) {
+        Status = EFI_BAD_BUFFER_SIZE;
+      }
+    }
+
+    if (!EFI_ERROR (Status)) {
+      Private->FileFlushedLength = Length;
+      Private->FileSyncPending   = TRUE;
+    } else {
+      //
+      // Fallback to complete rewrites should appending fail.
+      //
+      Private->LogFile->Close (Private->LogFile);
+      Private->LogFile = NULL;
+    }
+  }
+
+  if (Private->LogFile != NULL) {
+    if (Sync && Private->FileSyncPending) {
+      Private->LogFile->Flush (Private->LogFile);
+      Private->FileSyncPending = FALSE;
+    }
+  } else {
+    //
+    // Always overwriting file completely is most reliable.
+    // I know it is slow, but fixed size write is more reliable with broken FAT32 driver.
+    //
+    SetFileData (
+      Private->OcLog.FileSystem,
+      Private->OcLog.FilePath,
+      Private->AsciiBuffer,
+      (UINT32) Private->AsciiBufferSize
+      );
+    Private->FileFlushedLength = Length;
+  }
+
+  ++Private->FileFlushCount;
+  Private->FileFlushing = FALSE;
+}
+
+STATIC
+VOID
+OcLogFlushNvram (
+  IN OUT OC_LOG_PRIVATE_DATA  *Private
+  )
+{
+  EFI_STATUS  Status;
+  UINT32      Attributes;
+
+  if (Private->NvramPendingLines == 0) {
+    return;
+  }
+
+  if ((Private->OcLog.Options & (OC_LOG_VARIABLE | OC_LOG_NONVOLATILE)) == 0) {
+    Private->NvramPendingLines = 0;
+    Private->NvramPendingBytes = 0;
+    return;
+  }
+
+  Attributes = EFI_VARIABLE_BOOTSERVICE_ACCESS | EFI_VARIABLE_RUNTIME_ACCESS;
+  if ((Private->OcLog.Options & OC_LOG_NONVOLATILE) != 0) {
+    Attributes |= EFI_VARIABLE_NON_VOLATILE;
+  }
+
+  Status = gRT->SetVariable (
+    OC_LOG_VARIABLE_NAME,
+    &gOcVendorVariableGuid,
+    Attributes,
+    Private->NvramBufferLength,
+    Private->NvramBuffer
+    );
+
+  ++Private->NvramWrites;
+  Private->NvramSavedWrites += Private->NvramPendingLines - 1;
+  Private->NvramPendingLines = 0;
+  Private->NvramPendingBytes = 0;
+
+  if (EFI_ERROR (Status)) {
+    //
+    // On APTIO V this may not even get printed. Regardless of volatile or not
+    // it will firstly start discarding NVRAM data silently, and then will borks
+    // NVRAM support completely till reboot. Let's stop on first error at least.
+    //
+    gST->ConOut->OutputString (gST->ConOut, L"NVRAM is full, cannot log!\r\n");
+    gBS->Stall (SECONDS_TO_MICROSECONDS (1));
+    Private->OcLog.Options &= ~(OC_LOG_VARIABLE | OC_LOG_NONVOLATILE);
+  }
+}
+
+STATIC
+VOID
+EFIAPI
+OcLogFlushEvent (
+  IN EFI_EVENT  Event,
+  IN VOID       *Context
+  )
+{
+  OcLogFlushNvram (Context);
+  OcLogFlushFile (Context, TRUE);
+}
+
+STATIC
+VOID
+OcLogReportFileStats (
+  IN OUT OC_LOG_PRIVATE_DATA  *Private
+  )
+{
+  UINT64  LineTicks;
+  UINT64  LineTime;
+  UINTN   LineLength;
+
+  if ((Private->OcLog.Options & OC_LOG_FILE) == 0 || Private->OcLog.FileSystem == NULL) {
+    return;
+  }
+
+  //
+  // Report file logging cost to simplify performance analysis.
+  //
+  LineTicks = 0;
+  LineTime  = 0;
+  if (Private->FileLineCount > 0) {
+    LineTicks = DivU64x64Remainder (Private->FileLineTicks, Private->FileLineCount, NULL);
+    if (Private->TscFrequency > 0) {
+      LineTime = DivU64x64Remainder (MultU64x32 (LineTicks, 1000000), Private->TscFrequency, NULL);
+    }
+  }
+
+  AsciiSPrint (
+    Private->LineBuffer,
+    sizeof (Private->LineBuffer),
+    "OCL: Logged %Lu lines to file, %Lu ticks (%Lu us) per line, %u flushes, %u/%u NVRAM writes saved\n",
+    Private->FileLineCount,
+    LineTicks,
+    LineTime,
+    Private->FileFlushCount,
+    Private->NvramSavedWrites,
+    Private->NvramWrites + Private->NvramSavedWrites
+    );
+  LineLength = AsciiStrLen (Private->LineBuffer);
+  OcLogAppendBuffer (Private, "", 0, Private->LineBuffer, LineLength);
+}
+
+STATIC
+VOID
+EFIAPI
+OcLogExitBootServices (
+  IN EFI_EVENT  Event,
+  IN VOID       *Context
+  )
+{
+  OC_LOG_PRIVATE_DATA  *Private;
+
+  Private = Context;
+
+  if (Private->FlushEvent != NULL) {
+    gBS->SetTimer (Private->FlushEvent, TimerCancel, 0);
+  }
+
+  //
+  // Commit the lines batched since the last flush, e.g. kernel patching logs
+  // printed while the OS loader ran. Runtime services remain usable here.
+  //
+  OcLogFlushNvram (Private);
+
+  //
+  // File system is no longer usable after ExitBootServices, so the file is
+  // not written past SaveLog called before starting the OS loader.
+  // Without the timer batched variable logging has to commit every line.
+  //
+  Private->OcLog.Options &= ~(OC_LOG_FILE | OC_LOG_VARIABLE_BATCH);
+}
+
 EFI_STATUS
 EFIAPI
 OcLogAddEntry  (
@@ -151,13 +394,15 @@ OcLogAddEntry  (
   EFI_STATUS                  Status;
 
   OC_LOG_PRIVATE_DATA         *Private;
-  UINT32                      Attributes;
   UINT32                      TimingLength;
   UINT32                      LineLength;
   APPLE_PLATFORM_DATA_RECORD  *Entry;
   UINT32                      KeySize;
   UINT32                      DataSize;
   UINT32                      TotalSize;
+  EFI_TPL                     OldTpl;
+  UINT64                      StartTsc;
+  BOOLEAN                     CanFlush;
 
   Private = OC_LOG_PRIVATE_DATA_FROM_OC_LOG_THIS (OcLog);
 
@@ -279,26 +524,44 @@ OcLogAddEntry  (
     //
     // Write to internal buffer.
     //
+    if ((OcLog->Options & OC_LOG_FILE) != 0 && OcLog->FileSystem != NULL
+      && EfiGetCurrentTpl () <= TPL_CALLBACK) {
+      //
+      // Prevent the flush timer from interrupting us while we write.
+      //
+      OldTpl    = gBS->RaiseTPL (TPL_CALLBACK);
+      StartTsc  = AsmReadTsc ();
+
+      Status = OcLogAppendBuffer (
+        Private,
+        Private->TimingTxt,
+        TimingLength,
+        Private->LineBuffer,
+        LineLength
+        );
 
-    Status = AsciiStrCatS (Private->AsciiBuffer, Private->AsciiBufferSize, Private->TimingTxt);
-    if (!EFI_ERROR (Status)) {
-      Status = AsciiStrCatS (Private->AsciiBuffer, Private->AsciiBufferSize, Private->LineBuffer);
-    }
-
-    //
-    // Write to a file.
-    // Always overwriting file completely is most reliable.
-    // I know it is slow, but fixed size write is more reliable with broken FAT32 driver.
-    //
-    if ((OcLog->Options & OC_LOG_FILE) != 0 && OcLog->FileSystem != NULL) {
-      if (EfiGetCurrentTpl () <= TPL_CALLBACK) {
-        SetFileData (
-          OcLog->FileSystem,
-          OcLog->FilePath,
-          Private->AsciiBuffer,
-          (UINT32) Private->AsciiBufferSize
-          );
+      //
+      // Write to a file.
+      // Pending data is written in batches by the timer and on SaveLog,
+      // errors are written right away to preserve them on hangs.
+      //
+      if (Private->FlushEvent == NULL
+        || (ErrorLevel & (DEBUG_ERROR | OcLog->HaltLevel)) != 0
+        || Private->AsciiBufferLength - Private->FileFlushedLength >= OC_LOG_FILE_FLUSH_THRESHOLD) {
+        OcLogFlushFile (Private, (ErrorLevel & (DEBUG_ERROR | OcLog->HaltLevel)) != 0);
       }
+
+      Private->FileLineTicks += AsmReadTsc () - StartTsc;
+      ++Private->FileLineCount;
+      gBS->RestoreTPL (OldTpl);
+    } else {
+      Status = OcLogAppendBuffer (
+        Private,
+        Private->TimingTxt,
+        TimingLength,
+        Private->LineBuffer,
+        LineLength
+        );
     }
 
     //
@@ -309,39 +572,43 @@ OcLogAddEntry  (
       // Do not log timing information to NVRAM, it is already large.
       // This check is here, because Microsoft is retarded and asserts.
       //
-      if (Private->NvramBufferSize - AsciiStrSize (Private->NvramBuffer) >= AsciiStrLen (Private->LineBuffer)) {
-        Status = AsciiStrCatS (Private->NvramBuffer, Private->NvramBufferSize, Private->LineBuffer);
-      } else {
-        Status = EFI_BUFFER_TOO_SMALL;
-      }
-      if (!EFI_ERROR (Status)) {
-        Attributes = EFI_VARIABLE_BOOTSERVICE_ACCESS | EFI_VARIABLE_RUNTIME_ACCESS;
-        if ((OcLog->Options & OC_LOG_NONVOLATILE) != 0) {
-          Attributes |= EFI_VARIABLE_NON_VOLATILE;
+      if (Private->NvramBufferSize - Private->NvramBufferLength > LineLength) {
+        //
+        // Prevent the flush timer from interrupting us while we write.
+        //
+        OldTpl   = EfiGetCurrentTpl ();
+        CanFlush = OldTpl <= TPL_CALLBACK;
+        if (CanFlush) {
+          gBS->RaiseTPL (TPL_CALLBACK);
         }
 
-        Status = gRT->SetVariable (
-          OC_LOG_VARIABLE_NAME,
-          &gOcVendorVariableGuid,
-          Attributes,
-          AsciiStrLen (Private->NvramBuffer),
-          Private->NvramBuffer
-          );
+        CopyMem (&Private->NvramBuffer[Private->NvramBufferLength], Private->LineBuffer, LineLength + 1);
+        Private->NvramBufferLength += LineLength;
+        ++Private->NvramPendingLines;
+        Private->NvramPendingBytes += LineLength;
 
-        if (EFI_ERROR (Status)) {
-          //
-          // On APTIO V this may not even get printed. Regardless of volatile or not
-          // it will firstly start discarding NVRAM data silently, and then will borks
-          // NVRAM support completely till reboot. Let's stop on first error at least.
-          //
-          gST->ConOut->OutputString (gST->ConOut, L"NVRAM is full, cannot log!\r\n");
-          gBS->Stall (SECONDS_TO_MICROSECONDS (1));
-          OcLog->Options &= ~(OC_LOG_VARIABLE | OC_LOG_NONVOLATILE);
+        //
+        // Batched mode commits the variable on timer and SaveLog,
+        // errors and reached thresholds are committed right away.
+        //
+        if ((OcLog->Options & OC_LOG_VARIABLE_BATCH) == 0
+          || Private->FlushEvent == NULL
+          || (ErrorLevel & (DEBUG_ERROR | OcLog->HaltLevel)) != 0
+          || Private->NvramPendingLines >= PcdGet32 (PcdOcLogNvramFlushLines)
+          || Private->NvramPendingBytes >= PcdGet32 (PcdOcLogNvramFlushBytes)) {
+          if (CanFlush || (OcLog->Options & OC_LOG_VARIABLE_BATCH) == 0) {
+            OcLogFlushNvram (Private);
+          }
+        }
+
+        if (CanFlush) {
+          gBS->RestoreTPL (OldTpl);
         }
       } else {
         gST->ConOut->OutputString (gST->ConOut, L"NVRAM log size exceeded, cannot log!\r\n");
         gBS->Stall (SECONDS_TO_MICROSECONDS (1));
         OcLog->Options &= ~(OC_LOG_VARIABLE | OC_LOG_NONVOLATILE);
+        Status = EFI_BUFFER_TOO_SMALL;
       }
     }
   }
@@ -388,7 +655,29 @@ OcLogSaveLog (
   IN EFI_DEVICE_PATH_PROTOCOL  *FilePath OPTIONAL
   )
 {
-  return EFI_NOT_FOUND;
+  OC_LOG_PRIVATE_DATA  *Private;
+  EFI_TPL              OldTpl;
+
+  if (This == NULL || NonVolatile != 0 || FilePath != NULL) {
+    return EFI_UNSUPPORTED;
+  }
+
+  //
+  // File I/O is only allowed up to TPL_CALLBACK.
+  //
+  if (EfiGetCurrentTpl () > TPL_CALLBACK) {
+    return EFI_ACCESS_DENIED;
+  }
+
+  Private = OC_LOG_PRIVATE_DATA_FROM_OC_LOG_THIS (This);
+
+  OldTpl = gBS->RaiseTPL (TPL_CALLBACK);
+  OcLogFlushNvram (Private);
+  OcLogReportFileStats (Private);
+  OcLogFlushFile (Private, TRUE);
+  gBS->RestoreTPL (OldTpl);
+
+  return EFI_SUCCESS;
 }
 
 EFI_STATUS
@@ -435,6 +724,7 @@ OcConfigureLogProtocol (
   )
 {
   EFI_STATUS            Status;
+  EFI_STATUS            FileStatus;
 
   OC_LOG_PROTOCOL       *OcLog;
   OC_LOG_PRIVATE_DATA   *Private;
@@ -483,6 +773,12 @@ OcConfigureLogProtocol (
     // Set desired options in existing protocol.
     //
 
+    Private = OC_LOG_PRIVATE_DATA_FROM_OC_LOG_THIS (OcLog);
+    OcLogFlushNvram (Private);
+    if (Private->LogFile != NULL) {
+      Private->LogFile->Close (Private->LogFile);
+      Private->LogFile = NULL;
+    }
     if (OcLog->FileSystem != NULL) {
       OcLog->FileSystem->Close (OcLog->FileSystem);
     }
@@ -518,6 +814,28 @@ OcConfigureLogProtocol (
       Private->OcLog.FileSystem   = LogRoot;
       Private->OcLog.FilePath     = LogPath;
 
+      Status = gBS->CreateEvent (
+        EVT_TIMER | EVT_NOTIFY_SIGNAL,
+        TPL_CALLBACK,
+        OcLogFlushEvent,
+        Private,
+        &Private->FlushEvent
+        );
+      if (EFI_ERROR (Status)) {
+        Private->FlushEvent = NULL;
+      }
+
+      Status = gBS->CreateEvent (
+        EVT_SIGNAL_EXIT_BOOT_SERVICES,
+        TPL_CALLBACK,
+        OcLogExitBootServices,
+        Private,
+        &Private->ExitBootServicesEvent
+        );
+      if (EFI_ERROR (Status)) {
+        Private->ExitBootServicesEvent = NULL;
+      }
+
       Handle = NULL;
       Status = gBS->InstallProtocolInterface (
         &Handle,
@@ -529,6 +847,12 @@ OcConfigureLogProtocol (
       if (!EFI_ERROR (Status)) {
         OcLog = &Private->OcLog;
       } else {
+        if (Private->FlushEvent != NULL) {
+          gBS->CloseEvent (Private->FlushEvent);
+        }
+        if (Private->ExitBootServicesEvent != NULL) {
+          gBS->CloseEvent (Private->ExitBootServicesEvent);
+        }
         FreePool (Private);
       }
     }
@@ -536,19 +860,56 @@ OcConfigureLogProtocol (
 
   if (LogRoot != NULL) {
     if (!EFI_ERROR (Status)) {
-      if (OC_LOG_PRIVATE_DATA_FROM_OC_LOG_THIS (OcLog)->AsciiBufferSize > 0) {
-        SetFileData (
+      Private = OC_LOG_PRIVATE_DATA_FROM_OC_LOG_THIS (OcLog);
+      Private->FileFlushedLength = 0;
+      Private->FileSyncPending   = FALSE;
+
+      if ((Options & OC_LOG_FILE_APPEND) != 0) {
+        FileStatus = SafeFileOpen (
           LogRoot,
+          &Private->LogFile,
           LogPath,
-          OC_LOG_PRIVATE_DATA_FROM_OC_LOG_THIS (OcLog)->AsciiBuffer,
-          (UINT32) OC_LOG_PRIVATE_DATA_FROM_OC_LOG_THIS (OcLog)->AsciiBufferSize
+          EFI_FILE_MODE_CREATE | EFI_FILE_MODE_READ | EFI_FILE_MODE_WRITE,
+          0
           );
+        if (EFI_ERROR (FileStatus)) {
+          Private->LogFile = NULL;
+        }
       }
+
+      OcLogFlushFile (Private, TRUE);
     } else {
       LogRoot->Close (LogRoot);
       FreePool (LogPath);
     }
   }
 
+  if (OcLog != NULL) {
+    Private = OC_LOG_PRIVATE_DATA_FROM_OC_LOG_THIS (OcLog);
+    if (Private->FlushEvent != NULL) {
+      if (OcLog->FileSystem != NULL
+        || (Options & OC_LOG_VARIABLE_BATCH) != 0) {
+        gBS->SetTimer (Private->FlushEvent, TimerPeriodic, OC_LOG_FLUSH_PERIOD);
+      } else {
+        gBS->SetTimer (Private->FlushEvent, TimerCancel, 0);
+      }
+    }
+  }
+
   return Status;
 }
+
+EFI_STATUS
+OcSaveLog (
+  VOID
+  )
+{
+  OC_LOG_PROTOCOL  *OcLog;
+
+  OcLog = InternalGetOcLog ();
+  if (OcLog == NULL) {
+    return EFI_NOT_FOUND;
+  }
+
+  return OcLog->SaveLog (OcLog, 0, NULL);
+}
@@ -24,6 +24,13 @@
 #define OC_LOG_FILE_PATH_BUFFER_SIZE  256
 #define OC_LOG_TIMING_BUFFER_SIZE     64
 
+//
+// Pending log file data is written once it reaches this size, or once
+// the flush timer fires, whichever comes first.
+//
+#define OC_LOG_FILE_FLUSH_THRESHOLD   BASE_4KB
+#define OC_LOG_FLUSH_PERIOD           EFI_TIMER_PERIOD_SECONDS (1)
+
 #define OC_LOG_PRIVATE_DATA_SIGNATURE  SIGNATURE_32 ('O', 'C', 'L', 'G')
 
 #define OC_LOG_PRIVATE_DATA_FROM_OC_LOG_THIS(a) \
@@ -39,11 +46,26 @@ typedef struct {
   CHAR16                 UnicodeLineBuffer[OC_LOG_LINE_BUFFER_SIZE];
   CHAR8                  AsciiBuffer[OC_LOG_BUFFER_SIZE];
   UINTN                  AsciiBufferSize;
+  UINTN                  AsciiBufferLength;
   CHAR8                  NvramBuffer[OC_LOG_NVRAM_BUFFER_SIZE];
   UINTN                  NvramBufferSize;
+  UINTN                  NvramBufferLength;
+  UINT32                 NvramPendingLines;
+  UINT32                 NvramPendingBytes;
+  UINT32                 NvramWrites;
+  UINT32                 NvramSavedWrites;
   UINT32                 LogCounter;
   CHAR16                 *LogFilePathName;
   EFI_DATA_HUB_PROTOCOL  *DataHub;
+  EFI_FILE_PROTOCOL      *LogFile;
+  UINTN                  FileFlushedLength;
+  BOOLEAN                FileSyncPending;
+  BOOLEAN                FileFlushing;
+  EFI_EVENT              FlushEvent;
+  EFI_EVENT              ExitBootServicesEvent;
+  UINT64                 FileLineCount;
+  UINT64                 FileLineTicks;
+  UINT32                 FileFlushCount;
   OC_LOG_PROTOCOL        OcLog;
 } OC_LOG_PRIVATE_DATA;
 
@@ -17,6 +17,81 @@
 #include <Library/DebugLib.h>
 #include <Library/OcMiscLib.h>
 
+/**
+  Approximate weight of a byte in x86 code and data, lower is rarer.
+**/
+STATIC
+UINT8
+GetPatternByteWeight (
+  IN UINT8  Byte
+  )
+{
+  switch (Byte) {
+    case 0x00:
+    case 0xFF:
+      return 3;
+    case 0x01:
+    case 0x0F:
+    case 0x24:
+    case 0x41:
+    case 0x45:
+    case 0x48:
+    case 0x49:
+    case 0x4C:
+    case 0x74:
+    case 0x75:
+    case 0x83:
+    case 0x85:
+    case 0x89:
+    case 0x8B:
+    case 0x8D:
+    case 0xC0:
+    case 0xC3:
+    case 0xCC:
+    case 0xE8:
+      return 2;
+    default:
+      return Byte < 0x10 ? 1 : 0;
+  }
+}
+
+STATIC
+BOOLEAN
+MatchPattern (
+  IN CONST UINT8   *Pattern,
+  IN CONST UINT8   *PatternMask OPTIONAL,
+  IN CONST UINT32  PatternSize,
+  IN CONST UINT8   *Data
+  )
+{
+  UINT32  Index;
+  UINT64  Mask;
+
+  Index = 0;
+
+  //
+  // Verify 8 bytes at a time, masking them when requested.
+  //
+  while (PatternSize - Index >= sizeof (UINT64)) {
+    Mask = PatternMask != NULL ? ReadUnaligned64 ((CONST UINT64 *) &PatternMask[Index]) : MAX_UINT64;
+    if ((ReadUnaligned64 ((CONST UINT64 *) &Data[Index]) & Mask)
+      != ReadUnaligned64 ((CONST UINT64 *) &Pattern[Index])) {
+      return FALSE;
+    }
+    Index += sizeof (UINT64);
+  }
+
+  while (Index < PatternSize) {
+    if ((PatternMask == NULL && Data[Index] != Pattern[Index])
+      || (PatternMask != NULL && (Data[Index] & PatternMask[Index]) != Pattern[Index])) {
+      return FALSE;
+    }
+    ++Index;
+  }
+
+  return TRUE;
+}
+
 INT32
 FindPattern (
   IN CONST UINT8   *Pattern,
@@ -27,8 +102,16 @@ FindPattern (
   IN INT32         DataOff
   )
 {
-  BOOLEAN  Matches;
   UINT32   Index;
+  UINT32   Anchor;
+  UINT32   Offset;
+  UINT32   End;
+  UINT32   Count;
+  UINT8    Weight;
+  UINT8    AnchorWeight;
+  UINT8    AnchorByte;
+  UINT64   Broadcast;
+  UINT64   Word;
 
   ASSERT (DataOff >= 0);
 
@@ -36,20 +119,65 @@ FindPattern (
     return -1;
   }
 
-  while (DataOff + PatternSize <= DataSize) {
-    Matches = TRUE;
-    for (Index = 0; Index < PatternSize; ++Index) {
-      if ((PatternMask == NULL && Data[DataOff + Index] != Pattern[Index])
-      || (PatternMask != NULL && (Data[DataOff + Index] & PatternMask[Index]) != Pattern[Index])) {
-        Matches = FALSE;
-        break;
+  //
+  // Pick the rarest exact byte of the pattern as an anchor.
+  //
+  Anchor       = PatternSize;
+  AnchorWeight = MAX_UINT8;
+  for (Index = 0; Index < PatternSize; ++Index) {
+    if (PatternMask == NULL || PatternMask[Index] == 0xFF) {
+      Weight = GetPatternByteWeight (Pattern[Index]);
+      if (Weight < AnchorWeight) {
+        Anchor       = Index;
+        AnchorWeight = Weight;
+        if (Weight == 0) {
+          break;
+        }
       }
     }
+  }
 
-    if (Matches) {
-      return DataOff;
+  if (Anchor == PatternSize) {
+    //
+    // There are no exact bytes, check every position.
+    //
+    for (Offset = (UINT32) DataOff; Offset <= DataSize - PatternSize; ++Offset) {
+      if (MatchPattern (Pattern, PatternMask, PatternSize, &Data[Offset])) {
+        return (INT32) Offset;
+      }
+    }
+
+    return -1;
+  }
+
+  //
+  // Look for the anchor a word at a time, and verify the pattern on every hit.
+  // Anchor positions are limited, so that the pattern fits the data.
+  //
+  AnchorByte = Pattern[Anchor];
+  Broadcast  = MultU64x32 (0x0101010101010101ULL, AnchorByte);
+  Offset     = (UINT32) DataOff + Anchor;
+  End        = DataSize - PatternSize + Anchor + 1;
+
+  while (Offset < End) {
+    if (End - Offset >= sizeof (UINT64)) {
+      Word = ReadUnaligned64 ((CONST UINT64 *) &Data[Offset]) ^ Broadcast;
+      if (((Word - 0x0101010101010101ULL) & ~Word & 0x8080808080808080ULL) == 0) {
+        Offset += sizeof (UINT64);
+        continue;
+      }
+
+      Count = sizeof (UINT64);
+    } else {
+      Count = End - Offset;
+    }
+
+    for (Index = 0; Index < Count; ++Index, ++Offset) {
+      if (Data[Offset] == AnchorByte
+        && MatchPattern (Pattern, PatternMask, PatternSize, &Data[Offset - Anchor])) {
+        return (INT32) (Offset - Anchor);
+      }
     }
-    ++DataOff;
   }
 
   return -1;
@@ -119,6 +119,170 @@ mVaultSchema = {
   .Dict = {mVaultNodesSchema, ARRAY_SIZE (mVaultNodesSchema)}
 };
 
+/**
+  Fold vault path character case like FAT does for ASCII.
+**/
+#define OC_STORAGE_FOLD_CHAR(Char) \
+  (((Char) >= 'a' && (Char) <= 'z') ? ((Char) - ('a' - 'A')) : (Char))
+
+/**
+  Calculate FNV-1a hash of case folded vault path.
+
+  @param[in]  Path       Vault path, CHAR8 or CHAR16 depending on IsUnicode.
+  @param[in]  IsUnicode  Path is CHAR16.
+  @param[out] Length     Path length in characters.
+
+  @retval path hash.
+**/
+STATIC
+UINT32
+OcStorageGetPathHash (
+  IN  CONST VOID  *Path,
+  IN  BOOLEAN     IsUnicode,
+  OUT UINTN       *Length
+  )
+{
+  UINT32  Hash;
+  UINTN   Index;
+  UINT16  Char;
+
+  Hash = 0x811C9DC5U;
+
+  for (Index = 0; ; ++Index) {
+    if (IsUnicode) {
+      Char = ((CONST CHAR16 *) Path)[Index];
+    } else {
+      Char = ((CONST UINT8 *) Path)[Index];
+    }
+
+    if (Char == 0) {
+      break;
+    }
+
+    Hash = (Hash ^ OC_STORAGE_FOLD_CHAR (Char)) * 0x01000193U;
+  }
+
+  *Length = Index;
+  return Hash;
+}
+
+/**
+  Compare vault file path with requested file path ignoring ASCII case.
+**/
+STATIC
+BOOLEAN
+OcStorageIsVaultPath (
+  IN CONST CHAR8   *VaultFilePath,
+  IN CONST VOID    *Path,
+  IN BOOLEAN       IsUnicode,
+  IN UINTN         Length
+  )
+{
+  UINTN   Index;
+  UINT16  Char;
+
+  for (Index = 0; Index < Length; ++Index) {
+    if (IsUnicode) {
+      Char = ((CONST CHAR16 *) Path)[Index];
+    } else {
+      Char = ((CONST UINT8 *) Path)[Index];
+    }
+
+    if (OC_STORAGE_FOLD_CHAR (Char) != OC_STORAGE_FOLD_CHAR ((UINT8) VaultFilePath[Index])) {
+      return FALSE;
+    }
+  }
+
+  return TRUE;
+}
+
+/**
+  Find vault index slot for path.
+
+  @retval slot with matching file or empty slot.
+**/
+STATIC
+UINT32 *
+OcStorageFindVaultSlot (
+  IN OC_STORAGE_CONTEXT  *Context,
+  IN CONST VOID          *Path,
+  IN BOOLEAN             IsUnicode
+  )
+{
+  UINT32  Hash;
+  UINTN   Length;
+  UINT32  Slot;
+  UINT32  Index;
+
+  Hash = OcStorageGetPathHash (Path, IsUnicode, &Length);
+  Slot = Hash & Context->VaultIndexMask;
+
+  while (Context->VaultIndex[Slot] != 0) {
+    Index = Context->VaultIndex[Slot] - 1;
+
+    if (Context->Vault.Files.Keys[Index]->Size == Length + 1
+      && OcStorageIsVaultPath (OC_BLOB_GET (Context->Vault.Files.Keys[Index]), Path, IsUnicode, Length)) {
+      break;
+    }
+
+    Slot = (Slot + 1) & Context->VaultIndexMask;
+  }
+
+  return &Context->VaultIndex[Slot];
+}
+
+/**
+  Build vault file path hash index.
+  Duplicate paths are reported and only the first of them is used.
+
+  @retval EFI_SUCCESS on success.
+**/
+STATIC
+EFI_STATUS
+OcStorageIndexVault (
+  IN OUT OC_STORAGE_CONTEXT  *Context
+  )
+{
+  UINT32  Index;
+  UINT32  Size;
+  UINT32  *Slot;
+  CHAR8   *VaultFilePath;
+
+  //
+  // Keep load factor under 50% to ensure short probe sequences.
+  //
+  if (Context->Vault.Files.Count > BASE_64MB) {
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  Size = GetPowerOfTwo32 (MAX (Context->Vault.Files.Count, 4)) * 4;
+
+  Context->VaultIndex = AllocateZeroPool (Size * sizeof (*Context->VaultIndex));
+  if (Context->VaultIndex == NULL) {
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  Context->VaultIndexMask = Size - 1;
+
+  for (Index = 0; Index < Context->Vault.Files.Count; ++Index) {
+    VaultFilePath = OC_BLOB_GET (Context->Vault.Files.Keys[Index]);
+
+    Slot = OcStorageFindVaultSlot (Context, VaultFilePath, FALSE);
+    if (*Slot != 0) {
+      DEBUG ((
+        DEBUG_WARN,
+        "OCST: Duplicate vault entry %a, using %a\n",
+        VaultFilePath,
+        OC_BLOB_GET (Context->Vault.Files.Keys[*Slot - 1])
+        ));
+      continue;
+    }
+
+    *Slot = Index + 1;
+  }
+
+  return EFI_SUCCESS;
+}
 
 STATIC
 EFI_STATUS
@@ -131,6 +295,8 @@ OcStorageInitializeVault (
   IN     UINT32              SignatureSize OPTIONAL
   )
 {
+  EFI_STATUS  Status;
+
   if (Signature != NULL && Vault == NULL) {
     DEBUG ((DEBUG_ERROR, "OCST: Missing vault with signature\n"));
     return EFI_SECURITY_VIOLATION;
@@ -168,6 +334,13 @@ OcStorageInitializeVault (
     return EFI_UNSUPPORTED;
   }
 
+  Status = OcStorageIndexVault (Context);
+  if (EFI_ERROR (Status)) {
+    OC_STORAGE_VAULT_DESTRUCT (&Context->Vault, sizeof (Context->Vault));
+    DEBUG ((DEBUG_ERROR, "OCST: Failed to index vault - %r\n", Status));
+    return Status;
+  }
+
   Context->HasVault = TRUE;
 
   return EFI_SUCCESS;
@@ -180,36 +353,18 @@ OcStorageGetDigest (
   IN     CONST CHAR16        *Filename
   )
 {
-  UINT32             Index;
-  UINTN              StrIndex;
-  CHAR8              *VaultFilePath;
-  UINTN              FilenameSize;
+  UINT32             *Slot;
 
   if (!Context->HasVault) {
     return NULL;
   }
 
-  FilenameSize = StrLen (Filename) + 1;
-
-  for (Index = 0; Index < Context->Vault.Files.Count; ++Index) {
-    if (Context->Vault.Files.Keys[Index]->Size != (UINT32) FilenameSize) {
-      continue;
-    }
-
-    VaultFilePath = OC_BLOB_GET (Context->Vault.Files.Keys[Index]);
-
-    for (StrIndex = 0; StrIndex < FilenameSize; ++StrIndex) {
-      if (Filename[StrIndex] != VaultFilePath[StrIndex]) {
-        break;
-      }
-    }
-
-    if (StrIndex == FilenameSize) {
-      return &Context->Vault.Files.Values[Index]->Hash[0];
-    }
+  Slot = OcStorageFindVaultSlot (Context, Filename, TRUE);
+  if (*Slot == 0) {
+    return NULL;
   }
 
-  return NULL;
+  return &Context->Vault.Files.Values[*Slot - 1]->Hash[0];
 }
 
 EFI_STATUS
@@ -326,6 +481,11 @@ OcStorageFree (
     OC_STORAGE_VAULT_DESTRUCT (&Context->Vault, sizeof (Context->Vault));
     Context->HasVault = FALSE;
   }
+
+  if (Context->VaultIndex != NULL) {
+    FreePool (Context->VaultIndex);
+    Context->VaultIndex = NULL;
+  }
 }
 
 BOOLEAN
@@ -371,19 +531,24 @@ OcStorageExistsFileUnicode (
   return FALSE;
 }
 
-VOID *
-OcStorageReadFileUnicode (
-  IN  OC_STORAGE_CONTEXT               *Context,
-  IN  CONST CHAR16                     *FilePath,
-  OUT UINT32                           *FileSize OPTIONAL
+EFI_STATUS
+OcStorageReadFileUnicodeEx (
+  IN     OC_STORAGE_CONTEXT            *Context,
+  IN     CONST CHAR16                  *FilePath,
+  IN OUT VOID                          **Buffer,
+  IN     UINT32                        BufferSize  OPTIONAL,
+     OUT UINT32                        *FileSize
   )
 {
   EFI_STATUS         Status;
   EFI_FILE_PROTOCOL  *File;
   UINT32             Size;
+  UINT32             Offset;
+  UINT32             BlockSize;
   UINT8              *FileBuffer;
   UINT8              *VaultDigest;
   UINT8              FileDigest[SHA256_DIGEST_SIZE];
+  SHA256_CONTEXT     ShaContext;
 
   //
   // Using this API with empty filename is also not allowed.
@@ -391,19 +556,21 @@ OcStorageReadFileUnicode (
   ASSERT (Context != NULL);
   ASSERT (FilePath != NULL);
   ASSERT (StrLen (FilePath) > 0);
+  ASSERT (Buffer != NULL);
+  ASSERT (FileSize != NULL);
 
   VaultDigest = OcStorageGetDigest (Context, FilePath);
 
   if (Context->HasVault && VaultDigest == NULL) {
     DEBUG ((DEBUG_ERROR, "OCST: Aborting %s file access not present in vault\n", FilePath));
-    return NULL;
+    return EFI_SECURITY_VIOLATION;
   }
 
   if (Context->Storage == NULL) {
     //
     // TODO: expand support for other contexts.
     //
-    return NULL;
+    return EFI_UNSUPPORTED;
   }
 
   Status = SafeFileOpen (
@@ -415,40 +582,93 @@ OcStorageReadFileUnicode (
     );
 
   if (EFI_ERROR (Status)) {
-    return NULL;
+    return Status;
   }
 
   Status = GetFileSize (File, &Size);
   if (EFI_ERROR (Status) || Size >= MAX_UINT32 - 1) {
     File->Close (File);
-    return NULL;
+    return EFI_ERROR (Status) ? Status : EFI_UNSUPPORTED;
   }
 
-  FileBuffer = AllocatePool (Size + 2);
-  if (FileBuffer == NULL) {
-    File->Close (File);
-    return NULL;
+  if (*Buffer != NULL) {
+    if (BufferSize < Size + 2) {
+      File->Close (File);
+      *FileSize = Size + 2;
+      return EFI_BUFFER_TOO_SMALL;
+    }
+
+    FileBuffer = *Buffer;
+  } else {
+    FileBuffer = AllocatePool (Size + 2);
+    if (FileBuffer == NULL) {
+      File->Close (File);
+      return EFI_OUT_OF_RESOURCES;
+    }
   }
 
-  Status = GetFileData (File, 0, Size, FileBuffer);
-  File->Close (File);
-  if (EFI_ERROR (Status)) {
-    FreePool (FileBuffer);
-    return NULL;
+  //
+  // Hash every block right after reading it while it is still in cache.
+  //
+  Sha256Init (&ShaContext);
+
+  for (Offset = 0; Offset < Size; Offset += BlockSize) {
+    BlockSize = MIN (Size - Offset, OC_STORAGE_READ_BLOCK_SIZE);
+
+    Status = GetFileData (File, Offset, BlockSize, &FileBuffer[Offset]);
+    if (EFI_ERROR (Status)) {
+      break;
+    }
+
+    if (VaultDigest != NULL) {
+      Sha256Update (&ShaContext, &FileBuffer[Offset], BlockSize);
+    }
   }
 
-  if (VaultDigest != 0) {
-    Sha256 (FileDigest, FileBuffer, Size);
+  File->Close (File);
+
+  if (!EFI_ERROR (Status) && VaultDigest != NULL) {
+    Sha256Final (&ShaContext, FileDigest);
     if (CompareMem (FileDigest, VaultDigest, SHA256_DIGEST_SIZE) != 0) {
       DEBUG ((DEBUG_ERROR, "OCST: Aborting corrupted %s file access\n", FilePath));
+      Status = EFI_SECURITY_VIOLATION;
+    }
+  }
+
+  if (EFI_ERROR (Status)) {
+    if (*Buffer == NULL) {
       FreePool (FileBuffer);
-      return NULL;
     }
+    return Status;
   }
 
   FileBuffer[Size]     = 0;
   FileBuffer[Size + 1] = 0;
 
+  *Buffer   = FileBuffer;
+  *FileSize = Size;
+
+  return EFI_SUCCESS;
+}
+
+VOID *
+OcStorageReadFileUnicode (
+  IN  OC_STORAGE_CONTEXT               *Context,
+  IN  CONST CHAR16                     *FilePath,
+  OUT UINT32                           *FileSize OPTIONAL
+  )
+{
+  EFI_STATUS         Status;
+  VOID               *FileBuffer;
+  UINT32             Size;
+
+  FileBuffer = NULL;
+
+  Status = OcStorageReadFileUnicodeEx (Context, FilePath, &FileBuffer, 0, &Size);
+  if (EFI_ERROR (Status)) {
+    return NULL;
+  }
+
   if (FileSize != NULL) {
     *FileSize = Size;
   }
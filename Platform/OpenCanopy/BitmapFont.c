@@ -615,16 +615,32 @@ BlendMem (
   UINTN                         PixelCount
   )
 {
-  UINTN  Index;
+  EFI_GRAPHICS_OUTPUT_BLT_PIXEL  Front[64];
+  UINTN                          ChunkSize;
+  UINTN                          Index;
+  UINT8                          Alpha;
 
-  for (Index = 0; Index < PixelCount; ++Index) {
-    //
-    // We assume that the font is generated by dpFontBaker
-    // and has only gray channel, which should be interpreted as alpha.
-    //
-    GuiBlendPixel(Dst, Color, AlphaSrc->Red);
-    ++Dst;
-    ++AlphaSrc;
+  while (PixelCount > 0) {
+    ChunkSize = MIN (PixelCount, ARRAY_SIZE (Front));
+
+    for (Index = 0; Index < ChunkSize; ++Index) {
+      //
+      // We assume that the font is generated by dpFontBaker
+      // and has only gray channel, which should be interpreted as alpha.
+      // Applying it to the colour in advance matches blending with opacity.
+      //
+      Alpha = AlphaSrc[Index].Red;
+      Front[Index].Blue     = (UINT8) ((Color->Blue     * Alpha) / 0xFF);
+      Front[Index].Green    = (UINT8) ((Color->Green    * Alpha) / 0xFF);
+      Front[Index].Red      = (UINT8) ((Color->Red      * Alpha) / 0xFF);
+      Front[Index].Reserved = (UINT8) ((Color->Reserved * Alpha) / 0xFF);
+    }
+
+    GuiBlendRow (Dst, Front, ChunkSize, 0xFF);
+
+    Dst        += ChunkSize;
+    AlphaSrc   += ChunkSize;
+    PixelCount -= ChunkSize;
   }
 }
 
@@ -720,6 +736,7 @@ GuiGetLabel (
   LabelImage->Width  = TextInfo->Width;
   LabelImage->Height = TextInfo->Height;
   LabelImage->Buffer = Buffer;
+  GuiImageComputeRuns (LabelImage);
   FreePool (TextInfo);
   return TRUE;
 }
@@ -775,6 +792,7 @@ GuiFontDestruct (
 {
   ASSERT (Context != NULL);
   if (Context->FontImage.Buffer != NULL) {
+    GuiImageFreeRuns (&Context->FontImage);
     FreePool (Context->FontImage.Buffer);
     Context->FontImage.Buffer = NULL;
   }
@@ -18,6 +18,7 @@
 #include <Library/UefiRuntimeServicesTableLib.h>
 #include <Library/PrintLib.h>
 #include <Library/BaseLib.h>
+#include <Library/TimerLib.h>
 
 #include <Guid/AppleVariable.h>
 #include <Protocol/UserInterfaceTheme.h>
@@ -89,14 +90,17 @@ InternalContextDestruct (
   for (Index = 0; Index < ICON_NUM_TOTAL; ++Index) {
     for (Index2 = 0; Index2 < ICON_TYPE_COUNT; ++Index2) {
       InternalSafeFreePool (Context->Icons[Index][Index2].Buffer);
+      InternalSafeFreePool (Context->Icons[Index][Index2].Runs);
     }
   }
 
   for (Index = 0; Index < LABEL_NUM_TOTAL; ++Index) {
     InternalSafeFreePool (Context->Labels[Index].Buffer);
+    InternalSafeFreePool (Context->Labels[Index].Runs);
   }
 
   InternalSafeFreePool (Context->FontContext.FontImage.Buffer);
+  InternalSafeFreePool (Context->FontContext.FontImage.Runs);
   /*
   InternalSafeFreePool (Context->Poof[0].Buffer);
   InternalSafeFreePool (Context->Poof[1].Buffer);
@@ -109,8 +113,9 @@ InternalContextDestruct (
 STATIC
 EFI_STATUS
 LoadImageFileFromStorage (
-  OUT GUI_IMAGE                *Images,
-  IN  OC_STORAGE_CONTEXT       *Storage,
+  OUT    GUI_IMAGE             *Images,
+  IN OUT GUI_ICON_CACHE        *Cache,
+  IN     OC_STORAGE_CONTEXT    *Storage,
   IN  CONST CHAR8              *ImageFilePath,
   IN  UINT8                    Scale,
   IN  UINT32                   MatchWidth,
@@ -150,7 +155,8 @@ LoadImageFileFromStorage (
     if (OcStorageExistsFileUnicode (Storage, Path)) {
       FileData = OcStorageReadFileUnicode (Storage, Path, &FileSize);
       if (FileData != NULL && FileSize > 0) {
-        Status = GuiIcnsToImageIcon (
+        Status = GuiIcnsToImageIconCached (
+          Cache,
           &Images[Index],
           FileData,
           FileSize,
@@ -274,6 +280,7 @@ InternalContextConstruct (
   UINTN                              UiScaleSize;
   UINT32                             Index;
   UINT32                             ImageDimension;
+  UINT64                             StartTsc;
   BOOLEAN                            Old;
   BOOLEAN                            Result;
 
@@ -335,7 +342,14 @@ InternalContextConstruct (
 
   Context->BootEntry = NULL;
 
-  Status = EFI_SUCCESS;
+  GuiIconCacheInitialize (
+    &Context->IconCache,
+    Storage,
+    (Picker->PickerAttributes & OC_ATTR_USE_ICON_CACHE) != 0
+    );
+
+  StartTsc = AsmReadTsc ();
+  Status   = EFI_SUCCESS;
 
   for (Index = 0; Index < ICON_NUM_TOTAL; ++Index) {
     if (Index == ICON_CURSOR) {
@@ -350,6 +364,7 @@ InternalContextConstruct (
 
     Status = LoadImageFileFromStorage (
       Context->Icons[Index],
+      &Context->IconCache,
       Storage,
       mIconNames[Index],
       Context->Scale,
@@ -400,6 +415,16 @@ InternalContextConstruct (
     }
   }
 
+  Context->ImageLoadTsc = AsmReadTsc () - StartTsc;
+
+  DEBUG ((
+    DEBUG_INFO,
+    "OCUI: Loaded images in %Lu us, icon cache %u hits %u misses\n",
+    DivU64x32 (GetTimeInNanoSecond (Context->ImageLoadTsc), 1000),
+    Context->IconCache.Hits,
+    Context->IconCache.Misses
+    ));
+
   if (EFI_ERROR (Status)) {
     DEBUG ((DEBUG_WARN, "OCUI: Failed to load images\n"));
     InternalContextDestruct (Context);
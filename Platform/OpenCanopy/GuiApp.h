@@ -12,6 +12,7 @@
 #include "BmfLib.h"
 
 #include <Library/OcBootManagementLib.h>
+#include <Library/OcStorageLib.h>
 
 #define MAX_CURSOR_DIMENSION  144U
 
@@ -69,11 +70,53 @@ typedef enum {
   ICON_TYPE_COUNT    = 2,
 } ICON_TYPE;
 
+//
+// Maximum amount of icons kept in the icon cache.
+//
+#define GUI_ICON_CACHE_MAX_ENTRIES  64U
+
+//
+// Icon cache file name size in characters, including the terminator.
+//
+#define GUI_ICON_CACHE_NAME_SIZE  48U
+
+typedef struct {
+  ///
+  /// Storage directory holding the cache, NULL when the cache is disabled.
+  ///
+  EFI_FILE_PROTOCOL  *Root;
+  ///
+  /// Amount of icons found in the cache.
+  ///
+  UINT32             Hits;
+  ///
+  /// Amount of icons decoded and stored to the cache.
+  ///
+  UINT32             Misses;
+  ///
+  /// Whether icons were stored to the cache since it was last pruned.
+  ///
+  BOOLEAN            Stored;
+  ///
+  /// Amount of cache files used during this picker run.
+  ///
+  UINT32             NumUsed;
+  ///
+  /// Names of cache files used during this picker run.
+  ///
+  CHAR16             Used[GUI_ICON_CACHE_MAX_ENTRIES][GUI_ICON_CACHE_NAME_SIZE];
+} GUI_ICON_CACHE;
+
 typedef struct _BOOT_PICKER_GUI_CONTEXT {
   GUI_IMAGE                            Icons[ICON_NUM_TOTAL][ICON_TYPE_COUNT];
   GUI_IMAGE                            Labels[LABEL_NUM_TOTAL];
   // GUI_IMAGE                         Poof[5];
   GUI_FONT_CONTEXT                     FontContext;
+  GUI_ICON_CACHE                       IconCache;
+  ///
+  /// TSC ticks spent loading images before the picker is shown.
+  ///
+  UINT64                               ImageLoadTsc;
   VOID                                 *BootEntry;
   EFI_GRAPHICS_OUTPUT_BLT_PIXEL_UNION  BackgroundColor;
   BOOLEAN                              HideAuxiliary;
@@ -94,10 +137,10 @@ BootPickerViewInitialize (
 
 EFI_STATUS
 BootPickerEntriesAdd (
-  IN OC_PICKER_CONTEXT              *Context,
-  IN CONST BOOT_PICKER_GUI_CONTEXT  *GuiContext,
-  IN OC_BOOT_ENTRY                  *Entry,
-  IN BOOLEAN                        Default
+  IN     OC_PICKER_CONTEXT          *Context,
+  IN OUT BOOT_PICKER_GUI_CONTEXT    *GuiContext,
+  IN     OC_BOOT_ENTRY              *Entry,
+  IN     BOOLEAN                    Default
   );
 
 VOID
@@ -106,6 +149,53 @@ BootPickerViewDeinitialize (
   IN OUT BOOT_PICKER_GUI_CONTEXT  *GuiContext
   );
 
+/**
+  Initialise the decoded icon cache in OpenCore storage.
+
+  @param[out] Cache    Icon cache.
+  @param[in]  Storage  OpenCore storage.
+  @param[in]  Enable   Whether the icon cache is requested.
+**/
+VOID
+GuiIconCacheInitialize (
+  OUT GUI_ICON_CACHE      *Cache,
+  IN  OC_STORAGE_CONTEXT  *Storage,
+  IN  BOOLEAN             Enable
+  );
+
+/**
+  Remove icon cache files not used during this picker run. Nothing is done
+  unless new icons were stored, so the cache holds at most
+  GUI_ICON_CACHE_MAX_ENTRIES files once pruned.
+
+  @param[in,out] Cache  Icon cache.
+**/
+VOID
+GuiIconCachePrune (
+  IN OUT GUI_ICON_CACHE  *Cache
+  );
+
+/**
+  Decode an ICNS icon like GuiIcnsToImageIcon, looking it up in the icon
+  cache first and storing it there when missing. Icons beyond
+  GUI_ICON_CACHE_MAX_ENTRIES are decoded without the cache.
+
+  @param[in,out] Cache  Icon cache.
+
+  Other parameters match GuiIcnsToImageIcon.
+**/
+EFI_STATUS
+GuiIcnsToImageIconCached (
+  IN OUT GUI_ICON_CACHE  *Cache,
+  OUT    GUI_IMAGE       *Image,
+  IN     VOID            *IcnsImage,
+  IN     UINT32          IcnsImageSize,
+  IN     UINT8           Scale,
+  IN     UINT32          MatchWidth,
+  IN     UINT32          MatchHeight,
+  IN     BOOLEAN         AllowLess
+  );
+
 CONST GUI_IMAGE *
 InternalGetCursorImage (
   IN OUT GUI_SCREEN_CURSOR        *This,
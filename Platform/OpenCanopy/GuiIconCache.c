@@ -0,0 +1,412 @@
+/** @file
+  This file is part of OpenCanopy, OpenCore GUI.
+
+  Decoded icon cache in OpenCore storage. Icons are stored as raw pixels
+  keyed by the digest of the original ICNS file and scale, which lets
+  subsequent boots skip PNG decoding. Files not used by the picker are
+  removed whenever new icons are stored.
+
+  Copyright (c) 2026, agent. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-3-Clause
+**/
+
+#include <Uefi.h>
+
+#include <Library/BaseLib.h>
+#include <Library/BaseMemoryLib.h>
+#include <Library/DebugLib.h>
+#include <Library/FileHandleLib.h>
+#include <Library/MemoryAllocationLib.h>
+#include <Library/OcCryptoLib.h>
+#include <Library/OcFileLib.h>
+#include <Library/OcStorageLib.h>
+#include <Library/OcStringLib.h>
+
+#include "OpenCanopy.h"
+#include "GuiApp.h"
+
+//
+// Icon cache directory relative to OpenCore storage.
+//
+#define GUI_ICON_CACHE_PATH  L"Resources\\Cache"
+
+#define GUI_ICON_CACHE_SIGNATURE  SIGNATURE_32 ('O', 'C', 'I', '1')
+
+//
+// Icons larger than this are neither cached nor loaded from the cache.
+//
+#define GUI_ICON_CACHE_MAX_DIMENSION  1024U
+
+//
+// Amount of digest bytes used in cache file names.
+//
+#define GUI_ICON_CACHE_NAME_DIGEST_SIZE  16U
+
+STATIC CONST CHAR8 mIconCacheHexDigits[] = "0123456789ABCDEF";
+
+typedef struct {
+  UINT32  Signature;
+  UINT32  Scale;
+  UINT32  Width;
+  UINT32  Height;
+  UINT8   Digest[SHA256_DIGEST_SIZE];
+} GUI_ICON_CACHE_HEADER;
+
+STATIC
+EFI_STATUS
+InternalIconCacheName (
+  OUT CHAR16       *Name,
+  IN  UINTN        NameSize,
+  IN  CONST UINT8  *Digest,
+  IN  UINT8        Scale
+  )
+{
+  CHAR8  Hex[GUI_ICON_CACHE_NAME_DIGEST_SIZE * 2 + 1];
+  UINT32 Index;
+
+  for (Index = 0; Index < GUI_ICON_CACHE_NAME_DIGEST_SIZE; ++Index) {
+    Hex[Index * 2]     = mIconCacheHexDigits[Digest[Index] >> 4U];
+    Hex[Index * 2 + 1] = mIconCacheHexDigits[Digest[Index] & 0x0FU];
+  }
+
+  Hex[GUI_ICON_CACHE_NAME_DIGEST_SIZE * 2] = '\0';
+
+  return OcUnicodeSafeSPrint (
+    Name,
+    NameSize,
+    L"%a_%u.bin",
+    Hex,
+    Scale
+    );
+}
+
+STATIC
+BOOLEAN
+InternalIconCacheIsUsed (
+  IN CONST GUI_ICON_CACHE  *Cache,
+  IN CONST CHAR16          *Name
+  )
+{
+  UINT32  Index;
+
+  for (Index = 0; Index < Cache->NumUsed; ++Index) {
+    if (OcStriCmp ((CHAR16 *) Cache->Used[Index], (CHAR16 *) Name) == 0) {
+      return TRUE;
+    }
+  }
+
+  return FALSE;
+}
+
+/**
+  Mark a cache file as used during this picker run.
+
+  @retval FALSE when the cache is full.
+**/
+STATIC
+BOOLEAN
+InternalIconCacheUse (
+  IN OUT GUI_ICON_CACHE  *Cache,
+  IN     CONST CHAR16    *Name
+  )
+{
+  EFI_STATUS  Status;
+
+  if (InternalIconCacheIsUsed (Cache, Name)) {
+    return TRUE;
+  }
+
+  if (Cache->NumUsed == GUI_ICON_CACHE_MAX_ENTRIES) {
+    return FALSE;
+  }
+
+  Status = StrCpyS (Cache->Used[Cache->NumUsed], GUI_ICON_CACHE_NAME_SIZE, Name);
+  ASSERT_EFI_ERROR (Status);
+  ++Cache->NumUsed;
+  return TRUE;
+}
+
+STATIC
+EFI_STATUS
+InternalIconCacheLoad (
+  IN  GUI_ICON_CACHE  *Cache,
+  IN  CONST CHAR16    *Path,
+  IN  CONST UINT8     *Digest,
+  IN  UINT8           Scale,
+  OUT GUI_IMAGE       *Image
+  )
+{
+  UINT8                  *FileData;
+  UINT32                 FileSize;
+  UINT32                 ImageSize;
+  GUI_ICON_CACHE_HEADER  Header;
+
+  FileData = ReadFileFromFile (
+    Cache->Root,
+    Path,
+    &FileSize,
+    sizeof (Header) + GUI_ICON_CACHE_MAX_DIMENSION * GUI_ICON_CACHE_MAX_DIMENSION
+      * sizeof (EFI_GRAPHICS_OUTPUT_BLT_PIXEL)
+    );
+  if (FileData == NULL) {
+    return EFI_NOT_FOUND;
+  }
+
+  if (FileSize < sizeof (Header)) {
+    FreePool (FileData);
+    return EFI_VOLUME_CORRUPTED;
+  }
+
+  CopyMem (&Header, FileData, sizeof (Header));
+
+  //
+  // The cache is not covered by the vault, so validate everything.
+  //
+  if (Header.Signature != GUI_ICON_CACHE_SIGNATURE
+    || Header.Scale != Scale
+    || Header.Width == 0
+    || Header.Height == 0
+    || Header.Width > GUI_ICON_CACHE_MAX_DIMENSION
+    || Header.Height > GUI_ICON_CACHE_MAX_DIMENSION
+    || CompareMem (Header.Digest, Digest, sizeof (Header.Digest)) != 0) {
+    FreePool (FileData);
+    return EFI_VOLUME_CORRUPTED;
+  }
+
+  ImageSize = Header.Width * Header.Height * sizeof (EFI_GRAPHICS_OUTPUT_BLT_PIXEL);
+  if (FileSize - sizeof (Header) != ImageSize) {
+    FreePool (FileData);
+    return EFI_VOLUME_CORRUPTED;
+  }
+
+  //
+  // Reuse the file buffer for the pixels.
+  //
+  CopyMem (FileData, FileData + sizeof (Header), ImageSize);
+
+  Image->Width  = Header.Width;
+  Image->Height = Header.Height;
+  Image->Buffer = (EFI_GRAPHICS_OUTPUT_BLT_PIXEL *) FileData;
+  return EFI_SUCCESS;
+}
+
+STATIC
+VOID
+InternalIconCacheStore (
+  IN GUI_ICON_CACHE   *Cache,
+  IN CONST CHAR16     *Path,
+  IN CONST UINT8      *Digest,
+  IN UINT8            Scale,
+  IN CONST GUI_IMAGE  *Image
+  )
+{
+  EFI_STATUS             Status;
+  UINT8                  *FileData;
+  UINT32                 ImageSize;
+  GUI_ICON_CACHE_HEADER  *Header;
+
+  if (Image->Width > GUI_ICON_CACHE_MAX_DIMENSION
+    || Image->Height > GUI_ICON_CACHE_MAX_DIMENSION) {
+    return;
+  }
+
+  ImageSize = Image->Width * Image->Height * sizeof (EFI_GRAPHICS_OUTPUT_BLT_PIXEL);
+  FileData  = AllocatePool (sizeof (*Header) + ImageSize);
+  if (FileData == NULL) {
+    return;
+  }
+
+  Header            = (GUI_ICON_CACHE_HEADER *) FileData;
+  Header->Signature = GUI_ICON_CACHE_SIGNATURE;
+  Header->Scale     = Scale;
+  Header->Width     = Image->Width;
+  Header->Height    = Image->Height;
+  CopyMem (Header->Digest, Digest, sizeof (Header->Digest));
+  CopyMem (FileData + sizeof (*Header), Image->Buffer, ImageSize);
+
+  Status = SetFileData (Cache->Root, Path, FileData, sizeof (*Header) + ImageSize);
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_INFO, "OCUI: Failed to store %s to icon cache - %r\n", Path, Status));
+  } else {
+    Cache->Stored = TRUE;
+  }
+
+  FreePool (FileData);
+}
+
+VOID
+GuiIconCacheInitialize (
+  OUT GUI_ICON_CACHE      *Cache,
+  IN  OC_STORAGE_CONTEXT  *Storage,
+  IN  BOOLEAN             Enable
+  )
+{
+  EFI_STATUS         Status;
+  EFI_FILE_PROTOCOL  *Directory;
+
+  ASSERT (Cache != NULL);
+  ASSERT (Storage != NULL);
+
+  ZeroMem (Cache, sizeof (*Cache));
+
+  if (!Enable || Storage->Storage == NULL) {
+    return;
+  }
+
+  //
+  // Cached pixels are not covered by vault signatures.
+  //
+  if (Storage->HasVault) {
+    DEBUG ((DEBUG_INFO, "OCUI: Icon cache is disabled with vault\n"));
+    return;
+  }
+
+  Status = SafeFileOpen (
+    Storage->Storage,
+    &Directory,
+    GUI_ICON_CACHE_PATH,
+    EFI_FILE_MODE_CREATE | EFI_FILE_MODE_READ | EFI_FILE_MODE_WRITE,
+    EFI_FILE_DIRECTORY
+    );
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_INFO, "OCUI: Icon cache is unavailable - %r\n", Status));
+    return;
+  }
+
+  Directory->Close (Directory);
+  Cache->Root = Storage->Storage;
+}
+
+VOID
+GuiIconCachePrune (
+  IN OUT GUI_ICON_CACHE  *Cache
+  )
+{
+  EFI_STATUS         Status;
+  EFI_FILE_PROTOCOL  *Directory;
+  EFI_FILE_PROTOCOL  *File;
+  EFI_FILE_INFO      *FileInfo;
+  BOOLEAN            NoFile;
+  UINT32             Removed;
+
+  ASSERT (Cache != NULL);
+
+  if (Cache->Root == NULL || !Cache->Stored) {
+    return;
+  }
+
+  Cache->Stored = FALSE;
+
+  Status = SafeFileOpen (
+    Cache->Root,
+    &Directory,
+    GUI_ICON_CACHE_PATH,
+    EFI_FILE_MODE_READ,
+    EFI_FILE_DIRECTORY
+    );
+  if (EFI_ERROR (Status)) {
+    return;
+  }
+
+  FileInfo = NULL;
+  Removed  = 0;
+
+  for (
+    Status = FileHandleFindFirstFile (Directory, &FileInfo), NoFile = FALSE;
+    (!EFI_ERROR (Status) && !NoFile);
+    Status = FileHandleFindNextFile (Directory, FileInfo, &NoFile)
+    ) {
+    if ((FileInfo->Attribute & EFI_FILE_DIRECTORY) != 0
+      || InternalIconCacheIsUsed (Cache, FileInfo->FileName)) {
+      continue;
+    }
+
+    Status = SafeFileOpen (
+      Directory,
+      &File,
+      FileInfo->FileName,
+      EFI_FILE_MODE_READ | EFI_FILE_MODE_WRITE,
+      0
+      );
+    if (!EFI_ERROR (Status) && File->Delete (File) == EFI_SUCCESS) {
+      ++Removed;
+    }
+  }
+
+  //
+  // The buffer is only freed by FileHandleFindNextFile once no files are left.
+  //
+  if (EFI_ERROR (Status) && FileInfo != NULL) {
+    FreePool (FileInfo);
+  }
+
+  Directory->Close (Directory);
+
+  DEBUG ((DEBUG_INFO, "OCUI: Icon cache uses %u icons, removed %u stale\n", Cache->NumUsed, Removed));
+}
+
+EFI_STATUS
+GuiIcnsToImageIconCached (
+  IN OUT GUI_ICON_CACHE  *Cache,
+  OUT    GUI_IMAGE       *Image,
+  IN     VOID            *IcnsImage,
+  IN     UINT32          IcnsImageSize,
+  IN     UINT8           Scale,
+  IN     UINT32          MatchWidth,
+  IN     UINT32          MatchHeight,
+  IN     BOOLEAN         AllowLess
+  )
+{
+  EFI_STATUS  Status;
+  UINT8       Digest[SHA256_DIGEST_SIZE];
+  CHAR16      Name[GUI_ICON_CACHE_NAME_SIZE];
+  CHAR16      Path[OC_STORAGE_SAFE_PATH_MAX];
+  BOOLEAN     UseCache;
+
+  ASSERT (Cache != NULL);
+  ASSERT (Image != NULL);
+
+  UseCache = FALSE;
+
+  if (Cache->Root != NULL) {
+    Sha256 (Digest, IcnsImage, IcnsImageSize);
+
+    Status = InternalIconCacheName (Name, sizeof (Name), Digest, Scale);
+    ASSERT_EFI_ERROR (Status);
+
+    UseCache = InternalIconCacheUse (Cache, Name);
+  }
+
+  if (UseCache) {
+    Status = OcUnicodeSafeSPrint (Path, sizeof (Path), GUI_ICON_CACHE_PATH L"\\%s", Name);
+    ASSERT_EFI_ERROR (Status);
+
+    Status = InternalIconCacheLoad (Cache, Path, Digest, Scale, Image);
+    if (!EFI_ERROR (Status)) {
+      if (GuiIconMatchesDimensions (Image, Scale, MatchWidth, MatchHeight, AllowLess)) {
+        GuiImageComputeRuns (Image);
+        ++Cache->Hits;
+        return EFI_SUCCESS;
+      }
+
+      FreePool (Image->Buffer);
+      Image->Buffer = NULL;
+    }
+  }
+
+  Status = GuiIcnsToImageIcon (
+    Image,
+    IcnsImage,
+    IcnsImageSize,
+    Scale,
+    MatchWidth,
+    MatchHeight,
+    AllowLess
+    );
+  if (UseCache && !EFI_ERROR (Status)) {
+    InternalIconCacheStore (Cache, Path, Digest, Scale, Image);
+    ++Cache->Misses;
+  }
+
+  return Status;
+}
@@ -93,6 +93,11 @@ OcShowMenuByOc (
   GuiDrawLoop (&mDrawContext, BootContext->PickerContext->TimeoutSeconds);
   ASSERT (mGuiContext.BootEntry != NULL || mGuiContext.Refresh);
 
+  //
+  // All icons are loaded by now, drop the ones no longer used from the cache.
+  //
+  GuiIconCachePrune (&mGuiContext.IconCache);
+
   //
   // Note, it is important to destruct GUI here, as we must ensure
   // that keyboard/mouse polling does not conflict with FV2 ui.
@@ -21,6 +21,7 @@
 #include <Library/OcCpuLib.h>
 #include <Library/OcGuardLib.h>
 #include <Library/OcPngLib.h>
+#include <Library/PcdLib.h>
 #include <Library/TimerLib.h>
 #include <Library/UefiBootServicesTableLib.h>
 
@@ -36,6 +37,11 @@ typedef struct {
   UINT32 MaxY;
 } GUI_DRAW_REQUEST;
 
+//
+// Maximum amount of rectangles flushed separately per frame.
+//
+#define GUI_MAX_DRAW_REQUESTS  16U
+
 //
 // Variables to assign the picked volume automatically once menu times out
 //
@@ -59,11 +65,16 @@ STATIC GUI_SCREEN_CURSOR             mScreenViewCursor  = { 0, 0 };
 //
 STATIC UINT64                        mDeltaTscTarget    = 0;
 STATIC UINT64                        mStartTsc          = 0;
+STATIC UINT64                        mConstructTsc      = 0;
 //
 // Drawing rectangles information
 //
 STATIC UINT8                         mNumValidDrawReqs  = 0;
-STATIC GUI_DRAW_REQUEST              mDrawRequests[4]   = { { 0 } };
+STATIC GUI_DRAW_REQUEST              mDrawRequests[GUI_MAX_DRAW_REQUESTS] = { { 0 } };
+//
+// Screen flushing statistics
+//
+STATIC GUI_FLUSH_STATS               mTotalFlushStats   = { 0 };
 //
 // Disk label palette.
 //
@@ -312,7 +323,7 @@ GuiBlendPixel (
   EFI_GRAPHICS_OUTPUT_BLT_PIXEL       OpacFrontPixel;
   CONST EFI_GRAPHICS_OUTPUT_BLT_PIXEL *FinalFrontPixel;
   //
-  // FIXME: Optimise with SIMD or such.
+  // Use GuiBlendRow for blending more than a single pixel.
   // qt_blend_argb32_on_argb32 in QT
   //
   ASSERT (BackPixel != NULL);
@@ -376,6 +387,473 @@ GuiBlendPixel (
   }
 }
 
+//
+// Blue/Red and Green/Alpha channels are processed at once as 16-bit lanes.
+//
+#define RGB_LANE_MASK  0x00FF00FFU
+
+//
+// RGB_APPLY_OPACITY for both lanes, exact for products of 8-bit values.
+//
+#define RGB_LANES_APPLY_OPACITY(Lanes, Opacity)                   \
+  ((((Lanes) * (Opacity) + 0x00010001U                            \
+    + ((((Lanes) * (Opacity)) >> 8U) & RGB_LANE_MASK)) >> 8U)     \
+    & RGB_LANE_MASK)
+
+//
+// Alpha of two pixels read as a 64-bit value.
+//
+#define RGB_PAIR_ALPHA_MASK  0xFF000000FF000000ULL
+
+//
+// Amount of pixels blended at once in fill-drawing.
+//
+#define GUI_FILL_ROW_SIZE  64U
+
+/**
+  Blend a pixel the same way GuiBlendPixel does.
+
+  @param[in] Back      Background pixel value.
+  @param[in] Front     Premultiplied foreground pixel value.
+  @param[in] Opacity   Foreground opacity.
+
+  @returns  Blended pixel value.
+**/
+STATIC
+UINT32
+InternalBlendPixelValue (
+  IN UINT32  Back,
+  IN UINT32  Front,
+  IN UINT32  Opacity
+  )
+{
+  UINT32  FrontRb;
+  UINT32  FrontAg;
+  UINT32  InvFrontOpacity;
+
+  FrontRb = Front & RGB_LANE_MASK;
+  FrontAg = (Front >> 8U) & RGB_LANE_MASK;
+
+  if (Opacity != 0xFF) {
+    FrontRb = RGB_LANES_APPLY_OPACITY (FrontRb, Opacity);
+    FrontAg = RGB_LANES_APPLY_OPACITY (FrontAg, Opacity);
+  }
+
+  if (FrontAg <= 0xFFFFU) {
+    return Back;
+  }
+
+  //
+  // Back alpha remains 0xFF with opaque background, so it is not special-cased.
+  //
+  InvFrontOpacity = 0xFF - (FrontAg >> 16U);
+
+  FrontRb += RGB_LANES_APPLY_OPACITY (Back & RGB_LANE_MASK, InvFrontOpacity);
+  FrontAg += RGB_LANES_APPLY_OPACITY ((Back >> 8U) & RGB_LANE_MASK, InvFrontOpacity);
+
+  return (FrontRb & RGB_LANE_MASK) | ((FrontAg & RGB_LANE_MASK) << 8U);
+}
+
+VOID
+GuiBlendRow (
+  IN OUT EFI_GRAPHICS_OUTPUT_BLT_PIXEL        *BackRow,
+  IN     CONST EFI_GRAPHICS_OUTPUT_BLT_PIXEL  *FrontRow,
+  IN     UINTN                                PixelCount,
+  IN     UINT8                                Opacity
+  )
+{
+  UINT32        *Back;
+  CONST UINT32  *Front;
+  UINT64        Low;
+  UINT64        High;
+  UINTN         Index;
+  UINTN         End;
+
+  ASSERT (BackRow != NULL || PixelCount == 0);
+  ASSERT (FrontRow != NULL || PixelCount == 0);
+
+  if (Opacity == 0) {
+    return;
+  }
+
+  Back  = (UINT32 *) BackRow;
+  Front = (CONST UINT32 *) FrontRow;
+
+  //
+  // Process four pixels at a time skipping fully transparent and copying
+  // fully opaque pixels.
+  //
+  Index = 0;
+  while (PixelCount - Index >= 4) {
+    Low  = ReadUnaligned64 ((CONST UINT64 *) &Front[Index]);
+    High = ReadUnaligned64 ((CONST UINT64 *) &Front[Index + 2]);
+
+    if (((Low | High) & RGB_PAIR_ALPHA_MASK) == 0) {
+      Index += 4;
+      continue;
+    }
+
+    if (Opacity == 0xFF && (Low & High & RGB_PAIR_ALPHA_MASK) == RGB_PAIR_ALPHA_MASK) {
+      //
+      // Copy the entire opaque run at once.
+      //
+      End = Index + 4;
+      while (PixelCount - End >= 2
+        && (ReadUnaligned64 ((CONST UINT64 *) &Front[End]) & RGB_PAIR_ALPHA_MASK) == RGB_PAIR_ALPHA_MASK) {
+        End += 2;
+      }
+
+      CopyMem (&Back[Index], &Front[Index], (End - Index) * sizeof (*Back));
+      Index = End;
+      continue;
+    }
+
+    End = Index + 4;
+    for (; Index < End; ++Index) {
+      Back[Index] = InternalBlendPixelValue (Back[Index], Front[Index], Opacity);
+    }
+  }
+
+  for (; Index < PixelCount; ++Index) {
+    Back[Index] = InternalBlendPixelValue (Back[Index], Front[Index], Opacity);
+  }
+}
+
+//
+// Image runs are stored as the type in the upper two bits and the length in
+// pixels in the rest.
+//
+#define GUI_IMAGE_RUN_TRANSPARENT  0U
+#define GUI_IMAGE_RUN_OPAQUE       1U
+#define GUI_IMAGE_RUN_MIXED        2U
+
+#define GUI_IMAGE_RUN_MAX_LENGTH   0x3FFFFFFFU
+
+#define GUI_IMAGE_RUN(Type, Length)  (((Type) << 30U) | (Length))
+#define GUI_IMAGE_RUN_TYPE(Run)      ((Run) >> 30U)
+#define GUI_IMAGE_RUN_LENGTH(Run)    ((Run) & GUI_IMAGE_RUN_MAX_LENGTH)
+
+#define GUI_IMAGE_RUN_PIXEL_TYPE(Pixel)                          \
+  ((Pixel).Reserved == 0    ? GUI_IMAGE_RUN_TRANSPARENT :        \
+   (Pixel).Reserved == 0xFF ? GUI_IMAGE_RUN_OPAQUE : GUI_IMAGE_RUN_MIXED)
+
+//
+// Shorter transparent and opaque runs are merged into mixed runs, as
+// GuiBlendRow handles them about as fast.
+//
+#define GUI_IMAGE_RUN_MIN_LENGTH  8U
+
+/**
+  Compute the runs of an image row.
+
+  @param[in]  Row    Image row.
+  @param[in]  Width  Image width.
+  @param[out] Runs   Runs of the row, optional when only counting them.
+
+  @returns  Amount of runs in the row.
+**/
+STATIC
+UINT32
+InternalImageRowRuns (
+  IN  CONST EFI_GRAPHICS_OUTPUT_BLT_PIXEL  *Row,
+  IN  UINT32                               Width,
+  OUT UINT32                               *Runs  OPTIONAL
+  )
+{
+  UINT32  RunCount;
+  UINT32  LastType;
+  UINT32  Type;
+  UINT32  Index;
+  UINT32  End;
+
+  RunCount = 0;
+  LastType = 0;
+
+  for (Index = 0; Index < Width; Index = End) {
+    Type = GUI_IMAGE_RUN_PIXEL_TYPE (Row[Index]);
+
+    End = Index + 1;
+    while (End < Width && GUI_IMAGE_RUN_PIXEL_TYPE (Row[End]) == Type) {
+      ++End;
+    }
+
+    if (Type != GUI_IMAGE_RUN_MIXED && End - Index < GUI_IMAGE_RUN_MIN_LENGTH) {
+      Type = GUI_IMAGE_RUN_MIXED;
+    }
+
+    if (RunCount > 0 && LastType == Type) {
+      if (Runs != NULL) {
+        Runs[RunCount - 1] += End - Index;
+      }
+    } else {
+      if (Runs != NULL) {
+        Runs[RunCount] = GUI_IMAGE_RUN (Type, End - Index);
+      }
+
+      LastType = Type;
+      ++RunCount;
+    }
+  }
+
+  return RunCount;
+}
+
+VOID
+GuiImageComputeRuns (
+  IN OUT GUI_IMAGE  *Image
+  )
+{
+  UINT32  RunCount;
+  UINT32  RunsSize;
+  UINT32  RowIndex;
+  UINT32  RowOffset;
+
+  ASSERT (Image != NULL);
+  ASSERT (Image->Buffer != NULL);
+
+  Image->Runs = NULL;
+
+  if (Image->Width > GUI_IMAGE_RUN_MAX_LENGTH) {
+    return;
+  }
+
+  //
+  // Runs[Row] is the index of the first run of each row and Runs[Height]
+  // is the index past the last run of the image.
+  //
+  RunCount = Image->Height + 1;
+  for (
+    RowIndex = 0, RowOffset = 0;
+    RowIndex < Image->Height;
+    ++RowIndex, RowOffset += Image->Width
+    ) {
+    RunCount += InternalImageRowRuns (&Image->Buffer[RowOffset], Image->Width, NULL);
+  }
+
+  if (OcOverflowMulU32 (RunCount, sizeof (*Image->Runs), &RunsSize)) {
+    return;
+  }
+
+  Image->Runs = AllocatePool (RunsSize);
+  if (Image->Runs == NULL) {
+    return;
+  }
+
+  RunCount = Image->Height + 1;
+  for (
+    RowIndex = 0, RowOffset = 0;
+    RowIndex < Image->Height;
+    ++RowIndex, RowOffset += Image->Width
+    ) {
+    Image->Runs[RowIndex] = RunCount;
+    RunCount += InternalImageRowRuns (
+                  &Image->Buffer[RowOffset],
+                  Image->Width,
+                  &Image->Runs[RunCount]
+                  );
+  }
+
+  Image->Runs[Image->Height] = RunCount;
+}
+
+VOID
+GuiImageFreeRuns (
+  IN OUT GUI_IMAGE  *Image
+  )
+{
+  ASSERT (Image != NULL);
+
+  if (Image->Runs != NULL) {
+    FreePool (Image->Runs);
+    Image->Runs = NULL;
+  }
+}
+
+/**
+  Blend a part of an image row using its runs.
+
+  @param[in,out] BackRow   Background row at the first column to draw.
+  @param[in]     FrontRow  Foreground image row.
+  @param[in]     Runs      Runs of the foreground image row.
+  @param[in]     RunCount  Amount of runs in the foreground image row.
+  @param[in]     OffsetX   First column of the foreground image row to draw.
+  @param[in]     Width     Amount of columns to draw.
+  @param[in]     Opacity   Foreground opacity.
+**/
+STATIC
+VOID
+InternalBlendRowRuns (
+  IN OUT EFI_GRAPHICS_OUTPUT_BLT_PIXEL        *BackRow,
+  IN     CONST EFI_GRAPHICS_OUTPUT_BLT_PIXEL  *FrontRow,
+  IN     CONST UINT32                         *Runs,
+  IN     UINT32                               RunCount,
+  IN     UINT32                               OffsetX,
+  IN     UINT32                               Width,
+  IN     UINT8                                Opacity
+  )
+{
+  UINT32  Index;
+  UINT32  RunStart;
+  UINT32  RunEnd;
+  UINT32  Start;
+  UINT32  End;
+
+  if (Opacity == 0) {
+    return;
+  }
+
+  for (
+    Index = 0, RunStart = 0;
+    Index < RunCount && RunStart < OffsetX + Width;
+    ++Index, RunStart = RunEnd
+    ) {
+    RunEnd = RunStart + GUI_IMAGE_RUN_LENGTH (Runs[Index]);
+    if (RunEnd <= OffsetX
+      || GUI_IMAGE_RUN_TYPE (Runs[Index]) == GUI_IMAGE_RUN_TRANSPARENT) {
+      continue;
+    }
+
+    Start = MAX (RunStart, OffsetX);
+    End   = MIN (RunEnd, OffsetX + Width);
+
+    if (Opacity == 0xFF && GUI_IMAGE_RUN_TYPE (Runs[Index]) == GUI_IMAGE_RUN_OPAQUE) {
+      CopyMem (
+        &BackRow[Start - OffsetX],
+        &FrontRow[Start],
+        (End - Start) * sizeof (*BackRow)
+        );
+    } else {
+      GuiBlendRow (
+        &BackRow[Start - OffsetX],
+        &FrontRow[Start],
+        End - Start,
+        Opacity
+        );
+    }
+  }
+}
+
+/**
+  Calculate the amount of pixels of a draw request.
+
+  @param[in] Request  Draw request.
+
+  @returns  Amount of pixels covered by Request.
+**/
+STATIC
+UINT32
+InternalDrawRequestArea (
+  IN CONST GUI_DRAW_REQUEST  *Request
+  )
+{
+  return (Request->MaxX - Request->MinX + 1) * (Request->MaxY - Request->MinY + 1);
+}
+
+/**
+  Merge two draw requests into the smallest rectangle covering both.
+
+  @param[in]  First     First draw request.
+  @param[in]  Second    Second draw request.
+  @param[out] Combined  Merged draw request.
+
+  @returns  Amount of pixels flushed by Combined, but requested by neither.
+**/
+STATIC
+UINT32
+InternalMergeDrawRequests (
+  IN  CONST GUI_DRAW_REQUEST  *First,
+  IN  CONST GUI_DRAW_REQUEST  *Second,
+  OUT GUI_DRAW_REQUEST        *Combined
+  )
+{
+  GUI_DRAW_REQUEST  Overlap;
+  UINT32            ActualArea;
+
+  Overlap.MinX = MAX (First->MinX, Second->MinX);
+  Overlap.MinY = MAX (First->MinY, Second->MinY);
+  Overlap.MaxX = MIN (First->MaxX, Second->MaxX);
+  Overlap.MaxY = MIN (First->MaxY, Second->MaxY);
+
+  ActualArea = InternalDrawRequestArea (First) + InternalDrawRequestArea (Second);
+  if (Overlap.MinX <= Overlap.MaxX && Overlap.MinY <= Overlap.MaxY) {
+    ActualArea -= InternalDrawRequestArea (&Overlap);
+  }
+
+  Combined->MinX = MIN (First->MinX, Second->MinX);
+  Combined->MinY = MIN (First->MinY, Second->MinY);
+  Combined->MaxX = MAX (First->MaxX, Second->MaxX);
+  Combined->MaxY = MAX (First->MaxY, Second->MaxY);
+
+  return InternalDrawRequestArea (Combined) - ActualArea;
+}
+
+/**
+  Add a rectangle to flush with the next frame, merging it with the pending
+  ones when this is cheaper than flushing them separately.
+
+  @param[in] Request  Draw request to add.
+**/
+STATIC
+VOID
+InternalAddDrawRequest (
+  IN CONST GUI_DRAW_REQUEST  *Request
+  )
+{
+  GUI_DRAW_REQUEST  ThisReq;
+  GUI_DRAW_REQUEST  CombReq;
+  GUI_DRAW_REQUEST  BestReq;
+  UINT32            Waste;
+  UINT32            BestWaste;
+  UINTN             BestIndex;
+  UINTN             Index;
+
+  CopyMem (&ThisReq, Request, sizeof (ThisReq));
+
+  Index = 0;
+  while (Index < mNumValidDrawReqs) {
+    Waste = InternalMergeDrawRequests (&mDrawRequests[Index], &ThisReq, &CombReq);
+    //
+    // Slow GOP calls warrant a larger cost, see the per-frame flush
+    // statistics logged with DEBUG_VERBOSE.
+    //
+    if (Waste > PcdGet32 (PcdOcGuiDrawMergeCost)) {
+      ++Index;
+      continue;
+    }
+    //
+    // The grown request may now be worth merging with the requests checked
+    // before, so start over.
+    //
+    CopyMem (&ThisReq, &CombReq, sizeof (ThisReq));
+    --mNumValidDrawReqs;
+    CopyMem (&mDrawRequests[Index], &mDrawRequests[mNumValidDrawReqs], sizeof (ThisReq));
+    Index = 0;
+  }
+
+  if (mNumValidDrawReqs == ARRAY_SIZE (mDrawRequests)) {
+    //
+    // Merge with the request adding the least pixels when out of space.
+    //
+    BestWaste = MAX_UINT32;
+    BestIndex = 0;
+    for (Index = 0; Index < mNumValidDrawReqs; ++Index) {
+      Waste = InternalMergeDrawRequests (&mDrawRequests[Index], &ThisReq, &CombReq);
+      if (Waste < BestWaste) {
+        BestWaste = Waste;
+        BestIndex = Index;
+        CopyMem (&BestReq, &CombReq, sizeof (BestReq));
+      }
+    }
+
+    CopyMem (&ThisReq, &BestReq, sizeof (ThisReq));
+    --mNumValidDrawReqs;
+    CopyMem (&mDrawRequests[BestIndex], &mDrawRequests[mNumValidDrawReqs], sizeof (ThisReq));
+  }
+
+  CopyMem (&mDrawRequests[mNumValidDrawReqs], &ThisReq, sizeof (ThisReq));
+  ++mNumValidDrawReqs;
+}
+
 VOID
 GuiDrawToBuffer (
   IN     CONST GUI_IMAGE      *Image,
@@ -399,37 +877,11 @@ GuiDrawToBuffer (
   UINT32                              RowIndex;
   UINT32                              SourceRowOffset;
   UINT32                              TargetRowOffset;
-  UINT32                              SourceColumnOffset;
-  UINT32                              TargetColumnOffset;
-  CONST EFI_GRAPHICS_OUTPUT_BLT_PIXEL *SourcePixel;
-  EFI_GRAPHICS_OUTPUT_BLT_PIXEL       *TargetPixel;
+  UINT32                              ColumnOffset;
+  EFI_GRAPHICS_OUTPUT_BLT_PIXEL       FillRow[GUI_FILL_ROW_SIZE];
   GUI_DRAW_REQUEST                    ThisReq;
   UINTN                               Index;
 
-  UINT32                              ThisArea;
-
-  UINT32                              ReqWidth;
-  UINT32                              ReqHeight;
-  UINT32                              ReqArea;
-
-  UINT32                              CombMinX;
-  UINT32                              CombMaxX;
-  UINT32                              CombMinY;
-  UINT32                              CombMaxY;
-  UINT32                              CombWidth;
-  UINT32                              CombHeight;
-  UINT32                              CombArea;
-
-  UINT32                              OverMinX;
-  UINT32                              OverMaxX;
-  UINT32                              OverMinY;
-  UINT32                              OverMaxY;
-  UINT32                              OverArea;
-  UINT32                              OverWidth;
-  UINT32                              OverHeight;
-
-  UINT32                              ActualArea;
-
   ASSERT (Image != NULL);
   ASSERT (DrawContext != NULL);
   ASSERT (DrawContext->Screen != NULL);
@@ -506,20 +958,29 @@ GuiDrawToBuffer (
         SourceRowOffset += Image->Width,
         TargetRowOffset += DrawContext->Screen->Width
       ) {
-      //
-      // Blend the row pixel-by-pixel.
-      //
-      for (
-        TargetColumnOffset = PosOffsetX, SourceColumnOffset = OffsetX;
-        TargetColumnOffset < PosOffsetX + Width;
-        ++TargetColumnOffset, ++SourceColumnOffset
-        ) {
-        TargetPixel = &mScreenBuffer[TargetRowOffset + PosBaseX + TargetColumnOffset];
-        SourcePixel = &Image->Buffer[SourceRowOffset + SourceColumnOffset];
-        GuiBlendPixel (TargetPixel, SourcePixel, Opacity);
+      if (Image->Runs != NULL) {
+        InternalBlendRowRuns (
+          &mScreenBuffer[TargetRowOffset + PosBaseX + PosOffsetX],
+          &Image->Buffer[SourceRowOffset],
+          &Image->Runs[Image->Runs[OffsetY + RowIndex]],
+          Image->Runs[OffsetY + RowIndex + 1] - Image->Runs[OffsetY + RowIndex],
+          OffsetX,
+          Width,
+          Opacity
+          );
+      } else {
+        GuiBlendRow (
+          &mScreenBuffer[TargetRowOffset + PosBaseX + PosOffsetX],
+          &Image->Buffer[SourceRowOffset + OffsetX],
+          Width,
+          Opacity
+          );
       }
     }
   } else {
+    for (Index = 0; Index < ARRAY_SIZE (FillRow); ++Index) {
+      CopyMem (&FillRow[Index], &Image->Buffer[0], sizeof (FillRow[Index]));
+    }
     //
     // Iterate over each row of the request.
     //
@@ -531,103 +992,33 @@ GuiDrawToBuffer (
         TargetRowOffset += DrawContext->Screen->Width
       ) {
       //
-      // Blend the row pixel-by-pixel with Source's (0,0).
+      // Blend the row with Source's (0,0) in parts.
       //
       for (
-        TargetColumnOffset = PosOffsetX;
-        TargetColumnOffset < PosOffsetX + Width;
-        ++TargetColumnOffset
+        ColumnOffset = 0;
+        ColumnOffset < Width;
+        ColumnOffset += GUI_FILL_ROW_SIZE
         ) {
-        TargetPixel = &mScreenBuffer[TargetRowOffset + PosBaseX + TargetColumnOffset];
-        GuiBlendPixel (TargetPixel, &Image->Buffer[0], Opacity);
+        GuiBlendRow (
+          &mScreenBuffer[TargetRowOffset + PosBaseX + PosOffsetX + ColumnOffset],
+          FillRow,
+          MIN (Width - ColumnOffset, GUI_FILL_ROW_SIZE),
+          Opacity
+          );
       }
     }
   }
 
   if (RequestDraw) {
     //
-    // Update the coordinates of the smallest rectangle covering all changes.
+    // Queue the changed rectangle for flushing with the next frame.
     //
     ThisReq.MinX = PosBaseX + PosOffsetX;
     ThisReq.MinY = PosBaseY + PosOffsetY;
     ThisReq.MaxX = PosBaseX + PosOffsetX + Width  - 1;
     ThisReq.MaxY = PosBaseY + PosOffsetY + Height - 1;
 
-    ThisArea = Width * Height;
-
-    for (Index = 0; Index < mNumValidDrawReqs; ++Index) {
-      //
-      // Calculate several dimensions to determine whether to merge the two
-      // draw requests for improved flushing performance.
-      //
-      ReqWidth  = mDrawRequests[Index].MaxX - mDrawRequests[Index].MinX + 1;
-      ReqHeight = mDrawRequests[Index].MaxY - mDrawRequests[Index].MinY + 1;
-      ReqArea   = ReqWidth * ReqHeight;
-
-      if (mDrawRequests[Index].MinX < ThisReq.MinX) {
-        CombMinX = mDrawRequests[Index].MinX;
-        OverMinX = ThisReq.MinX;
-      } else {
-        CombMinX = ThisReq.MinX;
-        OverMinX = mDrawRequests[Index].MinX;
-      }
-
-      if (mDrawRequests[Index].MaxX > ThisReq.MaxX) {
-        CombMaxX = mDrawRequests[Index].MaxX;
-        OverMaxX = ThisReq.MaxX;
-      } else {
-        CombMaxX = ThisReq.MaxX;
-        OverMaxX = mDrawRequests[Index].MaxX;
-      }
-
-      if (mDrawRequests[Index].MinY < ThisReq.MinY) {
-        CombMinY = mDrawRequests[Index].MinY;
-        OverMinY = ThisReq.MinY;
-      } else {
-        CombMinY = ThisReq.MinY;
-        OverMinY = mDrawRequests[Index].MinY;
-      }
-
-      if (mDrawRequests[Index].MaxY > ThisReq.MaxY) {
-        CombMaxY = mDrawRequests[Index].MaxY;
-        OverMaxY = ThisReq.MaxY;
-      } else {
-        CombMaxY = ThisReq.MaxY;
-        OverMaxY = mDrawRequests[Index].MaxY;
-      }
-
-      CombWidth  = CombMaxX - CombMinX + 1;
-      CombHeight = CombMaxY - CombMinY + 1;
-      CombArea   = CombWidth * CombHeight;
-
-      OverArea = 0;
-      if (OverMinX <= OverMaxX && OverMinY <= OverMaxY) {
-        OverWidth  = OverMaxX - OverMinX + 1;
-        OverHeight = OverMaxY - OverMinY + 1;
-        OverArea   = OverWidth * OverHeight;
-      }
-
-      ActualArea = ThisArea + ReqArea - OverArea;
-      //
-      // Two requests are merged when their combined actual draw area is at
-      // least 3/4 of the area needed to draw both at once.
-      //
-      if (4 * ActualArea >= 3 * CombArea) {
-        mDrawRequests[Index].MinX = CombMinX;
-        mDrawRequests[Index].MaxX = CombMaxX;
-        mDrawRequests[Index].MinY = CombMinY;
-        mDrawRequests[Index].MaxY = CombMaxY;
-        return;
-      }
-    }
-
-    if (mNumValidDrawReqs >= ARRAY_SIZE (mDrawRequests)) {
-      ASSERT (FALSE);
-      return;
-    }
-
-    CopyMem (&mDrawRequests[mNumValidDrawReqs], &ThisReq, sizeof (ThisReq));
-    ++mNumValidDrawReqs;
+    InternalAddDrawRequest (&ThisReq);
   }
 }
 
@@ -874,9 +1265,11 @@ GuiFlushScreen (
 
   UINTN   NumValidDrawReqs;
   UINTN   Index;
+  UINT64  Pixels;
 
   UINT64  EndTsc;
   UINT64  DeltaTsc;
+  UINT64  BlitTsc;
 
   BOOLEAN Interrupts;
 
@@ -911,10 +1304,12 @@ GuiFlushScreen (
     EndTsc = InternalCpuDelayTsc (mDeltaTscTarget - DeltaTsc);
   }
 
+  Pixels = 0;
   for (Index = 0; Index < NumValidDrawReqs; ++Index) {
     //
     // Due to above's loop, MaxX/Y correspond to Width and Height here.
     //
+    Pixels += mDrawRequests[Index].MaxX * mDrawRequests[Index].MaxY;
     GuiOutputBlt (
       mOutputContext,
       mScreenBuffer,
@@ -929,6 +1324,8 @@ GuiFlushScreen (
       );
   }
 
+  BlitTsc = AsmReadTsc () - EndTsc;
+
   if (Interrupts) {
     EnableInterrupts ();
   }
@@ -938,6 +1335,35 @@ GuiFlushScreen (
   // FIXME: GOP takes inconsistently long depending on dimensions.
   //
   mStartTsc = EndTsc;
+
+  //
+  // Time to first frame includes loading images ahead of the first picker run,
+  // so that it can be compared with the icon cache enabled and disabled.
+  //
+  if (mTotalFlushStats.Frames == 0) {
+    DEBUG ((
+      DEBUG_INFO,
+      "OCUI: First frame flushed in %Lu us, icon cache %a, %u hits %u misses\n",
+      DivU64x32 (GetTimeInNanoSecond (EndTsc - mConstructTsc + mGuiContext.ImageLoadTsc), 1000),
+      mGuiContext.IconCache.Root != NULL ? "enabled" : "disabled",
+      mGuiContext.IconCache.Hits,
+      mGuiContext.IconCache.Misses
+      ));
+    mGuiContext.ImageLoadTsc = 0;
+  }
+
+  DEBUG ((
+    DEBUG_VERBOSE,
+    "OCUI: Flushed %u rects, %Lu pixels in %Lu us\n",
+    (UINT32) NumValidDrawReqs,
+    Pixels,
+    DivU64x32 (GetTimeInNanoSecond (BlitTsc), 1000)
+    ));
+
+  ++mTotalFlushStats.Frames;
+  mTotalFlushStats.Rects   += NumValidDrawReqs;
+  mTotalFlushStats.Pixels  += Pixels;
+  mTotalFlushStats.BlitTsc += BlitTsc;
 }
 
 VOID
@@ -963,6 +1389,8 @@ GuiLibConstruct (
 {
   CONST EFI_GRAPHICS_OUTPUT_MODE_INFORMATION *OutputInfo;
 
+  mConstructTsc = AsmReadTsc ();
+
   mOutputContext = GuiOutputConstruct ();
   if (mOutputContext == NULL) {
     DEBUG ((DEBUG_WARN, "OCUI: Failed to initialise output\n"));
@@ -1012,6 +1440,8 @@ GuiLibConstruct (
 
   mDeltaTscTarget =  DivU64x32 (OcGetTSCFrequency (), 60);
 
+  ZeroMem (&mTotalFlushStats, sizeof (mTotalFlushStats));
+
   mScreenViewCursor.X = CursorDefaultX;
   mScreenViewCursor.Y = CursorDefaultY;
 
@@ -1023,6 +1453,18 @@ GuiLibDestruct (
   VOID
   )
 {
+  if (mTotalFlushStats.Frames > 0) {
+    DEBUG ((
+      DEBUG_INFO,
+      "OCUI: Flushed %Lu frames, %Lu rects, %Lu pixels in %Lu us\n",
+      mTotalFlushStats.Frames,
+      mTotalFlushStats.Rects,
+      mTotalFlushStats.Pixels,
+      DivU64x32 (GetTimeInNanoSecond (mTotalFlushStats.BlitTsc), 1000)
+      ));
+    ZeroMem (&mTotalFlushStats, sizeof (mTotalFlushStats));
+  }
+
   if (mOutputContext != NULL) {
     GuiOutputDestruct (mOutputContext);
     mOutputContext = NULL;
@@ -1280,6 +1722,27 @@ GuiClearScreen (
     );
 }
 
+BOOLEAN
+GuiIconMatchesDimensions (
+  IN CONST GUI_IMAGE  *Image,
+  IN UINT8            Scale,
+  IN UINT32           MatchWidth,
+  IN UINT32           MatchHeight,
+  IN BOOLEAN          AllowLess
+  )
+{
+  if (MatchWidth == 0 || MatchHeight == 0) {
+    return TRUE;
+  }
+
+  if (AllowLess) {
+    return Image->Width <= MatchWidth * Scale && Image->Height <= MatchWidth * Scale
+      && Image->Width != 0 && Image->Height != 0;
+  }
+
+  return Image->Width == MatchWidth * Scale && Image->Height == MatchHeight * Scale;
+}
+
 EFI_STATUS
 GuiIcnsToImageIcon (
   OUT GUI_IMAGE  *Image,
@@ -1346,11 +1809,9 @@ GuiIcnsToImageIcon (
         TRUE
         );
 
-      if (!EFI_ERROR (Status) && MatchWidth > 0 && MatchHeight > 0) {
-        if (AllowLess
-          ? (Image->Width >  MatchWidth * Scale || Image->Height >  MatchWidth * Scale
-          || Image->Width == 0 || Image->Height == 0)
-          : (Image->Width != MatchWidth * Scale || Image->Height != MatchHeight * Scale)) {
+      if (!EFI_ERROR (Status)) {
+        if (!GuiIconMatchesDimensions (Image, Scale, MatchWidth, MatchHeight, AllowLess)) {
+          GuiImageFreeRuns (Image);
           FreePool (Image->Buffer);
           DEBUG ((
             DEBUG_INFO,
@@ -1403,6 +1864,7 @@ GuiIcnsToImageIcon (
           return EFI_UNSUPPORTED;
         }
 
+        GuiImageComputeRuns (Image);
         return EFI_SUCCESS;
       }
     }
@@ -1465,6 +1927,7 @@ GuiLabelToImage (
     }
   }
 
+  GuiImageComputeRuns (Image);
   return EFI_SUCCESS;
 }
 
@@ -1506,6 +1969,7 @@ GuiPngToImage (
     }
   }
 
+  GuiImageComputeRuns (Image);
   return EFI_SUCCESS;
 }
 
@@ -1586,6 +2050,7 @@ GuiCreateHighlightedImage (
   SelectedImage->Width  = SourceImage->Width;
   SelectedImage->Height = SourceImage->Height;
   SelectedImage->Buffer = Buffer;
+  GuiImageComputeRuns (SelectedImage);
   return EFI_SUCCESS;
 }
 
@@ -101,8 +101,32 @@ typedef struct {
   UINT32                        Width;
   UINT32                        Height;
   EFI_GRAPHICS_OUTPUT_BLT_PIXEL *Buffer;
+  ///
+  /// Per-row transparent, opaque and mixed pixel runs, see GuiImageComputeRuns.
+  /// NULL when not available.
+  ///
+  UINT32                        *Runs;
 } GUI_IMAGE;
 
+typedef struct {
+  ///
+  /// Amount of frames flushed.
+  ///
+  UINT64 Frames;
+  ///
+  /// Amount of rectangles passed to GOP.
+  ///
+  UINT64 Rects;
+  ///
+  /// Amount of pixels passed to GOP.
+  ///
+  UINT64 Pixels;
+  ///
+  /// TSC ticks spent in GOP.
+  ///
+  UINT64 BlitTsc;
+} GUI_FLUSH_STATS;
+
 typedef struct GUI_SCREEN_CURSOR_ GUI_SCREEN_CURSOR;
 
 typedef
@@ -143,6 +167,26 @@ GuiPngToImage (
   IN  BOOLEAN    PremultiplyAlpha
   );
   
+/**
+  Check whether an icon has the dimensions required by GuiIcnsToImageIcon.
+
+  @param[in] Image        Decoded icon.
+  @param[in] Scale        Icon scale.
+  @param[in] MatchWidth   Required width at scale 1, 0 for any.
+  @param[in] MatchHeight  Required height at scale 1, 0 for any.
+  @param[in] AllowLess    Whether smaller icons are allowed.
+
+  @returns  Whether the icon dimensions are acceptable.
+**/
+BOOLEAN
+GuiIconMatchesDimensions (
+  IN CONST GUI_IMAGE  *Image,
+  IN UINT8            Scale,
+  IN UINT32           MatchWidth,
+  IN UINT32           MatchHeight,
+  IN BOOLEAN          AllowLess
+  );
+
 EFI_STATUS
 GuiIcnsToImageIcon (
   OUT GUI_IMAGE  *Image,
@@ -281,6 +325,45 @@ GuiBlendPixel (
   IN     UINT8                                Opacity
   );
 
+/**
+  Blend a row of premultiplied pixels the same way GuiBlendPixel does.
+  Fully transparent and fully opaque runs are processed at once.
+
+  @param[in,out] BackRow     Background row.
+  @param[in]     FrontRow    Foreground row.
+  @param[in]     PixelCount  Number of pixels in the rows.
+  @param[in]     Opacity     Foreground opacity.
+**/
+VOID
+GuiBlendRow (
+  IN OUT EFI_GRAPHICS_OUTPUT_BLT_PIXEL        *BackRow,
+  IN     CONST EFI_GRAPHICS_OUTPUT_BLT_PIXEL  *FrontRow,
+  IN     UINTN                                PixelCount,
+  IN     UINT8                                Opacity
+  );
+
+/**
+  Compute per-row runs of fully transparent, fully opaque and mixed pixels,
+  which let GuiDrawToBuffer skip or copy pixels without inspecting them.
+  Image->Runs is set to NULL when they cannot be allocated.
+
+  @param[in,out] Image  Image to compute the runs for.
+**/
+VOID
+GuiImageComputeRuns (
+  IN OUT GUI_IMAGE  *Image
+  );
+
+/**
+  Free per-row runs computed by GuiImageComputeRuns.
+
+  @param[in,out] Image  Image to free the runs of.
+**/
+VOID
+GuiImageFreeRuns (
+  IN OUT GUI_IMAGE  *Image
+  );
+
 EFI_STATUS
 GuiCreateHighlightedImage (
   OUT GUI_IMAGE                            *SelectedImage,
@@ -709,15 +709,16 @@ CopyLabel (
     return EFI_OUT_OF_RESOURCES;
   }
 
+  GuiImageComputeRuns (Destination);
   return EFI_SUCCESS;
 }
 
 EFI_STATUS
 BootPickerEntriesAdd (
-  IN OC_PICKER_CONTEXT              *Context,
-  IN CONST BOOT_PICKER_GUI_CONTEXT  *GuiContext,
-  IN OC_BOOT_ENTRY                  *Entry,
-  IN BOOLEAN                        Default
+  IN     OC_PICKER_CONTEXT          *Context,
+  IN OUT BOOT_PICKER_GUI_CONTEXT    *GuiContext,
+  IN     OC_BOOT_ENTRY              *Entry,
+  IN     BOOLEAN                    Default
   )
 {
   EFI_STATUS                  Status;
@@ -829,7 +830,8 @@ BootPickerEntriesAdd (
     Status = Context->GetEntryIcon (Context, Entry, &IconFileData, &IconFileSize);
 
     if (!EFI_ERROR (Status)) {
-      Status = GuiIcnsToImageIcon (
+      Status = GuiIcnsToImageIconCached (
+        &GuiContext->IconCache,
         &VolumeEntry->EntryIcon,
         IconFileData,
         IconFileSize,
@@ -949,9 +951,11 @@ InternalBootPickerEntryDestruct (
   ASSERT (Entry->Label.Buffer != NULL);
 
   if (Entry->CustomIcon) {
+    GuiImageFreeRuns (&Entry->EntryIcon);
     FreePool (Entry->EntryIcon.Buffer);
   }
 
+  GuiImageFreeRuns (&Entry->Label);
   FreePool (Entry->Label.Buffer);
   FreePool (Entry);
 }
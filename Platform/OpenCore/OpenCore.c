@@ -90,6 +90,11 @@ OcStartImage (
     LaunchInText ? EfiConsoleControlScreenText : EfiConsoleControlScreenGraphics
     );
 
+  //
+  // Log file cannot be written once the loader calls ExitBootServices.
+  //
+  OcSaveLog ();
+
   Status = gBS->StartImage (
     ImageHandle,
     ExitDataSize,
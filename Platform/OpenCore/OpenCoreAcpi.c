@@ -32,13 +32,21 @@ OcAcpiAddTables (
   )
 {
   EFI_STATUS           Status;
-  UINT8                *TableData;
+  VOID                 *TableData;
   UINT32               TableDataLength;
+  UINT32               TableBufferSize;
   UINT32               Index;
   OC_ACPI_ADD_ENTRY    *Table;
   CONST CHAR8          *TablePath;
   CHAR16               FullPath[OC_STORAGE_SAFE_PATH_MAX];
 
+  //
+  // Tables are copied to ACPI memory on insertion, so one scratch buffer
+  // grown on demand is reused for reading all of them.
+  //
+  TableData       = NULL;
+  TableBufferSize = 0;
+
   for (Index = 0; Index < Config->Acpi.Add.Count; ++Index) {
     Table = Config->Acpi.Add.Values[Index];
     TablePath = OC_BLOB_GET (&Table->Path);
@@ -61,9 +69,19 @@ OcAcpiAddTables (
 
     UnicodeUefiSlashes (FullPath);
 
-    TableData = OcStorageReadFileUnicode (Storage, FullPath, &TableDataLength);
+    Status = OcStorageReadFileUnicodeEx (Storage, FullPath, &TableData, TableBufferSize, &TableDataLength);
+
+    if (Status == EFI_BUFFER_TOO_SMALL) {
+      //
+      // Drop the scratch buffer, so that the next read allocates a larger one.
+      //
+      FreePool (TableData);
+      TableData       = NULL;
+      TableBufferSize = 0;
+      Status = OcStorageReadFileUnicodeEx (Storage, FullPath, &TableData, 0, &TableDataLength);
+    }
 
-    if (TableData == NULL) {
+    if (EFI_ERROR (Status)) {
       DEBUG ((
         DEBUG_WARN,
         "OC: Failed to find ACPI %a\n",
@@ -72,6 +90,10 @@ OcAcpiAddTables (
       continue;
     }
 
+    if (TableBufferSize == 0) {
+      TableBufferSize = TableDataLength + 2;
+    }
+
     Status = AcpiInsertTable (Context, TableData, TableDataLength);
 
     if (EFI_ERROR (Status)) {
@@ -83,6 +105,10 @@ OcAcpiAddTables (
         ));
     }
   }
+
+  if (TableData != NULL) {
+    FreePool (TableData);
+  }
 }
 
 STATIC
@@ -59,6 +59,58 @@ OcKernelApplyQuirk (
   return EFI_UNSUPPORTED;
 }
 
+STATIC
+VOID
+OcKernelApplyKextPatches (
+  IN     OC_GLOBAL_CONFIG       *Config,
+  IN     KERNEL_CACHE_TYPE      CacheType,
+  IN     VOID                   *Context,
+  IN OUT PATCHER_GENERIC_PATCH  *Patches,
+  IN OUT UINT32                 *Indices,
+  IN     UINT32                 Count,
+     OUT EFI_STATUS             *Results
+  )
+{
+  PATCHER_GENERIC_PATCH  Patch;
+  CONST CHAR8            *Target;
+  UINT32                 PatchIndex;
+  UINT32                 Start;
+  UINT32                 End;
+  UINT32                 Index;
+  UINT32                 Index2;
+
+  for (Start = 0; Start < Count; Start = End) {
+    Target = OC_BLOB_GET (&Config->Kernel.Patch.Values[Indices[Start]]->Identifier);
+
+    //
+    // Move later patches for the same kext right after the first one,
+    // keeping their order, and apply them all at once.
+    //
+    End = Start + 1;
+    for (Index = End; Index < Count; ++Index) {
+      if (AsciiStrCmp (OC_BLOB_GET (&Config->Kernel.Patch.Values[Indices[Index]]->Identifier), Target) != 0) {
+        continue;
+      }
+
+      CopyMem (&Patch, &Patches[Index], sizeof (Patch));
+      PatchIndex = Indices[Index];
+      for (Index2 = Index; Index2 > End; --Index2) {
+        CopyMem (&Patches[Index2], &Patches[Index2 - 1], sizeof (Patch));
+        Indices[Index2] = Indices[Index2 - 1];
+      }
+      CopyMem (&Patches[End], &Patch, sizeof (Patch));
+      Indices[End] = PatchIndex;
+      ++End;
+    }
+
+    if (CacheType == CacheTypeMkext) {
+      MkextContextApplyPatches (Context, Target, &Patches[Start], End - Start, &Results[Start]);
+    } else if (CacheType == CacheTypePrelinked) {
+      PrelinkedContextApplyPatches (Context, Target, &Patches[Start], End - Start, &Results[Start]);
+    }
+  }
+}
+
 VOID
 OcKernelApplyPatches (
   IN     OC_GLOBAL_CONFIG  *Config,
@@ -82,8 +134,16 @@ OcKernelApplyPatches (
   UINT32                 MaxKernel;
   UINT32                 MinKernel;
   BOOLEAN                IsKernelPatch;
+  PATCHER_GENERIC_PATCH  *BatchPatches;
+  UINT32                 *BatchIndices;
+  EFI_STATUS             *BatchResults;
+  UINT32                 BatchCount;
 
   IsKernelPatch = Context == NULL;
+  BatchPatches  = NULL;
+  BatchIndices  = NULL;
+  BatchResults  = NULL;
+  BatchCount    = 0;
 
   if (IsKernelPatch) {
     ASSERT (Kernel != NULL);
@@ -101,6 +161,29 @@ OcKernelApplyPatches (
     }
   }
 
+  //
+  // Patches are applied in a single pass over the kernel or every patched kext.
+  // Cacheless patches are only queued here and are batched when the kext loads.
+  // Fallback to applying them one by one if we are out of memory.
+  //
+  if ((IsKernelPatch || CacheType != CacheTypeCacheless) && Config->Kernel.Patch.Count > 0) {
+    BatchPatches = AllocatePool (Config->Kernel.Patch.Count * sizeof (*BatchPatches));
+    BatchIndices = AllocatePool (Config->Kernel.Patch.Count * sizeof (*BatchIndices));
+    BatchResults = AllocatePool (Config->Kernel.Patch.Count * sizeof (*BatchResults));
+    if (BatchPatches == NULL || BatchIndices == NULL || BatchResults == NULL) {
+      if (BatchPatches != NULL) {
+        FreePool (BatchPatches);
+        BatchPatches = NULL;
+      }
+      if (BatchIndices != NULL) {
+        FreePool (BatchIndices);
+      }
+      if (BatchResults != NULL) {
+        FreePool (BatchResults);
+      }
+    }
+  }
+
   for (Index = 0; Index < Config->Kernel.Patch.Count; ++Index) {
     UserPatch = Config->Kernel.Patch.Values[Index];
     Target    = OC_BLOB_GET (&UserPatch->Identifier);
@@ -125,7 +208,7 @@ OcKernelApplyPatches (
         Arch,
         Is32Bit ? "i386" : "x86_64"
         ));
-      return;
+      continue;
     }
 
     if (!OcMatchDarwinVersion (DarwinVersion, MinKernel, MaxKernel)) {
@@ -187,6 +270,13 @@ OcKernelApplyPatches (
     Patch.Skip    = UserPatch->Skip;
     Patch.Limit   = UserPatch->Limit;
 
+    if (BatchPatches != NULL) {
+      CopyMem (&BatchPatches[BatchCount], &Patch, sizeof (Patch));
+      BatchIndices[BatchCount] = Index;
+      ++BatchCount;
+      continue;
+    }
+
     if (IsKernelPatch) {
       Status = PatcherApplyGenericPatch (&KernelPatcher, &Patch);
     } else {
@@ -210,6 +300,39 @@ OcKernelApplyPatches (
       ));
   }
 
+  if (BatchPatches != NULL) {
+    if (IsKernelPatch) {
+      PatcherApplyGenericPatches (&KernelPatcher, BatchPatches, BatchCount, BatchResults);
+    } else {
+      OcKernelApplyKextPatches (
+        Config,
+        CacheType,
+        Context,
+        BatchPatches,
+        BatchIndices,
+        BatchCount,
+        BatchResults
+        );
+    }
+
+    for (Index = 0; Index < BatchCount; ++Index) {
+      UserPatch = Config->Kernel.Patch.Values[BatchIndices[Index]];
+      DEBUG ((
+        EFI_ERROR (BatchResults[Index]) ? DEBUG_WARN : DEBUG_INFO,
+        "OC: %a patcher result %u for %a (%a) - %r\n",
+        PRINT_KERNEL_CACHE_TYPE (CacheType),
+        BatchIndices[Index],
+        OC_BLOB_GET (&UserPatch->Identifier),
+        OC_BLOB_GET (&UserPatch->Comment),
+        BatchResults[Index]
+        ));
+    }
+
+    FreePool (BatchPatches);
+    FreePool (BatchIndices);
+    FreePool (BatchResults);
+  }
+
   //
   // Handle Quirks/Emulate here...
   //
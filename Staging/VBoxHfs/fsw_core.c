@@ -44,9 +44,14 @@
 
 static struct fsw_dnode *fsw_vol_lookup_dnode_id(struct fsw_volume *vol, fsw_u32 dnode_id);
 static void fsw_blockcache_free(struct fsw_volume *vol);
+static fsw_status_t fsw_block_read_direct(struct fsw_volume *vol, fsw_u32 phys_bno, fsw_u32 count, fsw_u8 *buffer);
 
 #define MAX_CACHE_LEVEL (5)
 
+#define FSW_BCACHE_NIL          (~0U)
+#define FSW_BCACHE_MIN_SIZE     (16)
+#define FSW_BCACHE_MAX_SIZE     (1U << 24)
+
 
 /**
  * Mount a volume with a given file system driver. This function is called by the
@@ -82,6 +87,7 @@ fsw_status_t fsw_mount(void *host_data,
     vol->host_table     = host_table;
     vol->fstype_table   = fstype_table;
     vol->host_string_kind = host_table->native_string_kind;
+    vol->bcache_budget  = FSW_BCACHE_BUDGET;
 
     // let the fs driver mount the file system
     status = vol->fstype_table->volume_mount(vol);
@@ -115,6 +121,10 @@ void fsw_unmount(struct fsw_volume *vol)
 
     vol->fstype_table->volume_free(vol);
 
+    FSW_MSG_DEBUG((FSW_MSGSTR("fsw_unmount: block cache %u hits, %u misses, %u evictions, %u read ahead\n"),
+                   vol->bcache_stat.hits, vol->bcache_stat.misses, vol->bcache_stat.evictions,
+                   vol->bcache_stat.readahead));
+
     fsw_blockcache_free(vol);
     fsw_string_mkempty(&vol->label);
     fsw_free(vol);
@@ -162,6 +172,209 @@ void fsw_set_blocksize(struct fsw_volume *vol, fsw_u32 phys_blocksize, fsw_u32 l
     vol->log_blocksize = log_blocksize;
 }
 
+/**
+ * Find the hash bucket of a physical block number.
+ */
+
+static fsw_u32 fsw_blockcache_bucket(struct fsw_volume *vol, fsw_u32 phys_bno)
+{
+    // multiplicative hashing, the upper bits are the best mixed
+    return (fsw_u32)(phys_bno * 0x9E3779B1U) >> vol->bcache_hash_shift;
+}
+
+/**
+ * Find the block cache entry holding a physical block. Returns FSW_BCACHE_NIL
+ * if the block is not cached.
+ */
+
+static fsw_u32 fsw_blockcache_lookup(struct fsw_volume *vol, fsw_u32 phys_bno)
+{
+    fsw_u32 i;
+
+    if (vol->bcache_hash == NULL)
+        return FSW_BCACHE_NIL;
+
+    for (i = vol->bcache_hash[fsw_blockcache_bucket(vol, phys_bno)]; i != FSW_BCACHE_NIL; i = vol->bcache[i].hash_next) {
+        if (vol->bcache[i].phys_bno == phys_bno)
+            return i;
+    }
+
+    return FSW_BCACHE_NIL;
+}
+
+/**
+ * Remove a valid block cache entry from its hash chain.
+ */
+
+static void fsw_blockcache_unlink(struct fsw_volume *vol, fsw_u32 i)
+{
+    fsw_u32 *link;
+
+    link = &vol->bcache_hash[fsw_blockcache_bucket(vol, vol->bcache[i].phys_bno)];
+    while (*link != i)
+        link = &vol->bcache[*link].hash_next;
+    *link = vol->bcache[i].hash_next;
+}
+
+/**
+ * Resize the block cache table to hold new_size entries and rebuild the hash.
+ * The table cannot shrink. On failure the current table is kept intact.
+ */
+
+static fsw_status_t fsw_blockcache_resize(struct fsw_volume *vol, fsw_u32 new_size)
+{
+    fsw_status_t    status;
+    fsw_u32         i;
+    fsw_u32         b;
+    fsw_u32         hash_bits;
+    struct fsw_blockcache *new_bcache;
+    fsw_u32         *new_hash;
+
+    // at least as many buckets as entries
+    hash_bits = 4;
+    while ((1U << hash_bits) < new_size)
+        hash_bits++;
+
+    status = fsw_alloc(new_size * sizeof(struct fsw_blockcache), &new_bcache);
+    if (status != FSW_SUCCESS)
+        return status;
+    status = fsw_alloc((1U << hash_bits) * sizeof(fsw_u32), &new_hash);
+    if (status != FSW_SUCCESS) {
+        fsw_free(new_bcache);
+        return status;
+    }
+
+    if (vol->bcache_size > 0)
+        fsw_memcpy(new_bcache, vol->bcache, vol->bcache_size * sizeof(struct fsw_blockcache));
+    for (i = vol->bcache_size; i < new_size; i++) {
+        new_bcache[i].refcount = 0;
+        new_bcache[i].cache_level = 0;
+        new_bcache[i].phys_bno = FSW_INVALID_BNO;
+        new_bcache[i].credit = 0;
+        new_bcache[i].data = NULL;
+    }
+
+    // switch caches
+    fsw_free(vol->bcache);
+    fsw_free(vol->bcache_hash);
+    vol->bcache = new_bcache;
+    vol->bcache_size = new_size;
+    vol->bcache_hash = new_hash;
+    vol->bcache_hash_shift = 32 - hash_bits;
+
+    // rehash valid entries
+    for (b = 0; b < (1U << hash_bits); b++)
+        new_hash[b] = FSW_BCACHE_NIL;
+    for (i = 0; i < new_size; i++) {
+        new_bcache[i].hash_next = FSW_BCACHE_NIL;
+        if (new_bcache[i].phys_bno != FSW_INVALID_BNO) {
+            b = fsw_blockcache_bucket(vol, new_bcache[i].phys_bno);
+            new_bcache[i].hash_next = new_hash[b];
+            new_hash[b] = i;
+        }
+    }
+
+    return FSW_SUCCESS;
+}
+
+/**
+ * Choose a block cache entry to reuse. Free entries are taken right away. Otherwise
+ * the clock hand sweeps over the table: every pass over an unreferenced block uses up
+ * one credit, and a block without credit left is evicted. Since blocks get one credit
+ * per cache level on each access, blocks with a low level are purged first, and among
+ * the blocks of one level the least recently used ones go first.
+ * Returns FSW_BCACHE_NIL if all entries are referenced.
+ */
+
+static fsw_u32 fsw_blockcache_victim(struct fsw_volume *vol)
+{
+    fsw_u32 steps;
+    fsw_u32 i;
+    struct fsw_blockcache *entry;
+
+    // enough steps to drain the credit of any unreferenced entry
+    for (steps = vol->bcache_size * (MAX_CACHE_LEVEL + 2); steps > 0; steps--) {
+        i = vol->bcache_clock;
+        vol->bcache_clock = (i + 1 < vol->bcache_size) ? i + 1 : 0;
+
+        entry = &vol->bcache[i];
+        if (entry->phys_bno == FSW_INVALID_BNO)
+            return i;
+        if (entry->refcount > 0)
+            continue;
+        if (entry->credit == 0)
+            return i;
+        entry->credit--;
+    }
+
+    return FSW_BCACHE_NIL;
+}
+
+/**
+ * Get an unused block cache entry with a data buffer, evicting another block or
+ * enlarging the cache if needed. The entry is not linked into the hash.
+ */
+
+static fsw_status_t fsw_blockcache_alloc_entry(struct fsw_volume *vol, fsw_u32 *index_out)
+{
+    fsw_status_t    status;
+    fsw_u32         i;
+    fsw_u32         new_bcache_size;
+
+    // create the cache sized to the budget
+    if (vol->bcache_size == 0) {
+        new_bcache_size = vol->bcache_budget / vol->phys_blocksize;
+        if (new_bcache_size < FSW_BCACHE_MIN_SIZE)
+            new_bcache_size = FSW_BCACHE_MIN_SIZE;
+        if (new_bcache_size > FSW_BCACHE_MAX_SIZE)
+            new_bcache_size = FSW_BCACHE_MAX_SIZE;
+        status = fsw_blockcache_resize(vol, new_bcache_size);
+        if (status != FSW_SUCCESS)
+            return status;
+    }
+
+    // find a free or evictable entry in the cache table
+    i = fsw_blockcache_victim(vol);
+    if (i == FSW_BCACHE_NIL) {
+        // enlarge the cache, all blocks are in use
+        if (vol->bcache_size >= FSW_BCACHE_MAX_SIZE)
+            return FSW_OUT_OF_MEMORY;
+        i = vol->bcache_size;
+        status = fsw_blockcache_resize(vol, vol->bcache_size << 1);
+        if (status != FSW_SUCCESS)
+            return status;
+    } else if (vol->bcache[i].phys_bno != FSW_INVALID_BNO) {
+        fsw_blockcache_unlink(vol, i);
+        vol->bcache[i].phys_bno = FSW_INVALID_BNO;
+        vol->bcache_stat.evictions++;
+    }
+
+    if (vol->bcache[i].data == NULL) {
+        status = fsw_alloc(vol->phys_blocksize, &vol->bcache[i].data);
+        if (status != FSW_SUCCESS)
+            return status;
+    }
+
+    *index_out = i;
+    return FSW_SUCCESS;
+}
+
+/**
+ * Make a block cache entry hold a physical block and add it to the hash.
+ */
+
+static void fsw_blockcache_link(struct fsw_volume *vol, fsw_u32 i, fsw_u32 phys_bno, fsw_u32 cache_level)
+{
+    fsw_u32 b;
+
+    b = fsw_blockcache_bucket(vol, phys_bno);
+    vol->bcache[i].phys_bno = phys_bno;
+    vol->bcache[i].cache_level = cache_level;
+    vol->bcache[i].credit = cache_level + 1;
+    vol->bcache[i].hash_next = vol->bcache_hash[b];
+    vol->bcache_hash[b] = i;
+}
+
 /**
  * Get a block of data from the disk. This function is called by the file system driver
  * or by core functions. It calls through to the host driver's device access routine.
@@ -175,6 +388,9 @@ void fsw_set_blocksize(struct fsw_volume *vol, fsw_u32 phys_blocksize, fsw_u32 l
  *  - 2: File system metadata
  *  - 3..5: File system metadata with a high rate of access
  *
+ * The block cache is limited to bcache_budget bytes of block data. It only grows past
+ * the limit when all cached blocks are in use.
+ *
  * If this function returns successfully, the returned data pointer is valid until the
  * caller calls fsw_block_release.
  */
@@ -183,7 +399,7 @@ fsw_status_t fsw_block_get(struct VOLSTRUCTNAME *vol, fsw_u32 phys_bno, fsw_u32
 {
     fsw_status_t    status;
     fsw_u32         i;
-    struct fsw_blockcache *new_bcache = NULL;
+    struct fsw_blockcache *entry;
 
     // TODO: allow the host driver to do its own caching; just call through if
     //  the appropriate function pointers are set
@@ -192,76 +408,113 @@ fsw_status_t fsw_block_get(struct VOLSTRUCTNAME *vol, fsw_u32 phys_bno, fsw_u32
         cache_level = MAX_CACHE_LEVEL;
 
     // check block cache
-    for (i = 0; i < vol->bcache_size; i++) {
-        if (vol->bcache[i].phys_bno == phys_bno) {
-            // cache hit!
-            if (vol->bcache[i].cache_level < cache_level)
-                vol->bcache[i].cache_level = cache_level;  // promote the entry
-            vol->bcache[i].refcount++;
-            *buffer_out = vol->bcache[i].data;
-            return FSW_SUCCESS;
-        }
+    i = fsw_blockcache_lookup(vol, phys_bno);
+    if (i != FSW_BCACHE_NIL) {
+        // cache hit!
+        entry = &vol->bcache[i];
+        if (entry->cache_level < cache_level)
+            entry->cache_level = cache_level;  // promote the entry
+        entry->credit = entry->cache_level + 1;
+        entry->refcount++;
+        vol->bcache_stat.hits++;
+        *buffer_out = entry->data;
+        return FSW_SUCCESS;
     }
+    vol->bcache_stat.misses++;
 
-    // find a free entry in the cache table
-    for (i = 0; i < vol->bcache_size; i++) {
-        if (vol->bcache[i].phys_bno == FSW_INVALID_BNO)
+    status = fsw_blockcache_alloc_entry(vol, &i);
+    if (status != FSW_SUCCESS)
+        return status;
+    entry = &vol->bcache[i];
+
+    // read the data
+    status = vol->host_table->read_block(vol, phys_bno, entry->data);
+    if (status != FSW_SUCCESS)
+        return status;
+
+    fsw_blockcache_link(vol, i, phys_bno, cache_level);
+    entry->refcount = 1;
+    *buffer_out = entry->data;
+    return FSW_SUCCESS;
+}
+
+/**
+ * Read a run of blocks into the block cache ahead of their use. This function is called
+ * by the file system driver when it expects the blocks following phys_bno to be needed
+ * soon. Nothing is done if phys_bno is already cached. Otherwise phys_bno and the blocks
+ * after it up to the first cached one, but no more than count blocks in total, are read
+ * with a single device request and added to the cache unreferenced.
+ *
+ * Failures are not fatal for the caller, the blocks are simply read on demand later.
+ */
+
+fsw_status_t fsw_block_readahead(struct VOLSTRUCTNAME *vol, fsw_u32 phys_bno, fsw_u32 count, fsw_u32 cache_level)
+{
+    fsw_status_t    status;
+    fsw_u32         i;
+    fsw_u32         n;
+    fsw_u8          *buffer;
+
+    if (vol->host_table->read_blocks == NULL)
+        return FSW_UNSUPPORTED;
+
+    if (cache_level > MAX_CACHE_LEVEL)
+        cache_level = MAX_CACHE_LEVEL;
+
+    // do not let readahead flush the cache
+    if (vol->bcache_size > 0 && count > vol->bcache_size / 4)
+        count = vol->bcache_size / 4;
+
+    for (n = 0; n < count && phys_bno + n >= phys_bno; n++) {
+        if (fsw_blockcache_lookup(vol, phys_bno + n) != FSW_BCACHE_NIL)
             break;
     }
-    if (i >= vol->bcache_size) {
-        fsw_u32 discard_level;
+    if (n < 2)
+        return FSW_SUCCESS;
 
-        for (discard_level = 0; discard_level <= MAX_CACHE_LEVEL; discard_level++) {
-            for (i = 0; i < vol->bcache_size; i++) {
-                if (vol->bcache[i].refcount == 0 && vol->bcache[i].cache_level <= discard_level)
-                    break;
-            }
-            if (i < vol->bcache_size)
+    status = fsw_alloc(n * vol->phys_blocksize, &buffer);
+    if (status != FSW_SUCCESS)
+        return status;
+
+    status = vol->host_table->read_blocks(vol, phys_bno, n, buffer);
+    if (status == FSW_SUCCESS) {
+        for (i = 0; i < n; i++) {
+            fsw_u32 e;
+
+            status = fsw_blockcache_alloc_entry(vol, &e);
+            if (status != FSW_SUCCESS)
                 break;
+            fsw_memcpy(vol->bcache[e].data, buffer + i * vol->phys_blocksize, vol->phys_blocksize);
+            fsw_blockcache_link(vol, e, phys_bno + i, cache_level);
+            vol->bcache[e].refcount = 0;
         }
+        vol->bcache_stat.readahead += i;
     }
-    if (i >= vol->bcache_size) {
-	fsw_u32 new_bcache_size;
-
-        // enlarge / create the cache
-        if (vol->bcache_size < 16)
-            new_bcache_size = 16;
-        else
-            new_bcache_size = vol->bcache_size << 1;
-        status = fsw_alloc(new_bcache_size * sizeof(struct fsw_blockcache), &new_bcache);
-        if (status != FSW_SUCCESS)
-            return status;
-        if (vol->bcache_size > 0)
-            fsw_memcpy(new_bcache, vol->bcache, vol->bcache_size * sizeof(struct fsw_blockcache));
-        for (i = vol->bcache_size; i < new_bcache_size; i++) {
-            new_bcache[i].refcount = 0;
-            new_bcache[i].cache_level = 0;
-            new_bcache[i].phys_bno = FSW_INVALID_BNO;
-            new_bcache[i].data = NULL;
-        }
-        i = vol->bcache_size;
 
-        // switch caches
-        fsw_free(vol->bcache);
-        vol->bcache = new_bcache;
-        vol->bcache_size = new_bcache_size;
-    }
-    vol->bcache[i].phys_bno = FSW_INVALID_BNO;
+    fsw_free(buffer);
+    return status;
+}
 
-    // read the data
-    if (vol->bcache[i].data == NULL) {
-        status = fsw_alloc(vol->phys_blocksize, &vol->bcache[i].data);
+/**
+ * Read a run of blocks straight into a caller buffer, bypassing the block cache. Used
+ * for bulk file data that is unlikely to be read again. The host driver's multi-block
+ * routine is used when available.
+ */
+
+static fsw_status_t fsw_block_read_direct(struct fsw_volume *vol, fsw_u32 phys_bno, fsw_u32 count, fsw_u8 *buffer)
+{
+    fsw_status_t    status;
+    fsw_u32         i;
+
+    if (vol->host_table->read_blocks != NULL)
+        return vol->host_table->read_blocks(vol, phys_bno, count, buffer);
+
+    for (i = 0; i < count; i++) {
+        status = vol->host_table->read_block(vol, phys_bno + i, buffer + i * vol->phys_blocksize);
         if (status != FSW_SUCCESS)
             return status;
     }
-    status = vol->host_table->read_block(vol, phys_bno, vol->bcache[i].data);
-    if (status != FSW_SUCCESS)
-        return status;
 
-    vol->bcache[i].phys_bno = phys_bno;
-    vol->bcache[i].cache_level = cache_level;
-    vol->bcache[i].refcount = 1;
-    *buffer_out = vol->bcache[i].data;
     return FSW_SUCCESS;
 }
 
@@ -278,15 +531,15 @@ void fsw_block_release(struct VOLSTRUCTNAME *vol, fsw_u32 phys_bno, void *buffer
     //  the appropriate function pointers are set
 
     // update block cache
-    for (i = 0; i < vol->bcache_size; i++) {
-        if (vol->bcache[i].phys_bno == phys_bno && vol->bcache[i].refcount > 0)
-            vol->bcache[i].refcount--;
-    }
+    i = fsw_blockcache_lookup(vol, phys_bno);
+    if (i != FSW_BCACHE_NIL && vol->bcache[i].refcount > 0)
+        vol->bcache[i].refcount--;
 }
 
 /**
  * Release the block cache. Called internally when changing block sizes and when
  * unmounting the volume. It frees all data occupied by the generic block cache.
+ * The budget and the statistics are kept.
  */
 
 static void fsw_blockcache_free(struct fsw_volume *vol)
@@ -297,8 +550,12 @@ static void fsw_blockcache_free(struct fsw_volume *vol)
         fsw_free(vol->bcache[i].data);
     }
     fsw_free(vol->bcache);
+    fsw_free(vol->bcache_hash);
     vol->bcache = NULL;
     vol->bcache_size = 0;
+    vol->bcache_hash = NULL;
+    vol->bcache_hash_shift = 0;
+    vol->bcache_clock = 0;
 }
 
 /**
@@ -1119,6 +1376,32 @@ fsw_status_t fsw_shandle_read(struct fsw_shandle *shand, fsw_u32 *buffer_size_in
 	    //
             phys_bno = shand->extent.phys_start + pos_in_extent / vol->phys_blocksize;
             pos_in_physblock = pos_in_extent & (vol->phys_blocksize - 1);
+
+            if (cache_level == 0 && pos_in_physblock == 0 && buflen >= vol->phys_blocksize) {
+                fsw_u32 count, ratio, log_left, phys_off;
+
+                // read whole file data blocks of the extent directly into the buffer,
+                // counting in blocks as long extents may exceed 4 GB
+
+                ratio = vol->log_blocksize / vol->phys_blocksize;
+                log_left = shand->extent.log_count - pos_in_extent / vol->log_blocksize;
+                phys_off = (pos_in_extent & (vol->log_blocksize - 1)) / vol->phys_blocksize;
+                count = buflen / vol->phys_blocksize;
+                if (log_left < (count + phys_off + ratio - 1) / ratio)
+                    count = log_left * ratio - phys_off;
+                copylen = count * vol->phys_blocksize;
+
+                status = fsw_block_read_direct(vol, phys_bno, count, buffer);
+
+                if (status != FSW_SUCCESS)
+                    return status;
+
+                buffer += copylen;
+                buflen -= copylen;
+                pos    += copylen;
+                continue;
+            }
+
             copylen = vol->phys_blocksize - pos_in_physblock;
 
             if (copylen > buflen)
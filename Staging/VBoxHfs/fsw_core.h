@@ -193,9 +193,31 @@ struct fsw_blockcache {
     fsw_u32     refcount;           //!< Reference count
     fsw_u32     cache_level;        //!< Level of importance of this block
     fsw_u32     phys_bno;           //!< Physical block number
+    fsw_u32     credit;             //!< Clock sweeps this block survives before eviction
+    fsw_u32     hash_next;          //!< Index of the next entry in the hash chain
     void        *data;              //!< Block data buffer
 };
 
+/**
+ * Core: Block cache statistics.
+ */
+
+struct fsw_blockcache_stat {
+    fsw_u32     hits;               //!< Blocks found in the cache
+    fsw_u32     misses;             //!< Blocks read from the disk
+    fsw_u32     evictions;          //!< Blocks dropped to make room for others
+    fsw_u32     readahead;          //!< Blocks added by readahead
+};
+
+/**
+ * Default block cache size limit in bytes. The cache may temporarily grow beyond it
+ * when all cached blocks are in use.
+ */
+
+#ifndef FSW_BCACHE_BUDGET
+#define FSW_BCACHE_BUDGET (4 * 1024 * 1024)
+#endif
+
 /**
  * Core: Represents a mounted volume.
  */
@@ -211,6 +233,11 @@ struct fsw_volume {
 
     struct fsw_blockcache *bcache;  //!< Array of block cache entries
     fsw_u32     bcache_size;        //!< Number of entries in the block cache array
+    fsw_u32     *bcache_hash;       //!< Hash buckets with the index of the first entry
+    fsw_u32     bcache_hash_shift;  //!< Shift selecting the hash bucket bits
+    fsw_u32     bcache_clock;       //!< Clock hand for choosing blocks to evict
+    fsw_u32     bcache_budget;      //!< Block cache size limit in bytes
+    struct fsw_blockcache_stat bcache_stat; //!< Block cache statistics
 
     void        *host_data;         //!< Hook for a host-specific data structure
     struct fsw_host_table *host_table;      //!< Dispatch table for host-specific functions
@@ -332,6 +359,7 @@ struct fsw_host_table
                                      fsw_u32 old_phys_blocksize, fsw_u32 old_log_blocksize,
                                      fsw_u32 new_phys_blocksize, fsw_u32 new_log_blocksize);
     fsw_status_t (*read_block)(struct fsw_volume *vol, fsw_u32 phys_bno, void *buffer);
+    fsw_status_t (*read_blocks)(struct fsw_volume *vol, fsw_u32 phys_bno, fsw_u32 count, void *buffer); //!< Optional
 };
 
 /**
@@ -379,6 +407,7 @@ fsw_status_t fsw_volume_stat(struct fsw_volume *vol, struct fsw_volume_stat *sb)
 void         fsw_set_blocksize(struct VOLSTRUCTNAME *vol, fsw_u32 phys_blocksize, fsw_u32 log_blocksize);
 fsw_status_t fsw_block_get(struct VOLSTRUCTNAME *vol, fsw_u32 phys_bno, fsw_u32 cache_level, void **buffer_out);
 void         fsw_block_release(struct VOLSTRUCTNAME *vol, fsw_u32 phys_bno, void *buffer);
+fsw_status_t fsw_block_readahead(struct VOLSTRUCTNAME *vol, fsw_u32 phys_bno, fsw_u32 count, fsw_u32 cache_level);
 
 /*@}*/
 
@@ -117,6 +117,13 @@ fsw_status_t fsw_efi_read_block (
   void *buffer
 );
 
+fsw_status_t fsw_efi_read_blocks (
+  struct fsw_volume *vol,
+  fsw_u32 phys_bno,
+  fsw_u32 count,
+  void *buffer
+);
+
 EFI_STATUS fsw_efi_map_status (
   fsw_status_t fsw_status,
   FSW_VOLUME_DATA * Volume
@@ -223,7 +230,8 @@ struct fsw_host_table fsw_efi_host_table = {
   FSW_STRING_KIND_UTF16,
 
   fsw_efi_change_blocksize,
-  fsw_efi_read_block
+  fsw_efi_read_block,
+  fsw_efi_read_blocks
 };
 
 extern struct fsw_fstype_table FSW_FSTYPE_TABLE_NAME (
@@ -576,9 +584,40 @@ fsw_efi_read_block (
   return FSW_SUCCESS;
 }
 
+/**
+ * FSW interface function to read a run of consecutive data blocks with a single
+ * device request. This function is called by the FSW core for bulk file data and
+ * readahead. The buffer must hold count blocks.
+ */
+
+fsw_status_t
+fsw_efi_read_blocks (
+  struct fsw_volume *vol,
+  fsw_u32 phys_bno,
+  fsw_u32 count,
+  void *buffer
+)
+{
+  EFI_STATUS Status;
+  FSW_VOLUME_DATA *Volume = (FSW_VOLUME_DATA *) vol->host_data;
+
+  // read from disk
+  Status =
+    Volume->DiskIo->ReadDisk (Volume->DiskIo, Volume->MediaId,
+                              (UINT64) phys_bno * vol->phys_blocksize,
+                              (UINTN) count * vol->phys_blocksize, buffer);
+  Volume->LastIOStatus = Status;
+
+  if (EFI_ERROR (Status)) {
+    return FSW_IO_ERROR;
+  }
+
+  return FSW_SUCCESS;
+}
+
 /**
  * Map FSW status codes to EFI status codes. The FSW_IO_ERROR code is only produced
- * by fsw_efi_read_block, so we map it back to the EFI status code remembered from
+ * by fsw_efi_read_block and fsw_efi_read_blocks, so we map it back to the EFI status code remembered from
  * the last I/O operation.
  */
 
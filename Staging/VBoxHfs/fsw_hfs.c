@@ -176,6 +176,10 @@ static fsw_status_t fsw_hfs_btree_search (
 	fsw_u32 *tuplenum_out
 );
 
+static void fsw_hfs_btree_cache_free (
+	struct fsw_hfs_btree *btree
+);
+
 static void hfs_dnode_stuff_info (
 	struct fsw_hfs_dnode *dno,
 	file_info_t *file_info
@@ -274,6 +278,22 @@ fsw_hfs_read_block (struct fsw_hfs_dnode *dno, fsw_u32 log_bno, fsw_u32 off, fsw
 		fsw_u32 phys_bno;
 
 		phys_bno = extent.phys_start;
+
+		/* Grow readahead window on sequential access, reset it on a seek */
+		if (log_bno == dno->ra_next) {
+			if (dno->ra_window == 0)
+				dno->ra_window = HFS_READAHEAD_MIN;
+			else if (dno->ra_window < HFS_READAHEAD_MAX)
+				dno->ra_window <<= 1;
+		} else if (log_bno + 1 != dno->ra_next) {
+			dno->ra_window = 0;
+		}
+		dno->ra_next = log_bno + 1;
+
+		if (dno->ra_window > 0)
+			fsw_block_readahead (dno->g.vol, phys_bno,
+				dno->ra_window < extent.log_count ? dno->ra_window : extent.log_count, 0);
+
 		status = fsw_block_get (dno->g.vol, phys_bno, 0, (void **) &buffer);
 
 		if (status == FSW_SUCCESS) {
@@ -366,6 +386,7 @@ fsw_hfs_volume_btree_setup ( struct fsw_hfs_btree* btree)
 	if (hr != NULL) {
 		btree->btroot_node = be32_to_cpu (hr->rootNode);
 		btree->btnode_size = be16_to_cpu (hr->nodeSize);
+		btree->btdepth = be16_to_cpu (hr->treeDepth);
 		fsw_free(hr);
 
 		return FSW_SUCCESS;
@@ -538,6 +559,9 @@ fsw_hfs_volume_free (struct fsw_hfs_volume *vol)
 		vol->primary_voldesc = NULL;
 	}
 
+	fsw_hfs_btree_cache_free (&vol->catalog_tree);
+	fsw_hfs_btree_cache_free (&vol->extents_tree);
+
 	if (vol->catalog_tree.btfile != NULL) {
 		fsw_dnode_release ((struct fsw_dnode *) (vol->catalog_tree.btfile));
 		vol->catalog_tree.btfile = NULL;
@@ -638,7 +662,7 @@ fsw_hfs_dnode_stat (struct fsw_hfs_volume *vol, struct fsw_hfs_dnode *dno, struc
 }
 
 static int
-fsw_hfs_find_block (HFSPlusExtentRecord *exts, fsw_u32 *lbno, fsw_u32 *pbno)
+fsw_hfs_find_block (HFSPlusExtentRecord *exts, fsw_u32 *lbno, fsw_u32 *pbno, fsw_u32 *pcount)
 {
 	int i;
 	fsw_u32 cur_lbno = *lbno;
@@ -649,6 +673,7 @@ fsw_hfs_find_block (HFSPlusExtentRecord *exts, fsw_u32 *lbno, fsw_u32 *pbno)
 
 		if (cur_lbno < count) {
 			*pbno = start + cur_lbno;
+			*pcount = count - cur_lbno;
 			return 1;
 		}
 
@@ -750,25 +775,106 @@ fsw_hfs_btree_ix_next_btnodenum (BTreeKey *btkey)
 	return be32_to_cpu(nn);
 }
 
+/* Find a cached index node */
+
+static btnode_datum_t *
+fsw_hfs_btree_cache_lookup (struct fsw_hfs_btree *btree, fsw_u32 nodenum)
+{
+	fsw_u32 i;
+
+	for (i = 0; i < HFS_BTREE_CACHE_SIZE; i++) {
+		if (btree->cache[i].nodenum == nodenum && btree->cache[i].node != NULL) {
+			btree->cache[i].last_use = ++btree->cache_use;
+			return (btnode_datum_t *) btree->cache[i].node;
+		}
+	}
+
+	return NULL;
+}
+
+/*
+ * Add an index node to the cache, which takes ownership of it on success.
+ * Upper levels are pinned, other nodes replace the least recently used unpinned one.
+ */
+
+static int
+fsw_hfs_btree_cache_insert (struct fsw_hfs_btree *btree, fsw_u32 nodenum, btnode_datum_t *btnode)
+{
+	fsw_u32 i;
+	fsw_u32 victim = HFS_BTREE_CACHE_SIZE;
+
+	for (i = 0; i < HFS_BTREE_CACHE_SIZE; i++) {
+		if (btree->cache[i].node == NULL) {
+			victim = i;
+			break;
+		}
+
+		if (!btree->cache[i].pinned
+			&& (victim == HFS_BTREE_CACHE_SIZE || btree->cache[i].last_use < btree->cache[victim].last_use))
+			victim = i;
+	}
+
+	if (victim == HFS_BTREE_CACHE_SIZE)
+		return 0;
+
+	fsw_free (btree->cache[victim].node);
+
+	/* Root has height equal to tree depth, leaves have height 1 (TN1150) */
+
+	btree->cache[victim].nodenum = nodenum;
+	btree->cache[victim].pinned = btnode->ndesc.height + HFS_BTREE_PINNED_LEVELS > btree->btdepth;
+	btree->cache[victim].last_use = ++btree->cache_use;
+	btree->cache[victim].node = btnode;
+
+	return 1;
+}
+
+static void
+fsw_hfs_btree_cache_free (struct fsw_hfs_btree *btree)
+{
+	fsw_u32 i;
+
+	for (i = 0; i < HFS_BTREE_CACHE_SIZE; i++) {
+		fsw_free (btree->cache[i].node);
+		btree->cache[i].node = NULL;
+		btree->cache[i].nodenum = 0;
+	}
+}
+
+/*
+ * Search B-tree for a key. Index nodes are kept in the per-tree cache,
+ * the found leaf node is returned to the caller, who must free it.
+ */
+
 static fsw_status_t
-fsw_hfs_btree_search (struct fsw_hfs_btree *btree, BTreeKey *key, int (*compare_keys) (BTreeKey *key1, BTreeKey *key2), btnode_datum_t **btnode_out, fsw_u32 *tuplenum_out)
+fsw_hfs_btree_search_leaf (struct fsw_hfs_btree *btree, BTreeKey *key, int (*compare_keys) (BTreeKey *key1, BTreeKey *key2), btnode_datum_t **btnode_out, fsw_u32 *btnodenum_out, fsw_u32 *tuplenum_out)
 {
 	fsw_status_t status;
 	btnode_datum_t *btnode = NULL;
 	fsw_u32 btnodenum;
 	fsw_u32 tuplenum;
+	int cached;
 
 	btnodenum = btree->btroot_node;
 
 	for (;;) {
 		fsw_s32 cmp = 0;
 		fsw_u32 count;
+		fsw_u32 curnodenum = btnodenum;
 		BTreeKey *currkey = NULL;
 
-		status = fsw_hfs_btree_read_node (btree, btnodenum, &btnode);
+		btnode = fsw_hfs_btree_cache_lookup (btree, btnodenum);
+		cached = btnode != NULL;
 
-		if (status != FSW_SUCCESS)
-			break;
+		if (!cached) {
+			status = fsw_hfs_btree_read_node (btree, btnodenum, &btnode);
+
+			if (status != FSW_SUCCESS)
+				break;
+
+			if (btnode->ndesc.kind == kBTIndexNode)
+				cached = fsw_hfs_btree_cache_insert (btree, btnodenum, btnode);
+		}
 
 		count = be16_to_cpu (btnode->ndesc.numRecords);
 
@@ -789,6 +895,7 @@ fsw_hfs_btree_search (struct fsw_hfs_btree *btree, BTreeKey *key, int (*compare_
 
 			if (cmp == 0) {
 				*btnode_out = btnode;
+				*btnodenum_out = curnodenum;
 				*tuplenum_out = tuplenum;
 				status = FSW_SUCCESS;
 			}
@@ -801,16 +908,25 @@ fsw_hfs_btree_search (struct fsw_hfs_btree *btree, BTreeKey *key, int (*compare_
 			break;
 		}
 
-		fsw_free(btnode);
+		if (!cached)
+			fsw_free(btnode);
 		btnode = NULL;
 	}
 
-	if (status != FSW_SUCCESS)
+	if (status != FSW_SUCCESS && !cached)
 		fsw_free (btnode);
 
 	return status;
 }
 
+static fsw_status_t
+fsw_hfs_btree_search (struct fsw_hfs_btree *btree, BTreeKey *key, int (*compare_keys) (BTreeKey *key1, BTreeKey *key2), btnode_datum_t **btnode_out, fsw_u32 *tuplenum_out)
+{
+	fsw_u32 btnodenum;
+
+	return fsw_hfs_btree_search_leaf (btree, key, compare_keys, btnode_out, &btnodenum, tuplenum_out);
+}
+
 static void
 fill_fileinfo (struct fsw_hfs_volume* vol, BTreeKey* btkey, file_info_t* finfo)
 {
@@ -912,9 +1028,10 @@ fsw_hfs_btnode_visit_record (BTreeKey *btkey, void *param)
 }
 
 static fsw_status_t
-fsw_hfs_btnode_iterate_records (struct fsw_hfs_btree *btree, btnode_datum_t *first_btnode, fsw_u32 first_tuplenum, int (*callback) (BTreeKey *record, void *param), void *param)
+fsw_hfs_btnode_iterate_records (struct fsw_hfs_btree *btree, fsw_u32 *btnodenum_inout, btnode_datum_t *first_btnode, fsw_u32 *tuplenum_inout, int (*callback) (BTreeKey *record, void *param), void *param)
 {
 	fsw_status_t status;
+	fsw_u32 first_tuplenum = *tuplenum_inout;
 
 	/* We modify node, so make a copy */
 
@@ -932,6 +1049,7 @@ fsw_hfs_btnode_iterate_records (struct fsw_hfs_btree *btree, btnode_datum_t *fir
 
 			switch (rv) {
 				case 1:
+					*tuplenum_inout = i;
 					status = FSW_SUCCESS;
 					goto done;
 				case -1:
@@ -956,6 +1074,7 @@ fsw_hfs_btnode_iterate_records (struct fsw_hfs_btree *btree, btnode_datum_t *fir
 		if (status != FSW_SUCCESS)
 			break;
 
+		*btnodenum_inout = next_btnode;
 		first_tuplenum = 0;
 	}
 
@@ -1101,7 +1220,8 @@ fsw_hfs_cmpb_catkey (BTreeKey *btkey1, BTreeKey *btkey2)
  * fsw_shandle_read needs to know where on the disk the required piece of the file's
  * data can be found. The core makes sure that fsw_hfs_dnode_fill has been called
  * on the dnode before. Our task here is to get the physical disk block number for
- * the requested logical block number.
+ * the requested logical block number, along with the number of blocks following it
+ * in the same extent, so that contiguous runs can be read at once.
  */
 
 static fsw_status_t
@@ -1125,9 +1245,11 @@ fsw_hfs_get_extent (struct fsw_hfs_volume *vol, struct fsw_hfs_dnode *dno, struc
 		struct HFSPlusExtentKey overflowkey;
 		fsw_u32 tuplenum;
 		fsw_u32 phys_bno;
+		fsw_u32 phys_count;
 
-		if (fsw_hfs_find_block (exts, &lbno, &phys_bno)) {
+		if (fsw_hfs_find_block (exts, &lbno, &phys_bno, &phys_count)) {
 			extent->phys_start = phys_bno;
+			extent->log_count = phys_count;
 			status = FSW_SUCCESS;
 			break;
 		}
@@ -1250,35 +1372,65 @@ static fsw_status_t
 fsw_hfs_dir_read (struct fsw_hfs_volume *vol, struct fsw_hfs_dnode *dno, struct fsw_shandle *shand, struct fsw_hfs_dnode **child_dno_out)
 {
 	fsw_status_t status;
-	struct HFSPlusCatalogKey *catkey;
+	struct HFSPlusCatalogKey *catkey = NULL;
+	btnode_datum_t *btnode = NULL;
+	fsw_u32 btnodenum;
 	fsw_u32 tuplenum;
+	fsw_u32 cur_pos = 0;
 
-	catkey = fsw_hfs_make_catkey(dno->g.dnode_id, NULL);
+	/* Continue from the leaf where the previous call stopped */
 
-	if (catkey != NULL) {
-		btnode_datum_t *btnode = NULL;
+	status = FSW_NOT_FOUND;
 
-		status = fsw_hfs_btree_search (&vol->catalog_tree, (BTreeKey *) catkey, vol->btkey_compare, &btnode, &tuplenum);
+	if (dno->dir_hint_node != 0 && dno->dir_hint_pos == shand->pos) {
+		status = fsw_hfs_btree_read_node (&vol->catalog_tree, dno->dir_hint_node, &btnode);
+
+		if (status == FSW_SUCCESS && btnode->ndesc.kind != kBTLeafNode) {
+			fsw_free (btnode);
+			btnode = NULL;
+			status = FSW_NOT_FOUND;
+		}
 
 		if (status == FSW_SUCCESS) {
-			visitor_parameter_t param;
+			btnodenum = dno->dir_hint_node;
+			tuplenum = dno->dir_hint_tuple;
+			cur_pos = dno->dir_hint_pos;
+		}
+	}
 
-			fsw_memzero (&param, sizeof (param));
+	/* Otherwise start from the directory thread record */
 
-			/* Iterator updates shand state */
+	if (status != FSW_SUCCESS) {
+		catkey = fsw_hfs_make_catkey(dno->g.dnode_id, NULL);
 
-			param.vol = vol;
-			param.shandle = shand;
-			param.parent = dno->g.dnode_id;
-			status = fsw_hfs_btnode_iterate_records (&vol->catalog_tree, btnode, tuplenum, fsw_hfs_btnode_visit_record, &param);
+		if (catkey != NULL)
+			status = fsw_hfs_btree_search_leaf (&vol->catalog_tree, (BTreeKey *) catkey, vol->btkey_compare, &btnode, &btnodenum, &tuplenum);
+		else
+			status = FSW_OUT_OF_MEMORY;
+	}
+
+	if (status == FSW_SUCCESS) {
+		visitor_parameter_t param;
+
+		fsw_memzero (&param, sizeof (param));
+
+		/* Iterator updates shand state */
 
-			if (status == FSW_SUCCESS)
-				status = create_hfs_dnode (dno, &param.file_info, child_dno_out);
+		param.cur_pos = cur_pos;
+		param.vol = vol;
+		param.shandle = shand;
+		param.parent = dno->g.dnode_id;
+		status = fsw_hfs_btnode_iterate_records (&vol->catalog_tree, &btnodenum, btnode, &tuplenum, fsw_hfs_btnode_visit_record, &param);
 
-			fsw_string_mkempty (&param.file_info.name);
+		if (status == FSW_SUCCESS) {
+			dno->dir_hint_pos = (fsw_u32) shand->pos;
+			dno->dir_hint_node = btnodenum;
+			dno->dir_hint_tuple = tuplenum + 1;
+			status = create_hfs_dnode (dno, &param.file_info, child_dno_out);
 		}
-	} else
-		status = FSW_OUT_OF_MEMORY;
+
+		fsw_string_mkempty (&param.file_info.name);
+	}
 
 	fsw_free(catkey);
 
@@ -47,6 +47,16 @@
 //! Block number where the HFS superblock resides.
 #define HFS_SUPERBLOCK_BLOCKNO   2
 
+//! Initial and maximal readahead window in blocks for sequential B-tree access.
+#define HFS_READAHEAD_MIN        2
+#define HFS_READAHEAD_MAX        32
+
+//! Number of index nodes cached per B-tree.
+#define HFS_BTREE_CACHE_SIZE     32
+
+//! Number of upper B-tree levels never evicted from the index node cache.
+#define HFS_BTREE_PINNED_LEVELS  2
+
 /* Make world look Applish enough for the system header describing HFS layout  */
 #define __APPLE_API_PRIVATE
 #define __APPLE_API_UNSTABLE
@@ -118,6 +128,24 @@ struct fsw_hfs_dnode
   fsw_u32 crtype;
   /* hardlinks stuff */
   fsw_u32 ilink;
+  /* readahead stuff */
+  fsw_u32 ra_next;                      //!< Logical block expected next on sequential access
+  fsw_u32 ra_window;                    //!< Current readahead window in blocks
+  /* directory iteration stuff */
+  fsw_u32 dir_hint_pos;                 //!< Directory position the hint is valid for
+  fsw_u32 dir_hint_node;                //!< Catalog leaf node holding that position, 0 if none
+  fsw_u32 dir_hint_tuple;               //!< Record number in that leaf node
+};
+
+/**
+ * HFS: Cached B-tree index node.
+ */
+struct fsw_hfs_btnode_cache
+{
+    fsw_u32                  nodenum;   //!< Node number, 0 for an unused entry
+    fsw_u32                  pinned;    //!< Node belongs to an upper level and is never evicted
+    fsw_u32                  last_use;  //!< Value of the use counter at the last access
+    void                     *node;     //!< Node data
 };
 
 /**
@@ -127,7 +155,10 @@ struct fsw_hfs_btree
 {
     fsw_u32                  btroot_node;
     fsw_u32                  btnode_size;
+    fsw_u32                  btdepth;
     struct fsw_hfs_dnode*    btfile;
+    fsw_u32                  cache_use;  //!< Use counter for LRU eviction
+    struct fsw_hfs_btnode_cache cache[HFS_BTREE_CACHE_SIZE];
 };
 
 /**
@@ -560,6 +560,77 @@ STATIC HASH_SAMPLE HashSamples[4] = {
   }
 };
 
+#define PASSWORD_SAMPLES_NUM 4
+
+typedef struct PASSWORD_SAMPLE_ {
+  CONST CHAR8  *Password;
+  CONST CHAR8  *Salt;
+  UINT8        Hash[SHA512_DIGEST_SIZE];
+} PASSWORD_SAMPLE;
+
+//
+// Hashes produced by the original OcHashPasswordSha512 implementation,
+// covering the one-block, two-block and generic iteration paths.
+//
+STATIC PASSWORD_SAMPLE PasswordSamples[PASSWORD_SAMPLES_NUM] = {
+  {
+    "password",
+    "0123456789abcdef",
+    {
+      0x19, 0x2d, 0x13, 0x79, 0xfc, 0x4b, 0x96, 0x17, 0x67, 0x98, 0xd2, 0x1b,
+      0x65, 0xb2, 0x40, 0xce, 0x42, 0xb2, 0x4b, 0x52, 0xdf, 0x96, 0x57, 0xbc,
+      0x4a, 0x3d, 0x90, 0x15, 0xb9, 0x37, 0xf9, 0x0b, 0x43, 0x0d, 0xb2, 0x35,
+      0x5d, 0x41, 0xf9, 0x01, 0x13, 0x81, 0x1b, 0xcb, 0xce, 0xeb, 0xea, 0x3d,
+      0xb1, 0xf5, 0x80, 0x71, 0xa9, 0xff, 0x27, 0x6f, 0x89, 0xbd, 0x87, 0xdb,
+      0x23, 0x94, 0xf6, 0x2d
+    }
+  },
+  {
+    "abc",
+    "",
+    {
+      0xf0, 0xc6, 0x5e, 0xab, 0x6f, 0x5d, 0xe2, 0x94, 0xf8, 0x85, 0x9e, 0x2b,
+      0x2a, 0x5f, 0x30, 0xae, 0xf8, 0xee, 0x9a, 0x96, 0xa8, 0x00, 0xb9, 0xcb,
+      0x6f, 0xa8, 0x04, 0x56, 0x3e, 0xef, 0x33, 0x96, 0xda, 0x94, 0x69, 0x83,
+      0x07, 0x0d, 0x1b, 0x2a, 0xa3, 0xe8, 0xda, 0x8b, 0x9f, 0xc2, 0xaf, 0x12,
+      0x57, 0xad, 0xfc, 0x11, 0xa0, 0x99, 0x78, 0x52, 0x46, 0x5c, 0x56, 0x31,
+      0x70, 0x6f, 0xb3, 0x65
+    }
+  },
+  //
+  // Iteration message spans two SHA-512 blocks (64 + 64 + 16 bytes).
+  //
+  {
+    "0123456789abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ+/",
+    "0123456789abcdef",
+    {
+      0x5e, 0x8e, 0x8d, 0x0b, 0x12, 0x1f, 0xb7, 0x0e, 0x8c, 0x1e, 0x49, 0xbf,
+      0x68, 0x4f, 0xad, 0x68, 0xc4, 0x95, 0x2c, 0xe9, 0xc0, 0xee, 0xa4, 0x77,
+      0xc7, 0x71, 0x66, 0x83, 0x8d, 0x9c, 0xcc, 0xc1, 0x7f, 0x32, 0x64, 0x41,
+      0x33, 0xa0, 0xe4, 0x7f, 0x7f, 0x1d, 0x7e, 0x80, 0x16, 0xbb, 0x36, 0x34,
+      0xab, 0x1d, 0xf8, 0x20, 0x52, 0x02, 0x5e, 0xa5, 0x2c, 0x91, 0xad, 0xa2,
+      0xcc, 0xcd, 0x41, 0xe1
+    }
+  },
+  //
+  // Iteration message does not fit two padded blocks (64 + 160 + 32 bytes).
+  //
+  {
+    "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/"
+    "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/"
+    "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdef",
+    "0123456789abcdef0123456789abcdef",
+    {
+      0x70, 0x47, 0xba, 0xbd, 0x09, 0x77, 0x0f, 0xd4, 0x70, 0x01, 0x9e, 0x0f,
+      0x38, 0x72, 0x1b, 0x59, 0x66, 0xf7, 0x56, 0x3f, 0x88, 0x6b, 0xbf, 0xc3,
+      0x3c, 0x19, 0xda, 0xb5, 0x0e, 0xaa, 0x57, 0x5b, 0x89, 0x42, 0x9e, 0x76,
+      0x36, 0xb4, 0x7f, 0x69, 0xe2, 0x39, 0x8f, 0x93, 0xd7, 0x18, 0x5d, 0xaf,
+      0x93, 0x98, 0xc5, 0x18, 0x89, 0xd1, 0x36, 0x06, 0x64, 0xf6, 0x92, 0x21,
+      0x7f, 0x1b, 0x1e, 0x1b
+    }
+  }
+};
+
 STATIC UINT8 CONST ChaChaEncryptionKey[] = {
   0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
   0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
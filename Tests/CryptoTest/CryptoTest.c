@@ -14,6 +14,7 @@ WITHOUT WARRANTIES OR REPRESENTATIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED.
 
 #include <Uefi.h>
 #include <PiDxe.h>
+#include <Library/BaseLib.h>
 #include <Library/PcdLib.h>
 #include <Library/UefiLib.h>
 #include <Library/MemoryAllocationLib.h>
@@ -398,6 +399,42 @@ TestHash (
   return Status;
 }
 
+EFI_STATUS
+EFIAPI
+TestPasswordHash (
+  VOID
+  )
+{
+  UINTN    Index;
+  BOOLEAN  Passed;
+  UINT8    Hash[SHA512_DIGEST_SIZE];
+
+  Passed = TRUE;
+
+  for (Index = 0; Index < PASSWORD_SAMPLES_NUM; ++Index) {
+    OcHashPasswordSha512 (
+      (CONST UINT8 *) PasswordSamples[Index].Password,
+      (UINT32) AsciiStrLen (PasswordSamples[Index].Password),
+      (CONST UINT8 *) PasswordSamples[Index].Salt,
+      (UINT32) AsciiStrLen (PasswordSamples[Index].Salt),
+      Hash
+      );
+
+    if (CompareMem (Hash, PasswordSamples[Index].Hash, SHA512_DIGEST_SIZE) == 0) {
+      Print (L"Password hash test passed\n");
+    } else {
+      Print (L"Password hash test failed\n");
+      Passed = FALSE;
+    }
+  }
+
+  if (Passed) {
+    return EFI_SUCCESS;
+  }
+
+  return EFI_INVALID_PARAMETER;
+}
+
 EFI_STATUS
 EFIAPI
 UefiDriverMain (
@@ -421,6 +458,17 @@ UefiDriverMain (
     Print (L"All hash tests passed!\n");
   }
 
+  //
+  // Test iterated password hashing
+  //
+  Status = TestPasswordHash ();
+  if (EFI_ERROR (Status)) {
+    Print (L"PasswordHash failed!\n");
+    Failure = TRUE;
+  } else {
+    Print (L"PasswordHash passed!\n");
+  }
+
   //
   // Test AES-128-CBC
   //
@@ -498,6 +546,19 @@ UefiAppMain (
 
   WaitForKeyPress (L"Press any key...");
 
+  //
+  // Test iterated password hashing
+  //
+  Status = TestPasswordHash ();
+  if (EFI_ERROR (Status)) {
+    Print (L"PasswordHash failed!\n");
+    Failure = TRUE;
+  } else {
+    Print (L"PasswordHash passed!\n");
+  }
+
+  WaitForKeyPress (L"Press any key...");
+
   //
   // Test AES-128-CBC
   //
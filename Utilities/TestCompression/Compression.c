@@ -0,0 +1,290 @@
+/** @file
+  Copyright (C) 2026, agent. All rights reserved.
+
+  All rights reserved.
+
+  This program and the accompanying materials
+  are licensed and made available under the terms and conditions of the BSD License
+  which accompanies this distribution.  The full text of the license may be found at
+  http://opensource.org/licenses/bsd-license.php
+
+  THE PROGRAM IS DISTRIBUTED UNDER THE BSD LICENSE ON AN "AS IS" BASIS,
+  WITHOUT WARRANTIES OR REPRESENTATIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED.
+**/
+
+#include <IndustryStandard/AppleCompressedBinaryImage.h>
+
+#include <Library/BaseLib.h>
+#include <Library/BaseMemoryLib.h>
+#include <Library/DebugLib.h>
+#include <Library/OcCompressionLib.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+
+#include <File.h>
+
+/*
+ Decompression throughput benchmark for compressed kernelcaches.
+ LZVN results are checked against the bounds checked decoder,
+ which is used alone when data is fed byte by byte.
+
+ ./Compression iterations kernelcache...
+
+ for fuzzing:
+ make FUZZ=1 SANITIZE=1 DEBUG=1
+ rm -rf DICT fuzz*.log ; mkdir DICT ; ./Compression -jobs=4 DICT
+*/
+
+#ifdef FUZZING_TEST
+#define main no_main
+#endif
+
+STATIC
+UINT64
+CurrentTimestampUs (
+  VOID
+  )
+{
+  struct timeval te;
+  gettimeofday (&te, NULL);
+  return te.tv_sec * 1000000ULL + te.tv_usec;
+}
+
+STATIC
+UINT32
+TestAdler32 (
+  IN CONST UINT8  *Buffer,
+  IN UINT32       BufferLen
+  )
+{
+  UINT32  Low;
+  UINT32  High;
+  UINT32  Index;
+
+  Low  = 1;
+  High = 0;
+
+  for (Index = 0; Index < BufferLen; ++Index) {
+    Low  = (Low + Buffer[Index]) % 65521U;
+    High = (High + Low) % 65521U;
+  }
+
+  return (High << 16U) | Low;
+}
+
+STATIC
+UINTN
+DecompressLZVNByByte (
+  OUT UINT8        *Dst,
+  IN  UINTN        DstLen,
+  IN  CONST UINT8  *Src,
+  IN  UINTN        SrcLen
+  )
+{
+  VOID   *Context;
+  UINTN  Index;
+  UINTN  Result;
+
+  Context = DecompressLZVNStreamInit (Dst, DstLen);
+  if (Context == NULL) {
+    return 0;
+  }
+
+  Result = 0;
+  for (Index = 0; Index < SrcLen; ++Index) {
+    Result = DecompressLZVNStream (Context, &Src[Index], 1);
+  }
+
+  DecompressLZVNStreamFree (Context);
+  return Result;
+}
+
+STATIC
+BOOLEAN
+TestLzvnDecoders (
+  IN CONST UINT8  *Src,
+  IN UINTN        SrcLen,
+  IN UINTN        DstLen
+  )
+{
+  UINT8    *Fast;
+  UINT8    *Safe;
+  UINTN    FastLen;
+  UINTN    SafeLen;
+  BOOLEAN  Result;
+
+  Fast = calloc (1, DstLen + 1);
+  Safe = calloc (1, DstLen + 1);
+  if (Fast == NULL || Safe == NULL) {
+    free (Fast);
+    free (Safe);
+    return FALSE;
+  }
+
+  FastLen = DecompressLZVN (Fast, DstLen, Src, SrcLen);
+  SafeLen = DecompressLZVNByByte (Safe, DstLen, Src, SrcLen);
+
+  //
+  // The stream decoder reports corrupted data, which the buffer decoder
+  // decompresses up to the first invalid instruction.
+  //
+  Result = (FastLen == SafeLen && memcmp (Fast, Safe, FastLen) == 0)
+    || (SafeLen == 0 && FastLen < DstLen);
+  if (!Result) {
+    printf (
+      "LZVN decoder mismatch %lu != %lu for %lu bytes\n",
+      (unsigned long) FastLen,
+      (unsigned long) SafeLen,
+      (unsigned long) SrcLen
+      );
+  }
+
+  free (Fast);
+  free (Safe);
+  return Result;
+}
+
+STATIC
+BOOLEAN
+TestKernelCache (
+  IN CONST CHAR8  *Name,
+  IN UINT8        *Data,
+  IN UINT32       DataSize,
+  IN UINT32       Iterations
+  )
+{
+  MACH_COMP_HEADER  *Header;
+  UINT32            Offset;
+  UINT32            Compression;
+  UINT32            CompressedSize;
+  UINT32            DecompressedSize;
+  UINT32            DecompressedHash;
+  UINT32            Index;
+  UINT32            Result;
+  UINT8             *Buffer;
+  UINT64            Start;
+  UINT64            Time;
+
+  //
+  // Compressed kernel may be wrapped into a FAT binary.
+  //
+  Header = NULL;
+  for (Offset = 0; DataSize - Offset >= sizeof (*Header); Offset += sizeof (UINT32)) {
+    Header = (MACH_COMP_HEADER *) &Data[Offset];
+    if (Header->Signature == MACH_COMPRESSED_BINARY_INVERT_SIGNATURE
+      && (Header->Compression == MACH_COMPRESSED_BINARY_INVERT_LZVN
+        || Header->Compression == MACH_COMPRESSED_BINARY_INVERT_LZSS)) {
+      break;
+    }
+    Header = NULL;
+  }
+
+  if (Header == NULL) {
+    printf ("%s is not a compressed kernel\n", Name);
+    return FALSE;
+  }
+
+  Compression      = Header->Compression;
+  CompressedSize   = SwapBytes32 (Header->Compressed);
+  DecompressedSize = SwapBytes32 (Header->Decompressed);
+  DecompressedHash = SwapBytes32 (Header->Hash);
+
+  if (CompressedSize > DataSize - Offset - sizeof (*Header)
+    || DecompressedSize > OC_COMPRESSION_MAX_LENGTH) {
+    printf ("%s has invalid compressed sizes %u/%u\n", Name, CompressedSize, DecompressedSize);
+    return FALSE;
+  }
+
+  Buffer = malloc (DecompressedSize);
+  if (Buffer == NULL) {
+    printf ("%s decompressed buffer of %u bytes cannot be allocated\n", Name, DecompressedSize);
+    return FALSE;
+  }
+
+  Result = 0;
+  Start  = CurrentTimestampUs ();
+  for (Index = 0; Index < Iterations; ++Index) {
+    if (Compression == MACH_COMPRESSED_BINARY_INVERT_LZVN) {
+      Result = (UINT32) DecompressLZVN (Buffer, DecompressedSize, (UINT8 *) (Header + 1), CompressedSize);
+    } else {
+      Result = DecompressLZSS (Buffer, DecompressedSize, (UINT8 *) (Header + 1), CompressedSize);
+    }
+  }
+  Time = CurrentTimestampUs () - Start;
+
+  if (Result != DecompressedSize || TestAdler32 (Buffer, DecompressedSize) != DecompressedHash) {
+    printf ("%s decompression failure %u/%u\n", Name, Result, DecompressedSize);
+    free (Buffer);
+    return FALSE;
+  }
+
+  free (Buffer);
+
+  printf (
+    "%s %s %u KB -> %u KB, %llu us per run, %llu MB/s\n",
+    Name,
+    Compression == MACH_COMPRESSED_BINARY_INVERT_LZVN ? "lzvn" : "lzss",
+    CompressedSize / BASE_1KB,
+    DecompressedSize / BASE_1KB,
+    (unsigned long long) (Time / Iterations),
+    (unsigned long long) (Time > 0 ? (UINT64) DecompressedSize * Iterations / Time : 0)
+    );
+
+  if (Compression == MACH_COMPRESSED_BINARY_INVERT_LZVN) {
+    return TestLzvnDecoders ((UINT8 *) (Header + 1), CompressedSize, DecompressedSize);
+  }
+
+  return TRUE;
+}
+
+int main (int argc, char *argv[]) {
+  UINT32  Iterations;
+  UINT8   *Data;
+  UINT32  DataSize;
+  INT32   Index;
+
+  if (argc < 3) {
+    printf ("Usage: %s iterations kernelcache...\n", argv[0]);
+    return -1;
+  }
+
+  Iterations = (UINT32) strtoul (argv[1], NULL, 0);
+  if (Iterations == 0) {
+    Iterations = 1;
+  }
+
+  for (Index = 2; Index < argc; ++Index) {
+    Data = readFile (argv[Index], &DataSize);
+    if (Data == NULL) {
+      printf ("Read fail %s\n", argv[Index]);
+      return -1;
+    }
+
+    if (!TestKernelCache (argv[Index], Data, DataSize, Iterations)) {
+      free (Data);
+      return -1;
+    }
+
+    free (Data);
+  }
+
+  return 0;
+}
+
+INT32 LLVMFuzzerTestOneInput(CONST UINT8 *Data, UINTN Size) {
+  if (Size == 0) {
+    return 0;
+  }
+
+  //
+  // Use the first byte to vary destination size to cover the tail.
+  //
+  if (!TestLzvnDecoders (&Data[1], Size - 1, (Size - 1) * Data[0] + Data[0])) {
+    abort ();
+  }
+
+  return 0;
+}
@@ -0,0 +1,495 @@
+/** @file
+  Copyright (C) 2026, agent. All rights reserved.
+
+  All rights reserved.
+
+  This program and the accompanying materials
+  are licensed and made available under the terms and conditions of the BSD License
+  which accompanies this distribution.  The full text of the license may be found at
+  http://opensource.org/licenses/bsd-license.php
+
+  THE PROGRAM IS DISTRIBUTED UNDER THE BSD LICENSE ON AN "AS IS" BASIS,
+  WITHOUT WARRANTIES OR REPRESENTATIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED.
+**/
+
+#include <Library/BaseMemoryLib.h>
+#include <Library/DebugLib.h>
+#include <Library/OcMiscLib.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+
+#include <File.h>
+
+/*
+ Differential test of FindPattern and ApplyPatch against the reference implementation.
+
+ ./Patcher [iterations] [file]
+
+ for fuzzing:
+ make FUZZ=1 SANITIZE=1 DEBUG=1
+ rm -rf DICT fuzz*.log ; mkdir DICT ; cp /System/Library/Kernels/kernel DICT ; ./Patcher -jobs=4 DICT
+*/
+
+#ifdef FUZZING_TEST
+#define main no_main
+#endif
+
+STATIC
+INT32
+ReferenceFindPattern (
+  IN CONST UINT8   *Pattern,
+  IN CONST UINT8   *PatternMask OPTIONAL,
+  IN CONST UINT32  PatternSize,
+  IN CONST UINT8   *Data,
+  IN UINT32        DataSize,
+  IN INT32         DataOff
+  )
+{
+  BOOLEAN  Matches;
+  UINT32   Index;
+
+  if (PatternSize == 0 || DataSize == 0 || (DataOff < 0) || (UINT32)DataOff >= DataSize || DataSize - DataOff < PatternSize) {
+    return -1;
+  }
+
+  while (DataOff + PatternSize <= DataSize) {
+    Matches = TRUE;
+    for (Index = 0; Index < PatternSize; ++Index) {
+      if ((PatternMask == NULL && Data[DataOff + Index] != Pattern[Index])
+      || (PatternMask != NULL && (Data[DataOff + Index] & PatternMask[Index]) != Pattern[Index])) {
+        Matches = FALSE;
+        break;
+      }
+    }
+
+    if (Matches) {
+      return DataOff;
+    }
+    ++DataOff;
+  }
+
+  return -1;
+}
+
+STATIC
+UINT32
+ReferenceApplyPatch (
+  IN CONST UINT8   *Pattern,
+  IN CONST UINT8   *PatternMask OPTIONAL,
+  IN CONST UINT32  PatternSize,
+  IN CONST UINT8   *Replace,
+  IN CONST UINT8   *ReplaceMask OPTIONAL,
+  IN UINT8         *Data,
+  IN UINT32        DataSize,
+  IN UINT32        Count,
+  IN UINT32        Skip
+  )
+{
+  UINT32  ReplaceCount;
+  INT32   DataOff;
+  UINT32  Index;
+
+  ReplaceCount = 0;
+  DataOff      = 0;
+
+  while (TRUE) {
+    DataOff = ReferenceFindPattern (Pattern, PatternMask, PatternSize, Data, DataSize, DataOff);
+    if (DataOff < 0) {
+      break;
+    }
+
+    if (Skip > 0) {
+      --Skip;
+    } else {
+      for (Index = 0; Index < PatternSize; ++Index) {
+        if (ReplaceMask == NULL) {
+          Data[DataOff + Index] = Replace[Index];
+        } else {
+          Data[DataOff + Index] = (Data[DataOff + Index] & ~ReplaceMask[Index]) | (Replace[Index] & ReplaceMask[Index]);
+        }
+      }
+
+      ++ReplaceCount;
+      if (Count > 0) {
+        --Count;
+        if (Count == 0) {
+          break;
+        }
+      }
+    }
+
+    DataOff += PatternSize;
+  }
+
+  return ReplaceCount;
+}
+
+STATIC
+UINT32
+mSeed = 0x2F1C3B4A;
+
+STATIC
+UINT8
+GetRandomByte (
+  VOID
+  )
+{
+  mSeed = mSeed * 1103515245U + 12345U;
+  return (UINT8) (mSeed >> 16U);
+}
+
+STATIC
+UINT32
+GetRandom (
+  IN UINT32  Limit
+  )
+{
+  mSeed = mSeed * 1103515245U + 12345U;
+  return Limit > 0 ? (mSeed >> 8U) % Limit : 0;
+}
+
+/**
+  Compare FindPattern with reference implementation on given input.
+
+  @retval TRUE when results match.
+**/
+STATIC
+BOOLEAN
+TestFindPattern (
+  IN CONST UINT8   *Pattern,
+  IN CONST UINT8   *PatternMask OPTIONAL,
+  IN UINT32        PatternSize,
+  IN CONST UINT8   *Data,
+  IN UINT32        DataSize,
+  IN INT32         DataOff
+  )
+{
+  INT32  Result;
+  INT32  Expected;
+
+  Result   = FindPattern (Pattern, PatternMask, PatternSize, Data, DataSize, DataOff);
+  Expected = ReferenceFindPattern (Pattern, PatternMask, PatternSize, Data, DataSize, DataOff);
+
+  if (Result != Expected) {
+    printf (
+      "FindPattern mismatch %d != %d (pattern %u, mask %d, data %u, offset %d)\n",
+      Result,
+      Expected,
+      PatternSize,
+      PatternMask != NULL,
+      DataSize,
+      DataOff
+      );
+    return FALSE;
+  }
+
+  return TRUE;
+}
+
+/**
+  Compare ApplyPatch with reference implementation on copies of given input.
+
+  @retval TRUE when results match.
+**/
+STATIC
+BOOLEAN
+TestApplyPatch (
+  IN CONST UINT8   *Pattern,
+  IN CONST UINT8   *PatternMask OPTIONAL,
+  IN UINT32        PatternSize,
+  IN CONST UINT8   *Replace,
+  IN CONST UINT8   *ReplaceMask OPTIONAL,
+  IN CONST UINT8   *Data,
+  IN UINT32        DataSize,
+  IN UINT32        Count,
+  IN UINT32        Skip
+  )
+{
+  UINT8    *Patched;
+  UINT8    *Expected;
+  UINT32   Result;
+  UINT32   ExpectedResult;
+  BOOLEAN  Matches;
+
+  //
+  // Allocate at least one byte to get distinct pointers for empty data.
+  //
+  Patched  = malloc (DataSize + 1);
+  Expected = malloc (DataSize + 1);
+  if (Patched == NULL || Expected == NULL) {
+    free (Patched);
+    free (Expected);
+    return FALSE;
+  }
+
+  CopyMem (Patched, Data, DataSize);
+  CopyMem (Expected, Data, DataSize);
+
+  Result         = ApplyPatch (Pattern, PatternMask, PatternSize, Replace, ReplaceMask, Patched, DataSize, Count, Skip);
+  ExpectedResult = ReferenceApplyPatch (Pattern, PatternMask, PatternSize, Replace, ReplaceMask, Expected, DataSize, Count, Skip);
+
+  Matches = Result == ExpectedResult && CompareMem (Patched, Expected, DataSize) == 0;
+  if (!Matches) {
+    printf (
+      "ApplyPatch mismatch %u != %u (pattern %u, mask %d, replace mask %d, data %u, count %u, skip %u)\n",
+      Result,
+      ExpectedResult,
+      PatternSize,
+      PatternMask != NULL,
+      ReplaceMask != NULL,
+      DataSize,
+      Count,
+      Skip
+      );
+  }
+
+  free (Patched);
+  free (Expected);
+  return Matches;
+}
+
+STATIC
+BOOLEAN
+TestRandomPatterns (
+  IN UINT32  Iterations
+  )
+{
+  UINT8   Data[512];
+  UINT8   Pattern[48];
+  UINT8   Mask[48];
+  UINT8   Replace[48];
+  UINT8   ReplaceMask[48];
+  UINT32  Index;
+  UINT32  Iteration;
+  UINT32  DataSize;
+  UINT32  PatternSize;
+  UINT32  Alphabet;
+  UINT32  Offset;
+  UINT8   *PatternMask;
+
+  for (Iteration = 0; Iteration < Iterations; ++Iteration) {
+    DataSize    = GetRandom (sizeof (Data) + 1);
+    PatternSize = GetRandom (sizeof (Pattern) + 1);
+    //
+    // Small alphabets produce lots of partial matches.
+    //
+    Alphabet    = 1 + GetRandom (256);
+
+    for (Index = 0; Index < DataSize; ++Index) {
+      Data[Index] = (UINT8) (GetRandomByte () % Alphabet);
+    }
+
+    for (Index = 0; Index < PatternSize; ++Index) {
+      Pattern[Index] = (UINT8) (GetRandomByte () % Alphabet);
+    }
+
+    //
+    // Make the pattern present in data in most cases.
+    //
+    if (DataSize > 0 && GetRandom (4) != 0) {
+      Offset = GetRandom (DataSize);
+      for (Index = 0; Index < PatternSize && Offset + Index < DataSize; ++Index) {
+        Pattern[Index] = Data[Offset + Index];
+      }
+    }
+
+    PatternMask = NULL;
+    if (GetRandom (2) != 0) {
+      for (Index = 0; Index < PatternSize; ++Index) {
+        switch (GetRandom (4)) {
+          case 0:
+            Mask[Index] = 0;
+            break;
+          case 1:
+            Mask[Index] = GetRandomByte ();
+            break;
+          default:
+            Mask[Index] = 0xFF;
+            break;
+        }
+
+        //
+        // Leave some patterns impossible to match.
+        //
+        if (GetRandom (16) != 0) {
+          Pattern[Index] &= Mask[Index];
+        }
+      }
+      PatternMask = Mask;
+    }
+
+    if (!TestFindPattern (Pattern, PatternMask, PatternSize, Data, DataSize, (INT32) GetRandom (DataSize + 1))) {
+      return FALSE;
+    }
+
+    for (Index = 0; Index < PatternSize; ++Index) {
+      Replace[Index]     = GetRandomByte ();
+      ReplaceMask[Index] = GetRandomByte ();
+    }
+
+    if (!TestApplyPatch (
+      Pattern,
+      PatternMask,
+      PatternSize,
+      Replace,
+      GetRandom (2) != 0 ? ReplaceMask : NULL,
+      Data,
+      DataSize,
+      GetRandom (4),
+      GetRandom (3)
+      )) {
+      return FALSE;
+    }
+  }
+
+  return TRUE;
+}
+
+STATIC
+UINT64
+CurrentTimestampUs (
+  VOID
+  )
+{
+  struct timeval te;
+  gettimeofday (&te, NULL);
+  return te.tv_sec * 1000000ULL + te.tv_usec;
+}
+
+STATIC
+BOOLEAN
+TestFilePatterns (
+  IN CONST UINT8   *Data,
+  IN UINT32        DataSize
+  )
+{
+  UINT8   Pattern[16];
+  UINT8   Mask[16];
+  UINT32  Index;
+  UINT32  Offset;
+  INT32   Result;
+  UINT64  FastTime;
+  UINT64  ReferenceTime;
+  UINT64  Start;
+
+  if (DataSize < sizeof (Pattern)) {
+    return TRUE;
+  }
+
+  FastTime      = 0;
+  ReferenceTime = 0;
+
+  //
+  // Look up data chunks from the second half from the beginning.
+  //
+  for (Index = 0; Index < 64; ++Index) {
+    Offset = DataSize / 2 + GetRandom (DataSize / 2 - sizeof (Pattern));
+    CopyMem (Pattern, &Data[Offset], sizeof (Pattern));
+    SetMem (Mask, sizeof (Mask), 0xFF);
+    if (Index % 2 != 0) {
+      Mask[Index % sizeof (Mask)] = 0xF0;
+      Pattern[Index % sizeof (Mask)] &= 0xF0;
+    }
+
+    Start   = CurrentTimestampUs ();
+    Result  = FindPattern (Pattern, Index % 2 != 0 ? Mask : NULL, sizeof (Pattern), Data, DataSize, 0);
+    FastTime += CurrentTimestampUs () - Start;
+
+    Start   = CurrentTimestampUs ();
+    if (Result != ReferenceFindPattern (Pattern, Index % 2 != 0 ? Mask : NULL, sizeof (Pattern), Data, DataSize, 0)) {
+      printf ("FindPattern mismatch for file pattern at %u\n", Offset);
+      return FALSE;
+    }
+    ReferenceTime += CurrentTimestampUs () - Start;
+  }
+
+  printf (
+    "FindPattern took %llu us, reference took %llu us for 64 lookups in %u KB\n",
+    (unsigned long long) FastTime,
+    (unsigned long long) ReferenceTime,
+    DataSize / BASE_1KB
+    );
+
+  return TRUE;
+}
+
+int main (int argc, char *argv[]) {
+  UINT32  Iterations;
+  UINT8   *Data;
+  UINT32  DataSize;
+
+  Iterations = argc > 1 ? (UINT32) strtoul (argv[1], NULL, 0) : 1000000;
+  if (!TestRandomPatterns (Iterations)) {
+    return -1;
+  }
+
+  printf ("Passed %u random patterns\n", Iterations);
+
+  if (argc > 2) {
+    Data = readFile (argv[2], &DataSize);
+    if (Data == NULL) {
+      printf ("Read fail %s\n", argv[2]);
+      return -1;
+    }
+
+    if (!TestFilePatterns (Data, DataSize)) {
+      free (Data);
+      return -1;
+    }
+
+    free (Data);
+  }
+
+  return 0;
+}
+
+INT32 LLVMFuzzerTestOneInput(CONST UINT8 *Data, UINTN Size) {
+  UINT32  PatternSize;
+  BOOLEAN HasMask;
+
+  if (Size < 2) {
+    return 0;
+  }
+
+  //
+  // First byte defines pattern size and mask presence, pattern and mask follow.
+  //
+  PatternSize = Data[0] & 0x7FU;
+  HasMask     = (Data[0] & 0x80U) != 0;
+  if (Size - 1 < PatternSize * (HasMask ? 2 : 1)) {
+    return 0;
+  }
+
+  if (!TestFindPattern (
+    &Data[1],
+    HasMask ? &Data[1 + PatternSize] : NULL,
+    PatternSize,
+    Data,
+    (UINT32) Size,
+    (INT32) (Data[1] % Size)
+    )) {
+    abort ();
+  }
+
+  //
+  // Replace with the tail of the input, second byte defines count and skip.
+  //
+  if (!TestApplyPatch (
+    &Data[1],
+    HasMask ? &Data[1 + PatternSize] : NULL,
+    PatternSize,
+    &Data[Size - PatternSize],
+    HasMask ? &Data[1 + PatternSize] : NULL,
+    Data,
+    (UINT32) Size,
+    Data[1] & 3U,
+    (Data[1] >> 2U) & 3U
+    )) {
+    abort ();
+  }
+
+  return 0;
+}
@@ -13,7 +13,9 @@
 #include <Library/MemoryAllocationLib.h>
 #include <Library/DebugLib.h>
 
+#include <pthread.h>
 #include <string.h>
+#include <sys/time.h>
 
 #include <File.h>
 
@@ -38,11 +40,264 @@ rm -rf DICT fuzz*.log ; mkdir DICT ; UBSAN_OPTIONS='halt_on_error=1' ./DiskImage
 #include <CommonCrypto/CommonDigest.h>
 #endif
 
+#define NUM_EXTENTS 20
+
+static void PrepareExtentTable (APPLE_RAM_DISK_EXTENT_TABLE *ExtentTable, uint8_t *Dmg, uint32_t DmgSize) {
+  ExtentTable->Signature   = APPLE_RAM_DISK_EXTENT_SIGNATURE;
+  ExtentTable->Version     = APPLE_RAM_DISK_EXTENT_VERSION;
+  ExtentTable->Reserved    = 0;
+  ExtentTable->Signature2  = APPLE_RAM_DISK_EXTENT_SIGNATURE;
+
+  ExtentTable->ExtentCount = MIN (NUM_EXTENTS, ARRAY_SIZE (ExtentTable->Extents));
+
+  UINT32 Index;
+  for (Index = 0; Index < ExtentTable->ExtentCount; ++Index) {
+    ExtentTable->Extents[Index].Start = (uintptr_t)Dmg + (Index * (DmgSize / ExtentTable->ExtentCount));
+    ExtentTable->Extents[Index].Length = (DmgSize / ExtentTable->ExtentCount);
+  }
+  if (Index != 0) {
+    ExtentTable->Extents[Index - 1].Length += (DmgSize - (Index * (DmgSize / ExtentTable->ExtentCount)));
+  }
+}
+
+/**
+  MP services stand-in running application processor procedures in threads.
+  Processor 0 is the BSP.
+**/
+typedef struct {
+  EFI_AP_PROCEDURE  Procedure;
+  VOID              *Argument;
+  UINTN             ProcessorNumber;
+} USER_AP_THREAD;
+
+static UINTN mUserProcessorCount = 1;
+static __thread UINTN mUserProcessorNumber;
+
+static void *UserApThread (void *Argument) {
+  USER_AP_THREAD *Thread = Argument;
+
+  mUserProcessorNumber = Thread->ProcessorNumber;
+  Thread->Procedure (Thread->Argument);
+  return NULL;
+}
+
+static EFI_STATUS EFIAPI UserGetNumberOfProcessors (
+  IN  EFI_MP_SERVICES_PROTOCOL  *This,
+  OUT UINTN                     *NumberOfProcessors,
+  OUT UINTN                     *NumberOfEnabledProcessors
+  ) {
+  *NumberOfProcessors        = mUserProcessorCount;
+  *NumberOfEnabledProcessors = mUserProcessorCount;
+  return EFI_SUCCESS;
+}
+
+static EFI_STATUS EFIAPI UserStartupAllAPs (
+  IN  EFI_MP_SERVICES_PROTOCOL  *This,
+  IN  EFI_AP_PROCEDURE          Procedure,
+  IN  BOOLEAN                   SingleThread,
+  IN  EFI_EVENT                 WaitEvent OPTIONAL,
+  IN  UINTN                     TimeoutInMicroSeconds,
+  IN  VOID                      *ProcedureArgument OPTIONAL,
+  OUT UINTN                     **FailedCpuList OPTIONAL
+  ) {
+  pthread_t      Threads[OC_APPLE_DISK_IMAGE_MAX_WORKERS];
+  USER_AP_THREAD Args[OC_APPLE_DISK_IMAGE_MAX_WORKERS];
+  UINTN          Index;
+  UINTN          Count = MIN (mUserProcessorCount - 1, OC_APPLE_DISK_IMAGE_MAX_WORKERS);
+
+  if (Count == 0) {
+    return EFI_NOT_STARTED;
+  }
+
+  for (Index = 0; Index < Count; ++Index) {
+    Args[Index].Procedure       = Procedure;
+    Args[Index].Argument        = ProcedureArgument;
+    Args[Index].ProcessorNumber = Index + 1;
+    pthread_create (&Threads[Index], NULL, UserApThread, &Args[Index]);
+  }
+
+  for (Index = 0; Index < Count; ++Index) {
+    pthread_join (Threads[Index], NULL);
+  }
+
+  return EFI_SUCCESS;
+}
+
+static EFI_STATUS EFIAPI UserWhoAmI (
+  IN  EFI_MP_SERVICES_PROTOCOL  *This,
+  OUT UINTN                     *ProcessorNumber
+  ) {
+  *ProcessorNumber = mUserProcessorNumber;
+  return EFI_SUCCESS;
+}
+
+static EFI_MP_SERVICES_PROTOCOL mUserMpServices = {
+  UserGetNumberOfProcessors,
+  NULL,
+  UserStartupAllAPs,
+  NULL,
+  NULL,
+  NULL,
+  UserWhoAmI
+};
+
+static UINT64 CurrentTimestampUs (void) {
+  struct timeval te;
+  gettimeofday (&te, NULL);
+  return te.tv_sec * 1000000ULL + te.tv_usec;
+}
+
+/**
+  Replay BlockIo read trace against DMG and report decompression count.
+  Trace is a text file with one "<lba> <size>" read per line, numbers may be hex.
+  With processor count above 1 chunks are decompressed in threads, and every
+  read is compared byte for byte against serial decompression.
+  Usage: ./DiskImage -t <dmg> <trace> [cache budget in bytes] [processors]
+**/
+static int ReplayReadTrace (int argc, char *argv[]) {
+  int      Code = -1;
+  uint8_t  *Dmg;
+  uint32_t DmgSize;
+  FILE     *Trace;
+  uint8_t  *Buffer = NULL;
+  uint8_t  *SerialBuffer = NULL;
+  size_t   BufferSize = 0;
+  unsigned long long Lba;
+  unsigned long long Size;
+  unsigned long long Reads = 0;
+  UINT64   Start;
+  UINT64   Time = 0;
+  BOOLEAN  Parallel = FALSE;
+
+  OC_APPLE_DISK_IMAGE_CONTEXT     DmgContext;
+  OC_APPLE_DISK_IMAGE_CONTEXT     SerialContext;
+  APPLE_RAM_DISK_EXTENT_TABLE     ExtentTable;
+  OC_APPLE_DISK_IMAGE_CACHE_STATS Stats;
+
+  if (argc < 4) {
+    printf ("Please provide a DMG and a read trace\n");
+    return -1;
+  }
+
+  if ((Dmg = readFile (argv[2], &DmgSize)) == NULL) {
+    printf ("Read fail\n");
+    return -1;
+  }
+
+  Trace = fopen (argv[3], "r");
+  if (Trace == NULL) {
+    printf ("Trace read fail\n");
+    free (Dmg);
+    return -1;
+  }
+
+  PrepareExtentTable (&ExtentTable, Dmg, DmgSize);
+
+  if (!OcAppleDiskImageInitializeContext (&DmgContext, &ExtentTable, DmgSize)) {
+    printf ("DMG Context initialization error\n");
+    fclose (Trace);
+    free (Dmg);
+    return -1;
+  }
+
+  if (argc > 4) {
+    OcAppleDiskImageSetCacheBudget (&DmgContext, (UINTN) strtoull (argv[4], NULL, 0));
+  }
+
+  if (argc > 5) {
+    mUserProcessorCount = (UINTN) strtoull (argv[5], NULL, 0);
+    if (OcAppleDiskImageSetMpServices (&DmgContext, &mUserMpServices) != EFI_SUCCESS) {
+      printf ("Using a single processor\n");
+    } else {
+      Parallel = TRUE;
+    }
+  }
+
+  if (Parallel && !OcAppleDiskImageInitializeContext (&SerialContext, &ExtentTable, DmgSize)) {
+    printf ("DMG Context initialization error\n");
+    OcAppleDiskImageFreeContext (&DmgContext);
+    fclose (Trace);
+    free (Dmg);
+    return -1;
+  }
+
+  while (fscanf (Trace, "%lli %lli", &Lba, &Size) == 2) {
+    if (Lba >= DmgContext.SectorCount
+      || Size > (DmgContext.SectorCount - Lba) * APPLE_DISK_IMAGE_SECTOR_SIZE) {
+      printf ("Read %llu (%llu bytes at LBA %llu) is out of range\n", Reads, Size, Lba);
+      goto Done;
+    }
+
+    if (Size > BufferSize) {
+      free (Buffer);
+      free (SerialBuffer);
+      Buffer       = malloc (Size);
+      SerialBuffer = malloc (Size);
+      if (Buffer == NULL || SerialBuffer == NULL) {
+        printf ("Read buffer allocation failed\n");
+        BufferSize = 0;
+        goto Done;
+      }
+      BufferSize = Size;
+    }
+
+    Start = CurrentTimestampUs ();
+    if (!OcAppleDiskImageRead (&DmgContext, (UINTN) Lba, (UINTN) Size, Buffer)) {
+      printf ("DMG read %llu error\n", Reads);
+      goto Done;
+    }
+    Time += CurrentTimestampUs () - Start;
+
+    if (Parallel) {
+      if (!OcAppleDiskImageRead (&SerialContext, (UINTN) Lba, (UINTN) Size, SerialBuffer)) {
+        printf ("DMG serial read %llu error\n", Reads);
+        goto Done;
+      }
+
+      if (memcmp (Buffer, SerialBuffer, (size_t) Size) != 0) {
+        printf ("DMG read %llu (%llu bytes at LBA %llu) differs from serial decompression\n", Reads, Size, Lba);
+        goto Done;
+      }
+    }
+
+    ++Reads;
+  }
+
+  OcAppleDiskImageGetCacheStats (&DmgContext, &Stats);
+  printf (
+    "Replayed %llu reads in %llu us, budget %llu, decompressions %llu, prefetches %llu, hits %llu, evictions %llu\n",
+    Reads,
+    (unsigned long long) Time,
+    (unsigned long long) DmgContext.CacheBudget,
+    (unsigned long long) Stats.Misses,
+    (unsigned long long) Stats.Prefetches,
+    (unsigned long long) Stats.Hits,
+    (unsigned long long) Stats.Evictions
+    );
+
+  Code = 0;
+
+Done:
+  if (Parallel) {
+    OcAppleDiskImageFreeContext (&SerialContext);
+  }
+  OcAppleDiskImageFreeContext (&DmgContext);
+  fclose (Trace);
+  free (Buffer);
+  free (SerialBuffer);
+  free (Dmg);
+  return Code;
+}
+
 int main (int argc, char *argv[]) {
   if (argc < 2) {
     printf ("Please provide a valid Disk Image path\n");
     return -1;
   }
+
+  if (strcmp (argv[1], "-t") == 0) {
+    return ReplayReadTrace (argc, argv);
+  }
   
   if ((argc % 2) != 1) {
     printf ("Please provide a chunklist file for each DMG, enter \'n\' to skip\n");
@@ -69,23 +324,7 @@ int main (int argc, char *argv[]) {
     OC_APPLE_DISK_IMAGE_CONTEXT DmgContext;
     APPLE_RAM_DISK_EXTENT_TABLE ExtentTable;
 
-#define NUM_EXTENTS 20
-
-    ExtentTable.Signature   = APPLE_RAM_DISK_EXTENT_SIGNATURE;
-    ExtentTable.Version     = APPLE_RAM_DISK_EXTENT_VERSION;
-    ExtentTable.Reserved    = 0;
-    ExtentTable.Signature2  = APPLE_RAM_DISK_EXTENT_SIGNATURE;
-
-    ExtentTable.ExtentCount = MIN (NUM_EXTENTS, ARRAY_SIZE (ExtentTable.Extents));
-
-    UINT32 Index;
-    for (Index = 0; Index < ExtentTable.ExtentCount; ++Index) {
-      ExtentTable.Extents[Index].Start = (uintptr_t)Dmg + (Index * (DmgSize / ExtentTable.ExtentCount));
-      ExtentTable.Extents[Index].Length = (DmgSize / ExtentTable.ExtentCount);
-    }
-    if (Index != 0) {
-      ExtentTable.Extents[Index - 1].Length += (DmgSize - (Index * (DmgSize / ExtentTable.ExtentCount)));
-    }
+    PrepareExtentTable (&ExtentTable, Dmg, DmgSize);
 
     Result = OcAppleDiskImageInitializeContext (&DmgContext, &ExtentTable, DmgSize);
     if (!Result) {
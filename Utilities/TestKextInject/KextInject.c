@@ -200,6 +200,17 @@ long long current_timestamp() {
     return milliseconds;
 }
 
+STATIC
+UINT64
+CurrentTimestampUs (
+  VOID
+  )
+{
+  struct timeval te;
+  gettimeofday (&te, NULL);
+  return te.tv_sec * 1000000ULL + te.tv_usec;
+}
+
 STATIC
 UINT8
 DisableIOAHCIPatchReplace[] = {
@@ -397,6 +408,115 @@ ApplyKextPatches (
   }
 }
 
+//
+// Amount of generated patches to benchmark batched kernel patching with.
+//
+#define BENCHMARK_PATCH_COUNT  48
+#define BENCHMARK_PATCH_SIZE   12
+
+STATIC
+VOID
+BenchmarkKernelPatches (
+  IN CONST UINT8   *Kernel,
+  IN       UINT32  Size
+  )
+{
+  EFI_STATUS             Status;
+  PATCHER_CONTEXT        Patcher;
+  PATCHER_GENERIC_PATCH  Patches[BENCHMARK_PATCH_COUNT];
+  UINT8                  Find[BENCHMARK_PATCH_COUNT][BENCHMARK_PATCH_SIZE];
+  UINT8                  Mask[BENCHMARK_PATCH_COUNT][BENCHMARK_PATCH_SIZE];
+  UINT8                  Replace[BENCHMARK_PATCH_COUNT][BENCHMARK_PATCH_SIZE];
+  UINT8                  *Single;
+  UINT8                  *Batched;
+  UINT32                 Index;
+  UINT32                 Offset;
+  UINT32                 Seed;
+  UINT64                 SingleTime;
+  UINT64                 BatchedTime;
+
+  if (Size < BASE_64KB) {
+    return;
+  }
+
+  Single  = malloc (Size);
+  Batched = malloc (Size);
+  if (Single == NULL || Batched == NULL) {
+    free (Single);
+    free (Batched);
+    return;
+  }
+
+  //
+  // Generate patches from kernel data to ensure they match, masking some of them,
+  // and make some of them not match at all like with patches for other versions.
+  //
+  Seed = 0x1F2E3D4C;
+  memset (Patches, 0, sizeof (Patches));
+  for (Index = 0; Index < BENCHMARK_PATCH_COUNT; ++Index) {
+    Seed   = Seed * 1103515245U + 12345U;
+    Offset = Seed % (Size - BENCHMARK_PATCH_SIZE);
+    memcpy (Find[Index], &Kernel[Offset], BENCHMARK_PATCH_SIZE);
+    memset (Mask[Index], 0xFF, BENCHMARK_PATCH_SIZE);
+    memset (Replace[Index], 0x90, BENCHMARK_PATCH_SIZE);
+
+    if (Index % 4 == 1) {
+      Mask[Index][BENCHMARK_PATCH_SIZE - 4] = 0;
+      Find[Index][BENCHMARK_PATCH_SIZE - 4] = 0;
+      Patches[Index].Mask = Mask[Index];
+    } else if (Index % 4 == 3) {
+      Find[Index][0] ^= 0xA5;
+      Find[Index][BENCHMARK_PATCH_SIZE - 1] ^= 0x5A;
+    }
+
+    Patches[Index].Comment = "Benchmark";
+    Patches[Index].Find    = Find[Index];
+    Patches[Index].Replace = Replace[Index];
+    Patches[Index].Size    = BENCHMARK_PATCH_SIZE;
+    Patches[Index].Count   = Index % 3;
+  }
+
+  memcpy (Single, Kernel, Size);
+  memcpy (Batched, Kernel, Size);
+
+  SingleTime = CurrentTimestampUs ();
+  Status = PatcherInitContextFromBuffer (&Patcher, Single, Size, FALSE);
+  if (!EFI_ERROR (Status)) {
+    for (Index = 0; Index < BENCHMARK_PATCH_COUNT; ++Index) {
+      PatcherApplyGenericPatch (&Patcher, &Patches[Index]);
+    }
+  }
+  SingleTime = CurrentTimestampUs () - SingleTime;
+
+  BatchedTime = CurrentTimestampUs ();
+  if (!EFI_ERROR (Status)) {
+    Status = PatcherInitContextFromBuffer (&Patcher, Batched, Size, FALSE);
+  }
+  if (!EFI_ERROR (Status)) {
+    PatcherApplyGenericPatches (&Patcher, Patches, BENCHMARK_PATCH_COUNT, NULL);
+  }
+  BatchedTime = CurrentTimestampUs () - BatchedTime;
+
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_WARN, "[FAIL] Patch benchmark patcher init - %r\n", Status));
+    FailedToProcess = TRUE;
+  } else if (memcmp (Single, Batched, Size) != 0) {
+    DEBUG ((DEBUG_WARN, "[FAIL] Batched kernel patches mismatch\n"));
+    FailedToProcess = TRUE;
+  } else {
+    DEBUG ((
+      DEBUG_WARN,
+      "[INFO] %u kernel patches applied in %Lu us one by one and %Lu us batched\n",
+      BENCHMARK_PATCH_COUNT,
+      SingleTime,
+      BatchedTime
+      ));
+  }
+
+  free (Single);
+  free (Batched);
+}
+
 VOID
 ApplyKernelPatches (
   IN OUT UINT8   *Kernel,
@@ -649,6 +769,8 @@ int wrap_main(int argc, char** argv) {
   }
 
 
+  BenchmarkKernelPatches (Prelinked, PrelinkedSize);
+
   ApplyKernelPatches (Prelinked, PrelinkedSize);
 
   PATCHER_CONTEXT        Patcher;
@@ -668,6 +790,11 @@ int wrap_main(int argc, char** argv) {
   Status = PrelinkedContextInit (&Context, Prelinked, PrelinkedSize, AllocSize, FALSE);
 
   if (!EFI_ERROR (Status)) {
+    //
+    // Set OC_LINEAR_SYMBOL_LOOKUP to compare link time with symbol index disabled.
+    //
+    Context.LinearSymbolLookup = getenv ("OC_LINEAR_SYMBOL_LOOKUP") != NULL;
+
     Status = PrelinkedInjectPrepare (&Context, LinkedExpansion, ReservedExeSize);
     if (EFI_ERROR (Status)) {
       DEBUG ((DEBUG_WARN, "[FAIL] Prelink inject prepare error %r\n", Status));
@@ -694,6 +821,9 @@ int wrap_main(int argc, char** argv) {
     }
 
     int c = 0;
+    UINT64 LinkStart;
+    UINT64 LinkTime;
+    UINT64 TotalLinkTime = 0;
 
     while (argc > 2) {
       UINT8  *TestData = NULL;
@@ -727,6 +857,8 @@ int wrap_main(int argc, char** argv) {
       char KextPath[64];
       snprintf(KextPath, sizeof(KextPath), "/Library/Extensions/Kex%d.kext", c);
 
+      LinkStart = CurrentTimestampUs ();
+
       Status = PrelinkedInjectKext (
         &Context,
         NULL,
@@ -738,6 +870,17 @@ int wrap_main(int argc, char** argv) {
         TestDataSize
         );
 
+      LinkTime       = CurrentTimestampUs () - LinkStart;
+      TotalLinkTime += LinkTime;
+
+      DEBUG ((
+        DEBUG_WARN,
+        "[INFO] %a link time %Lu us (%a symbol lookup)\n",
+        argv[2],
+        LinkTime,
+        Context.LinearSymbolLookup ? "linear" : "hashed"
+        ));
+
       if (!EFI_ERROR (Status)) {
         DEBUG ((DEBUG_WARN, "[OK] %a injected - %r\n", argv[2], Status));
       } else {
@@ -753,6 +896,8 @@ int wrap_main(int argc, char** argv) {
       c++;
     }
 
+    DEBUG ((DEBUG_WARN, "[INFO] Total link time %Lu us for %d kexts\n", TotalLinkTime, c));
+
     ASSERT (Context.PrelinkedSize - Context.KextsFileOffset <= ReservedExeSize);
 
     Status = PrelinkedInjectComplete (&Context);
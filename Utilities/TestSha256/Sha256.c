@@ -0,0 +1,272 @@
+/** @file
+  Copyright (C) 2026, agent. All rights reserved.
+
+  All rights reserved.
+
+  This program and the accompanying materials
+  are licensed and made available under the terms and conditions of the BSD License
+  which accompanies this distribution.  The full text of the license may be found at
+  http://opensource.org/licenses/bsd-license.php
+
+  THE PROGRAM IS DISTRIBUTED UNDER THE BSD LICENSE ON AN "AS IS" BASIS,
+  WITHOUT WARRANTIES OR REPRESENTATIONS OF ANY KIND, EITHER EXPRESS OR IMPLIED.
+**/
+
+#include <Library/BaseLib.h>
+#include <Library/BaseMemoryLib.h>
+#include <Library/DebugLib.h>
+#include <Library/OcCryptoLib.h>
+#include <Library/OcStringLib.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+
+/*
+ SHA-256 throughput benchmark for every supported backend.
+ Results of all backends are checked against the portable one.
+
+ ./Sha256 [megabytes] [iterations]
+
+ for fuzzing:
+ make FUZZ=1 SANITIZE=1 DEBUG=1
+ rm -rf DICT fuzz*.log ; mkdir DICT ; ./Sha256 -jobs=4 DICT
+*/
+
+#ifdef FUZZING_TEST
+#define main no_main
+#endif
+
+typedef struct {
+  OC_SHA256_BACKEND  Backend;
+  CONST CHAR8        *Name;
+} SHA256_BACKEND_INFO;
+
+STATIC CONST SHA256_BACKEND_INFO mBackends[] = {
+  { OcSha256BackendGeneric,     "generic" },
+  { OcSha256BackendMultiBuffer, "multi-buffer" },
+  { OcSha256BackendShaNi,       "sha-ni" }
+};
+
+//
+// SHA-256 ("abc").
+//
+STATIC CONST UINT8 mAbcDigest[SHA256_DIGEST_SIZE] = {
+  0xBA, 0x78, 0x16, 0xBF, 0x8F, 0x01, 0xCF, 0xEA, 0x41, 0x41, 0x40, 0xDE, 0x5D, 0xAE, 0x22, 0x23,
+  0xB0, 0x03, 0x61, 0xA3, 0x96, 0x17, 0x7A, 0x9C, 0xB4, 0x10, 0xFF, 0x61, 0xF2, 0x00, 0x15, 0xAD
+};
+
+STATIC
+UINT64
+CurrentTimestampUs (
+  VOID
+  )
+{
+  struct timeval te;
+  gettimeofday (&te, NULL);
+  return te.tv_sec * 1000000ULL + te.tv_usec;
+}
+
+/**
+  Hash Count buffers of varying lengths with the current backend
+  and with the portable one, and compare the results.
+**/
+STATIC
+BOOLEAN
+TestBackendMatches (
+  IN CONST UINT8  *Data,
+  IN UINTN        Size,
+  IN UINTN        Count
+  )
+{
+  OC_SHA256_BACKEND  Backend;
+  CONST UINT8        *Buffers[2 * SHA256_MULTI_LANES + 1];
+  UINTN              Lengths[2 * SHA256_MULTI_LANES + 1];
+  UINT8              Hashes[(2 * SHA256_MULTI_LANES + 1) * SHA256_DIGEST_SIZE];
+  UINT8              Streamed[SHA256_DIGEST_SIZE];
+  UINT8              Expected[SHA256_DIGEST_SIZE];
+  SHA256_CONTEXT     Context;
+  UINTN              Index;
+  UINTN              Offset;
+  UINTN              Step;
+
+  ASSERT (Count <= ARRAY_SIZE (Buffers));
+
+  Backend = Sha256GetBackend ();
+
+  for (Index = 0; Index < Count; ++Index) {
+    Buffers[Index] = &Data[Index * Size / (Count + 1)];
+    Lengths[Index] = Size / (Count + 1) + Index * 7;
+    if (Lengths[Index] > Size - (UINTN) (Buffers[Index] - Data)) {
+      Lengths[Index] = Size - (UINTN) (Buffers[Index] - Data);
+    }
+  }
+
+  Sha256Multi (Hashes, Buffers, Lengths, Count);
+
+  //
+  // Feed the data in uneven pieces to cover partial block handling.
+  //
+  Sha256Init (&Context);
+  for (Offset = 0, Step = 1; Offset < Size; Offset += Step, Step = Step * 3 % 1021 + 1) {
+    Sha256Update (&Context, &Data[Offset], MIN (Step, Size - Offset));
+  }
+  Sha256Final (&Context, Streamed);
+
+  Sha256SetBackend (OcSha256BackendGeneric);
+
+  for (Index = 0; Index < Count; ++Index) {
+    Sha256 (Expected, Buffers[Index], Lengths[Index]);
+    if (memcmp (Expected, &Hashes[Index * SHA256_DIGEST_SIZE], SHA256_DIGEST_SIZE) != 0) {
+      printf ("Multi-buffer digest %u of %u mismatch\n", (UINT32) Index, (UINT32) Count);
+      Sha256SetBackend (Backend);
+      return FALSE;
+    }
+  }
+
+  Sha256 (Expected, Data, Size);
+  Sha256SetBackend (Backend);
+
+  if (memcmp (Expected, Streamed, SHA256_DIGEST_SIZE) != 0) {
+    printf ("Streamed digest mismatch for %u bytes\n", (UINT32) Size);
+    return FALSE;
+  }
+
+  return TRUE;
+}
+
+STATIC
+BOOLEAN
+TestBackend (
+  IN CONST SHA256_BACKEND_INFO  *Info,
+  IN CONST UINT8                *Data,
+  IN UINTN                      Size,
+  IN UINT32                     Iterations
+  )
+{
+  UINT8        Digest[SHA256_DIGEST_SIZE];
+  UINT8        Hashes[SHA256_MULTI_LANES * SHA256_DIGEST_SIZE];
+  CONST UINT8  *Buffers[SHA256_MULTI_LANES];
+  UINTN        Lengths[SHA256_MULTI_LANES];
+  UINTN        Index;
+  UINT64       Start;
+  UINT64       Time;
+  UINT64       MultiTime;
+
+  if (!Sha256SetBackend (Info->Backend)) {
+    printf ("%s is unsupported\n", Info->Name);
+    return TRUE;
+  }
+
+  Sha256 (Digest, (CONST UINT8 *) "abc", L_STR_LEN ("abc"));
+  if (memcmp (Digest, mAbcDigest, sizeof (Digest)) != 0) {
+    printf ("%s known answer test failed\n", Info->Name);
+    return FALSE;
+  }
+
+  for (Index = 0; Index < 2 * SHA256_MULTI_LANES + 1; ++Index) {
+    if (!TestBackendMatches (Data, 4 * BASE_1KB + Index * 13, Index + 1)) {
+      printf ("%s does not match generic backend\n", Info->Name);
+      return FALSE;
+    }
+  }
+
+  Start = CurrentTimestampUs ();
+  for (Index = 0; Index < Iterations; ++Index) {
+    Sha256 (Digest, Data, Size);
+  }
+  Time = CurrentTimestampUs () - Start;
+
+  //
+  // Chunklist-like batch of equally sized buffers.
+  //
+  for (Index = 0; Index < SHA256_MULTI_LANES; ++Index) {
+    Buffers[Index] = &Data[Index * (Size / SHA256_MULTI_LANES)];
+    Lengths[Index] = Size / SHA256_MULTI_LANES;
+  }
+
+  Start = CurrentTimestampUs ();
+  for (Index = 0; Index < Iterations; ++Index) {
+    Sha256Multi (Hashes, Buffers, Lengths, SHA256_MULTI_LANES);
+  }
+  MultiTime = CurrentTimestampUs () - Start;
+
+  printf (
+    "%-12s single %llu MB/s, batch of %u %llu MB/s\n",
+    Info->Name,
+    (unsigned long long) (Time > 0 ? (UINT64) Size * Iterations / Time : 0),
+    SHA256_MULTI_LANES,
+    (unsigned long long) (MultiTime > 0 ? (UINT64) Size * Iterations / MultiTime : 0)
+    );
+
+  return TRUE;
+}
+
+int main (int argc, char *argv[]) {
+  UINTN   Size;
+  UINT32  Iterations;
+  UINT8   *Data;
+  UINTN   Index;
+
+  Size       = 64;
+  Iterations = 4;
+
+  if (argc > 1) {
+    Size = (UINTN) strtoul (argv[1], NULL, 0);
+  }
+
+  if (argc > 2) {
+    Iterations = (UINT32) strtoul (argv[2], NULL, 0);
+  }
+
+  if (Size == 0) {
+    Size = 1;
+  }
+
+  if (Iterations == 0) {
+    Iterations = 1;
+  }
+
+  Size *= BASE_1MB;
+
+  Data = malloc (Size);
+  if (Data == NULL) {
+    printf ("Buffer of %u MB cannot be allocated\n", (UINT32) (Size / BASE_1MB));
+    return -1;
+  }
+
+  for (Index = 0; Index < Size; ++Index) {
+    Data[Index] = (UINT8) (Index * 31 + (Index >> 11));
+  }
+
+  for (Index = 0; Index < ARRAY_SIZE (mBackends); ++Index) {
+    if (!TestBackend (&mBackends[Index], Data, Size, Iterations)) {
+      free (Data);
+      return -1;
+    }
+  }
+
+  Sha256SetBackend (OcSha256BackendAuto);
+  printf ("auto selects %s\n", mBackends[Sha256GetBackend () - OcSha256BackendGeneric].Name);
+
+  free (Data);
+  return 0;
+}
+
+INT32 LLVMFuzzerTestOneInput(CONST UINT8 *Data, UINTN Size) {
+  UINTN  Index;
+
+  if (Size == 0) {
+    return 0;
+  }
+
+  for (Index = 0; Index < ARRAY_SIZE (mBackends); ++Index) {
+    if (Sha256SetBackend (mBackends[Index].Backend)
+      && !TestBackendMatches (Data, Size, Data[0] % (2 * SHA256_MULTI_LANES + 1) + 1)) {
+      abort ();
+    }
+  }
+
+  return 0;
+}